@@ -64,6 +64,8 @@
 #include "src/scheduler.h"
 #include "src/i2c.h"
 #include "src/ble.h"
+#include "src/fsm.h"
+#include "src/workq.h"
 
 
 // Students: Here is an example of how to correctly include logging functions in
@@ -143,7 +145,8 @@
 
 bool app_is_ok_to_sleep(void)
 {
-  return APP_IS_OK_TO_SLEEP;
+  // stay awake until app_process_action() has run the deferred work
+  return (APP_IS_OK_TO_SLEEP && !workq_pending());
 } // app_is_ok_to_sleep()
 
 sl_power_manager_on_isr_exit_t app_sleep_on_isr_exit(void)
@@ -180,6 +183,8 @@ SL_WEAK void app_init(void)
 
   oscillator_init();
   initLETIMER0();
+  initI2C();                // once, I2C0 keeps its configuration through EM2
+  fsm_init();
   // -----------------------------------------------
   // This is the last thing you do prior to entering
   // your while (1) loop is to enable NVIC interrupts
@@ -229,6 +234,9 @@ SL_WEAK void app_process_action(void)
   //         We will create/use a scheme that is far more energy efficient in
   //         later assignments.
 
+  // LCD redraws, logging and statistics deferred by the BT event handler
+  workq_run();
+
 //  uint32_t evt;
 //  evt = getNextEvent();
 //
@@ -242,6 +250,30 @@ SL_WEAK void app_process_action(void)
 
 
 
+// pass one event to the BLE handler and this device's state machine
+static void app_dispatch_event(sl_bt_msg_t *evt)
+{
+  // For A5 onward:
+  // Some events require responses from our application code,
+  // and don’t necessarily advance our state machines.
+  // For A5 uncomment the next 2 function calls
+   handle_ble_event(evt); // put this code in ble.c/.h
+
+#if DEVICE_IS_BLE_SERVER
+// SERVER
+// sequence through states driven by events
+   state_machine(evt);  // put this code in scheduler.c/.h
+#else
+//CLIENT
+// sequence through service and characteristic discovery
+   discovery_state_machine(evt); // put this code in src/scheduler.c/.h
+#endif
+
+} // app_dispatch_event()
+
+
+
+
 /**************************************************************************//**
  * Bluetooth stack event handler.
  * This overrides the dummy weak implementation.
@@ -254,25 +286,23 @@ SL_WEAK void app_process_action(void)
  *****************************************************************************/
 void sl_bt_on_event(sl_bt_msg_t *evt)
 {
+  uint32_t events;
 
   // Just a trick to hide a compiler warning about unused input parameter evt.
   //(void) evt;
 
-  // For A5 onward:
-  // Some events require responses from our application code,
-  // and don’t necessarily advance our state machines.
-  // For A5 uncomment the next 2 function calls
-   handle_ble_event(evt); // put this code in ble.c/.h
+  // One external signal carries every event the ISRs raised since the last
+  // one, hand them to the handlers one at a time, most urgent first
+  if (SL_BT_MSG_ID(evt->header) == sl_bt_evt_system_external_signal_id) {
+      events = schedulerGetEvents();
+      while (events != 0) {
+          evt->data.evt_system_external_signal.extsignals = schedulerNextEvent(&events);
+          app_dispatch_event(evt);
+      }
+      return;
+  }
 
-#if DEVICE_IS_BLE_SERVER
-// SERVER
-// sequence through states driven by events
-   state_machine(evt);  // put this code in scheduler.c/.h
-#else
-//CLIENT
-// sequence through service and characteristic discovery
-   discovery_state_machine(evt); // put this code in src/scheduler.c/.h
-#endif
+  app_dispatch_event(evt);
 
 } // sl_bt_on_event()
 
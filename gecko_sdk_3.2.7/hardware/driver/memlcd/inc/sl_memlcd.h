@@ -48,6 +48,11 @@ extern "C" {
  * @{
  ******************************************************************************/
 
+/**
+ * Function called when an asynchronous draw has completed.
+ */
+typedef void (*sl_memlcd_callback_t)(void);
+
 /**
  * General memory LCD data structure.
  */
@@ -137,6 +142,77 @@ sl_status_t sl_memlcd_draw(const struct sl_memlcd_t *device,
                            unsigned int row_start,
                            unsigned int row_count);
 
+/**************************************************************************//**
+ * @brief
+ *   Draw any set of rows to the memory LCD display in a single transfer.
+ *
+ * @details
+ *   Every line of the memory LCD update command carries its own address, so
+ *   rows that are not next to each other are sent back to back within one
+ *   SCS assertion. This costs one SCS setup/hold time per call instead of
+ *   one per run of consecutive rows.
+ *
+ * @param[in] device
+ *   Memory LCD display device.
+ *
+ * @param[in] data
+ *   Pointer to the pixel matrix buffer of the whole display. The format of
+ *   the buffer depends on the color mode of the memory LCD display.
+ *
+ * @param[in] row_mask
+ *   Rows to draw, bit (row % 32) of row_mask[row / 32] is set for each row.
+ *   First row is 0.
+ *
+ * @return
+ *   SL_STATUS_OK if there are no errors, SL_STATUS_BUSY while a transfer
+ *   started by @ref sl_memlcd_draw_rows_async() is in progress.
+ *****************************************************************************/
+sl_status_t sl_memlcd_draw_rows(const struct sl_memlcd_t *device,
+                                const void *data,
+                                const uint32_t *row_mask);
+
+/**************************************************************************//**
+ * @brief
+ *   Start drawing any set of rows to the memory LCD display in the background.
+ *
+ * @details
+ *   Sends the same bytes as @ref sl_memlcd_draw_rows(), but the SPI transmit
+ *   buffer is refilled from the SPI USART TX interrupt, so the core is free
+ *   to sleep in EM1 for the duration of the transfer. The row mask is copied,
+ *   the pixel matrix buffer is not; it must not be changed, and no other
+ *   memory LCD function may be called, until the callback has run.
+ *   The application must call @ref sl_memlcd_tx_irq_handler() from the SPI
+ *   USART TX interrupt handler.
+ *
+ * @param[in] device
+ *   Memory LCD display device.
+ *
+ * @param[in] data
+ *   Pointer to the pixel matrix buffer of the whole display.
+ *
+ * @param[in] row_mask
+ *   Rows to draw, bit (row % 32) of row_mask[row / 32] is set for each row.
+ *
+ * @param[in] callback
+ *   Function called from the interrupt handler once SCS is de-asserted, or
+ *   right away if there are no rows to draw. May be NULL.
+ *
+ * @return
+ *   SL_STATUS_OK if the transfer was started, SL_STATUS_BUSY if a transfer
+ *   is already in progress, SL_STATUS_NOT_SUPPORTED on an EUSART.
+ *****************************************************************************/
+sl_status_t sl_memlcd_draw_rows_async(const struct sl_memlcd_t *device,
+                                      const void *data,
+                                      const uint32_t *row_mask,
+                                      sl_memlcd_callback_t callback);
+
+/**************************************************************************//**
+ * @brief
+ *   Feed the transfer started by @ref sl_memlcd_draw_rows_async(). Call from
+ *   the TX interrupt handler of the SPI USART.
+ *****************************************************************************/
+void sl_memlcd_tx_irq_handler(void);
+
 /**************************************************************************//**
  * @brief
  *   Refresh the display device.
@@ -32,9 +32,13 @@
 /* Concatenate preprocessor tokens A and B. */
 #define SL_CONCAT(A, B) A ## B
 
+/* Concatenate preprocessor tokens A, B and C. */
+#define SL_CONCAT3(A, B, C) A ## B ## C
+
 /* Generate the cmu clock symbol based on instance. */
 #if defined(SL_MEMLCD_USE_USART)
 #define SL_MEMLCD_SPI_CLOCK(N) SL_CONCAT(cmuClock_USART, N)
+#define SL_MEMLCD_SPI_TX_IRQ(N) SL_CONCAT3(USART, N, _TX_IRQn)
 #elif defined(SL_MEMLCD_USE_EUSART)
 #define SL_MEMLCD_SPI_CLOCK(N) SL_CONCAT(cmuClock_EUSART, N)
 #endif
@@ -59,6 +63,22 @@ static sl_memlcd_t memlcd_instance;
  *  is only valid after initialized=true. */
 static bool initialized = false;
 
+/** State of the transfer started by sl_memlcd_draw_rows_async(). */
+static struct {
+  const sl_memlcd_t *device;
+  const uint8_t *data;
+  uint32_t row_mask[(SL_MEMLCD_DISPLAY_HEIGHT + 31) / 32];
+  sl_memlcd_callback_t callback;
+  unsigned int next_row;      ///< First row not looked at yet
+  const uint8_t *p;           ///< Next byte to send
+  unsigned int remaining;     ///< Bytes left at p
+  uint8_t header[2];          ///< Dummy/command byte and line address
+  bool first;                 ///< No line sent yet, header carries CMD_UPDATE
+  bool row_pending;           ///< Header sent, pixels of next_row - 1 follow
+  bool trailer_sent;          ///< Closing dummy bytes queued
+  volatile bool busy;
+} async_draw;
+
 /** SPI handle to use for SPI communication to the memory lcd. */
 #if defined(SL_MEMLCD_USE_EUSART)
 static sli_memlcd_spi_handle_t spi_handle = {
@@ -262,6 +282,234 @@ sl_status_t sl_memlcd_draw(const struct sl_memlcd_t *device, const void *data, u
   return SL_STATUS_OK;
 }
 
+sl_status_t sl_memlcd_draw_rows(const struct sl_memlcd_t *device, const void *data, const uint32_t *row_mask)
+{
+  unsigned int row;
+  const uint8_t *p = data;
+  uint16_t cmd;
+  int row_len;
+  bool selected = false;
+#if defined(SL_MEMLCD_LPM013M126A)
+  uint8_t reversed_row;
+#endif
+
+  if (async_draw.busy) {
+    return SL_STATUS_BUSY;
+  }
+
+  row_len = (device->width * device->bpp) / 8;
+
+  for ( row = 0; row < device->height; row++ ) {
+    if ((row_mask[row >> 5] & (1UL << (row & 0x1f))) == 0) {
+      continue;
+    }
+
+#if defined(SL_MEMLCD_LPM013M126A)
+    /* LPM013M126A uses MSB first for the row */
+    reversed_row = reverse_bits((uint8_t)(row + 1));
+#endif
+
+    if (!selected) {
+      /* Assert SCS */
+      GPIO_PinOutSet(SL_MEMLCD_SPI_CS_PORT, SL_MEMLCD_SPI_CS_PIN);
+
+      /* SCS setup time */
+      sl_udelay_wait(device->setup_us);
+
+      /* Send update command and first line address */
+#if defined(SL_MEMLCD_LPM013M126A)
+      cmd = CMD_UPDATE | (reversed_row << 8);
+#else
+      cmd = CMD_UPDATE | ((row + 1) << 8);
+#endif
+      selected = true;
+    } else {
+      /* Dummy byte ending the previous line, then this line's address */
+#if defined(SL_MEMLCD_LPM013M126A)
+      cmd = 0x3f | (reversed_row << 8);
+#else
+      cmd = 0xff | ((row + 1) << 8);
+#endif
+    }
+    sli_memlcd_spi_tx(&spi_handle, &cmd, 2);
+
+    /* Send pixels for this line */
+    sli_memlcd_spi_tx(&spi_handle, p + row * row_len, row_len);
+  }
+
+  if (!selected) {
+    /* Nothing to draw */
+    return SL_STATUS_OK;
+  }
+
+  /* Dummy bytes ending the last line and the transfer */
+  cmd = 0xffff;
+  sli_memlcd_spi_tx(&spi_handle, &cmd, 2);
+
+  sli_memlcd_spi_wait(&spi_handle);
+
+  /* SCS hold time */
+  sl_udelay_wait(device->hold_us);
+
+  /* De-assert SCS */
+  GPIO_PinOutClear(SL_MEMLCD_SPI_CS_PORT, SL_MEMLCD_SPI_CS_PIN);
+
+  return SL_STATUS_OK;
+}
+
+/***************************************************************************//**
+ * Point the asynchronous transfer at its next run of bytes: the header of the
+ * next row in the mask, that row's pixels, and finally the closing dummy
+ * bytes. Returns false when everything has been sent.
+ ******************************************************************************/
+static bool async_draw_next(void)
+{
+  const sl_memlcd_t *device = async_draw.device;
+  int row_len = (device->width * device->bpp) / 8;
+  unsigned int row;
+
+  if (async_draw.row_pending) {
+    /* Send pixels for this line */
+    async_draw.p = async_draw.data + (async_draw.next_row - 1) * row_len;
+    async_draw.remaining = row_len;
+    async_draw.row_pending = false;
+    return true;
+  }
+
+  for ( row = async_draw.next_row; row < device->height; row++ ) {
+    if (async_draw.row_mask[row >> 5] & (1UL << (row & 0x1f))) {
+      break;
+    }
+  }
+
+  if (row < device->height) {
+#if defined(SL_MEMLCD_LPM013M126A)
+    /* LPM013M126A uses MSB first for the row */
+    async_draw.header[0] = async_draw.first ? CMD_UPDATE : 0x3f;
+    async_draw.header[1] = reverse_bits((uint8_t)(row + 1));
+#else
+    async_draw.header[0] = async_draw.first ? CMD_UPDATE : 0xff;
+    async_draw.header[1] = (uint8_t)(row + 1);
+#endif
+    async_draw.first = false;
+    async_draw.row_pending = true;
+    async_draw.next_row = row + 1;
+  } else if (!async_draw.trailer_sent) {
+    async_draw.header[0] = 0xff;
+    async_draw.header[1] = 0xff;
+    async_draw.trailer_sent = true;
+  } else {
+    return false;
+  }
+
+  async_draw.p = async_draw.header;
+  async_draw.remaining = 2;
+  return true;
+}
+
+sl_status_t sl_memlcd_draw_rows_async(const struct sl_memlcd_t *device, const void *data, const uint32_t *row_mask, sl_memlcd_callback_t callback)
+{
+#if defined(SL_MEMLCD_USE_USART)
+  USART_TypeDef *usart = spi_handle.usart;
+  unsigned int i;
+  uint32_t any = 0;
+
+  if (async_draw.busy) {
+    return SL_STATUS_BUSY;
+  }
+
+  for ( i = 0; i < (device->height + 31) / 32; i++ ) {
+    async_draw.row_mask[i] = row_mask[i];
+    any |= row_mask[i];
+  }
+
+  if (any == 0) {
+    /* Nothing to draw */
+    if (callback != NULL) {
+      callback();
+    }
+    return SL_STATUS_OK;
+  }
+
+  async_draw.device = device;
+  async_draw.data = data;
+  async_draw.callback = callback;
+  async_draw.next_row = 0;
+  async_draw.remaining = 0;
+  async_draw.first = true;
+  async_draw.row_pending = false;
+  async_draw.trailer_sent = false;
+  async_draw.busy = true;
+
+  /* Assert SCS */
+  GPIO_PinOutSet(SL_MEMLCD_SPI_CS_PORT, SL_MEMLCD_SPI_CS_PIN);
+
+  /* SCS setup time */
+  sl_udelay_wait(device->setup_us);
+
+  /* The TX buffer is empty, the TXBL interrupt fires right away and keeps
+     it filled until the last byte is queued. */
+  USART_IntClear(usart, USART_IFC_TXC);
+  NVIC_ClearPendingIRQ(SL_MEMLCD_SPI_TX_IRQ(SL_MEMLCD_SPI_PERIPHERAL_NO));
+  NVIC_EnableIRQ(SL_MEMLCD_SPI_TX_IRQ(SL_MEMLCD_SPI_PERIPHERAL_NO));
+  USART_IntEnable(usart, USART_IEN_TXBL);
+
+  return SL_STATUS_OK;
+#else
+  (void) device;
+  (void) data;
+  (void) row_mask;
+  (void) callback;
+
+  return SL_STATUS_NOT_SUPPORTED;
+#endif
+}
+
+void sl_memlcd_tx_irq_handler(void)
+{
+#if defined(SL_MEMLCD_USE_USART)
+  USART_TypeDef *usart = spi_handle.usart;
+  uint32_t flags = USART_IntGetEnabled(usart);
+
+  if (flags & USART_IF_TXBL) {
+    while (usart->STATUS & USART_STATUS_TXBL) {
+      if ((async_draw.remaining == 0) && !async_draw_next()) {
+        /* Everything is queued, wait for the last byte to be shifted out. */
+        USART_IntDisable(usart, USART_IEN_TXBL);
+        USART_IntClear(usart, USART_IFC_TXC);
+        USART_IntEnable(usart, USART_IEN_TXC);
+
+        /* If this interrupt was serviced late the last byte may already be
+           out, and the TXC flag cleared above was the only one we get.
+           STATUS.TXC is cleared by every TXDATA write, so finish now. */
+        if (usart->STATUS & USART_STATUS_TXC) {
+          flags |= USART_IF_TXC;
+        }
+        break;
+      }
+      usart->TXDATA = *async_draw.p++;
+      async_draw.remaining--;
+    }
+  }
+
+  if (flags & USART_IF_TXC) {
+    USART_IntDisable(usart, USART_IEN_TXC);
+    USART_IntClear(usart, USART_IFC_TXC);
+
+    /* SCS hold time */
+    sl_udelay_wait(async_draw.device->hold_us);
+
+    /* De-assert SCS */
+    GPIO_PinOutClear(SL_MEMLCD_SPI_CS_PORT, SL_MEMLCD_SPI_CS_PIN);
+
+    async_draw.busy = false;
+    if (async_draw.callback != NULL) {
+      async_draw.callback();
+    }
+  }
+#endif
+}
+
 const sl_memlcd_t *sl_memlcd_get(void)
 {
   if (initialized) {
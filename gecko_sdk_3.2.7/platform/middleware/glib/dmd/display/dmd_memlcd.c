@@ -48,6 +48,10 @@ static uint32_t dirtyRows[(SL_MEMLCD_DISPLAY_HEIGHT  + (sizeof(uint32_t) * 8 - 1
 static uint8_t framebuffer[(SL_MEMLCD_DISPLAY_WIDTH * SL_MEMLCD_DISPLAY_HEIGHT * SL_MEMLCD_DISPLAY_BPP) / 8];
 
 static void setLineDirty(int line);
+#if !(SL_MEMLCD_DISPLAY_RGB_3BIT) && !defined(DMD_MEMLCD_REFERENCE_WRITE_DATA)
+static void writeDataRow(uint8_t *pDst, unsigned int x, const uint8_t data[],
+                         unsigned int pixelBit, unsigned int rowPixels);
+#endif
 
 EMSTATUS DMD_init(DMD_InitConfig *initConfig)
 {
@@ -144,9 +148,11 @@ EMSTATUS DMD_writeData(uint16_t x, uint16_t y, const uint8_t data[],
 
   /* Write data */
   unsigned int rowPixels;
-  uint8_t      pixelData = 0;
   int          pixelBit = 0;
+#if (SL_MEMLCD_DISPLAY_RGB_3BIT) || defined(DMD_MEMLCD_REFERENCE_WRITE_DATA)
+  uint8_t      pixelData = 0;
   uint8_t      matrixByte;
+#endif
   uint8_t     *pDst;
   int          bytesPerRow = (SL_MEMLCD_DISPLAY_WIDTH * SL_MEMLCD_DISPLAY_BPP) / 8;
 #if (SL_MEMLCD_DISPLAY_RGB_3BIT)
@@ -237,6 +243,11 @@ EMSTATUS DMD_writeData(uint16_t x, uint16_t y, const uint8_t data[],
 
 #else /* Monochrome display */
 
+/* DMD_MEMLCD_REFERENCE_WRITE_DATA selects the original byte and pixel
+   copy. tests/test_dmd_memlcd.c builds this file both ways, checks that
+   they write the same framebuffer and times them. */
+#if defined(DMD_MEMLCD_REFERENCE_WRITE_DATA)
+
     /* If the start pixel (x) or the corresponding data bit
        (pixelBit) are not aligned on a 8-bit boundary or there are
        less than 8 bits to copy to the current row we copy pixel by
@@ -280,6 +291,12 @@ EMSTATUS DMD_writeData(uint16_t x, uint16_t y, const uint8_t data[],
         pixelBit += rowPixels;
       }
     }
+#else
+    /* Merge the row into the framebuffer up to 32 pixels at a time,
+       whatever the alignment of x and of the source data. */
+    writeDataRow(pDst, x, data, pixelBit, rowPixels);
+    pixelBit += rowPixels;
+#endif
 #endif
 
     /* Mark row/line as dirty */
@@ -463,6 +480,73 @@ EMSTATUS DMD_writeColor(uint16_t x, uint16_t y, uint8_t red,
   return DMD_OK;
 }
 
+EMSTATUS DMD_writeColorMask(uint16_t x, uint16_t y, uint32_t mask,
+                            uint32_t numPixels, uint8_t red,
+                            uint8_t green, uint8_t blue)
+{
+  (void) red;     /* Suppress compiler warning: unused parameter. */
+  (void) blue;    /* Suppress compiler warning: unused parameter. */
+
+  if (memlcd == NULL) {
+    return DMD_ERROR_DRIVER_NOT_INITIALIZED;
+  }
+
+#if (SL_MEMLCD_DISPLAY_RGB_3BIT) /* RGB display */
+  (void) x;          /* Suppress compiler warning: unused parameter. */
+  (void) y;          /* Suppress compiler warning: unused parameter. */
+  (void) mask;       /* Suppress compiler warning: unused parameter. */
+  (void) numPixels;  /* Suppress compiler warning: unused parameter. */
+  (void) green;      /* Suppress compiler warning: unused parameter. */
+
+  return DMD_ERROR_NOT_SUPPORTED;
+#else /* Monochrome display */
+  uint8_t     *pDst;
+  int          bytesPerRow = (SL_MEMLCD_DISPLAY_WIDTH * SL_MEMLCD_DISPLAY_BPP) / 8;
+  uint32_t     pixelData;
+  int          pixelBit;
+
+  if (numPixels > 32
+      || x + numPixels > dimensions.clipWidth
+      || y >= dimensions.clipHeight) {
+    return DMD_ERROR_PIXEL_OUT_OF_BOUNDS;
+  }
+
+  if (numPixels < 32) {
+    mask &= (1UL << numPixels) - 1;
+  }
+  if (mask == 0) {
+    return DMD_OK;
+  }
+
+  /* Adjust x and y to account for clipping. */
+  x += dimensions.xClipStart;
+  y += dimensions.yClipStart;
+
+  pixelData = green ? mask : 0;
+  pixelBit  = x & 0x7;
+  pDst      = framebuffer + y * bytesPerRow + (x >> 3);
+
+  /* Merge the masked pixels into the framebuffer a byte at a time, the
+     first byte only holds the 8 - pixelBit pixels from x. */
+  *pDst = (*pDst & ~(uint8_t)(mask << pixelBit))
+          | (uint8_t)(pixelData << pixelBit);
+  mask      >>= 8 - pixelBit;
+  pixelData >>= 8 - pixelBit;
+
+  while (mask) {
+    pDst++;
+    *pDst = (*pDst & ~(uint8_t)mask) | (uint8_t)pixelData;
+    mask      >>= 8;
+    pixelData >>= 8;
+  }
+
+  /* Mark row/line as dirty */
+  setLineDirty(y);
+
+  return DMD_OK;
+#endif
+}
+
 EMSTATUS DMD_sleep(void)
 {
   if (memlcd == NULL) {
@@ -515,53 +599,36 @@ EMSTATUS DMD_selectFramebuffer(void *framebuffer)
 EMSTATUS DMD_updateDisplay(void)
 {
   sl_status_t   status;
-  unsigned int  startRow;
-  unsigned int  consecutiveDirtyRows;
-  uint8_t      *pStartRow;
-  int           bytesPerRow  = (SL_MEMLCD_DISPLAY_WIDTH * SL_MEMLCD_DISPLAY_BPP) / 8;
-  uint32_t      dirtyFlags   = dirtyRows[0];
-  int           dirtyWordCnt = 1;
-
-  startRow             = 0;
-  consecutiveDirtyRows = 0;
-
-  while (startRow + consecutiveDirtyRows < memlcd->height) {
-    if (dirtyFlags & 0x1) {
-      consecutiveDirtyRows++;
-    } else {
-      if (consecutiveDirtyRows) {
-        /* We have reached the end of a series of consecutive dirty rows,
-           update display now. */
-        pStartRow = (uint8_t*) framebuffer + startRow * bytesPerRow;
-        status = sl_memlcd_draw(memlcd, pStartRow, startRow, consecutiveDirtyRows);
-        if (status != SL_STATUS_OK) {
-          return DMD_ERROR_MEMORY_ERROR;
-        }
 
-        startRow += consecutiveDirtyRows + 1;
-        consecutiveDirtyRows = 0;
-      } else {
-        startRow++;
-      }
-    }
+  /* Send every dirty row in one multi-line update, a single SCS cycle
+     however many rows were touched and however far apart they are. */
+  status = sl_memlcd_draw_rows(memlcd, framebuffer, dirtyRows);
+  if (status != SL_STATUS_OK) {
+    return DMD_ERROR_MEMORY_ERROR;
+  }
 
-    /* Shift down dirtyFlags until
-       all dirtyFlags in the current dirty word have been checked,
-       then set to next dirty word.  */
-    if ( (startRow + consecutiveDirtyRows) & DIRTY_WORD_BITS_LOG2_MASK ) {
-      dirtyFlags >>= 1;
-    } else {
-      dirtyFlags = dirtyRows[dirtyWordCnt++];
-    }
+  /* Clear dirty rows flags. */
+  memset(dirtyRows, 0x0, sizeof(dirtyRows));
+
+  return DMD_OK;
+}
+
+EMSTATUS DMD_updateDisplayAsync(DMD_UpdateCallback callback)
+{
+  sl_status_t   status;
+
+  if (memlcd == NULL) {
+    return DMD_ERROR_DRIVER_NOT_INITIALIZED;
   }
 
-  /* Check if there dirty rows at end that have not been written yet. */
-  if (consecutiveDirtyRows) {
-    pStartRow = (uint8_t*) framebuffer + startRow * bytesPerRow;
-    status = sl_memlcd_draw(memlcd, pStartRow, startRow, consecutiveDirtyRows);
-    if (status != SL_STATUS_OK) {
-      return DMD_ERROR_MEMORY_ERROR;
-    }
+  /* The memory lcd driver keeps its own copy of the dirty rows flags. */
+  status = sl_memlcd_draw_rows_async(memlcd, framebuffer, dirtyRows, callback);
+  if (status == SL_STATUS_BUSY) {
+    return DMD_ERROR_BUSY;
+  } else if (status == SL_STATUS_NOT_SUPPORTED) {
+    return DMD_ERROR_NOT_SUPPORTED;
+  } else if (status != SL_STATUS_OK) {
+    return DMD_ERROR_MEMORY_ERROR;
   }
 
   /* Clear dirty rows flags. */
@@ -577,13 +644,107 @@ EMSTATUS DMD_getFrameBuffer(void **fb)
   return DMD_OK;
 }
 
+#if !(SL_MEMLCD_DISPLAY_RGB_3BIT) && !defined(DMD_MEMLCD_REFERENCE_WRITE_DATA)
+/***************************************************************************//**
+ * @brief
+ *   Read numBits (1 to 32) bits of data starting at bit offset bit. The first
+ *   bit is returned in bit 0. No byte past the last bit is read.
+ ******************************************************************************/
+static uint32_t readDataBits(const uint8_t data[], unsigned int bit,
+                             unsigned int numBits)
+{
+  const uint8_t *pSrc  = &data[bit >> 3];
+  unsigned int   shift = bit & 0x7;
+  unsigned int   numBytes = (shift + numBits + 7) >> 3;
+  uint32_t       word = 0;
+  unsigned int   i;
+
+  /* Little endian, bit 0 of the first byte ends up in bit 0 of word */
+  if (numBytes >= 4) {
+    memcpy(&word, pSrc, 4);
+  } else {
+    for (i = 0; i < numBytes; i++) {
+      word |= (uint32_t)pSrc[i] << (i << 3);
+    }
+  }
+  word >>= shift;
+
+  /* A 32 bit span starting mid byte ends in a fifth byte */
+  if (numBytes == 5) {
+    word |= (uint32_t)pSrc[4] << (32 - shift);
+  }
+
+  return (numBits < 32) ? (word & ((1UL << numBits) - 1)) : word;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Copy rowPixels pixels from bit pixelBit of data to pixel x of the
+ *   framebuffer line at pDst. The first and last words are merged under an
+ *   edge mask, the words in between are stored whole.
+ ******************************************************************************/
+static void writeDataRow(uint8_t *pDst, unsigned int x, const uint8_t data[],
+                         unsigned int pixelBit, unsigned int rowPixels)
+{
+  unsigned int numBits;
+  unsigned int numBytes;
+  unsigned int offset;
+  uint32_t     pixelMask;
+  uint32_t     pixelData;
+  uint32_t     matrixWord;
+  unsigned int i;
+
+  pDst += x >> 3;
+  offset = x & 0x7;
+
+  /* Byte aligned on both sides, the whole bytes copy as they are */
+  if ((offset == 0) && ((pixelBit & 0x7) == 0) && (rowPixels >= 8)) {
+    numBytes = rowPixels >> 3;
+    memcpy(pDst, &data[pixelBit >> 3], numBytes);
+    pDst      += numBytes;
+    pixelBit  += numBytes << 3;
+    rowPixels -= numBytes << 3;
+  }
+
+  while (rowPixels) {
+    /* Bits that fit in the 4 bytes from pDst. Only the first word can
+       start mid byte. */
+    numBits = (rowPixels < 32 - offset) ? rowPixels : 32 - offset;
+    pixelMask = ((numBits < 32) ? ((1UL << numBits) - 1) : 0xFFFFFFFF) << offset;
+    pixelData = readDataBits(data, pixelBit, numBits) << offset;
+    numBytes = (offset + numBits + 7) >> 3;
+
+    if (numBytes == 4) {
+      if (pixelMask == 0xFFFFFFFF) {
+        matrixWord = pixelData;
+      } else {
+        memcpy(&matrixWord, pDst, 4);
+        matrixWord = (matrixWord & ~pixelMask) | pixelData;
+      }
+      memcpy(pDst, &matrixWord, 4);
+    } else {
+      /* End of the row, stay within the bytes it covers */
+      for (i = 0; i < numBytes; i++) {
+        pDst[i] = (pDst[i] & ~(uint8_t)(pixelMask >> (i << 3)))
+                  | (uint8_t)(pixelData >> (i << 3));
+      }
+    }
+
+    pDst      += numBytes;
+    pixelBit  += numBits;
+    rowPixels -= numBits;
+    offset     = 0;
+  }
+}
+#endif
+
 /***************************************************************************//**
  * @brief
  *   Mark the line as dirty.
  ******************************************************************************/
 static void setLineDirty(int line)
 {
-  dirtyRows[line >> DIRTY_WORD_BITS_LOG2] |= 1 << (line & DIRTY_WORD_BITS_LOG2_MASK);
+  dirtyRows[line >> DIRTY_WORD_BITS_LOG2] |= 1UL << (line & DIRTY_WORD_BITS_LOG2_MASK);
 }
 
 /** @endcond */
@@ -73,6 +73,8 @@
 #define DMD_ERROR_NOT_SUPPORTED                 (ECODE_DMD_BASE | 0x000a)
 /** Not enough memory.  */
 #define DMD_ERROR_NOT_ENOUGH_MEMORY             (ECODE_DMD_BASE | 0x000b)
+/** A display update is still in progress.  */
+#define DMD_ERROR_BUSY                          (ECODE_DMD_BASE | 0x000c)
 
 /* Tests */
 /** Device code test */
@@ -95,6 +97,10 @@
     may be defined differently in the future. */
 typedef void DMD_InitConfig;
 
+/** Function called when a display update started by DMD_updateDisplayAsync()
+ *  has completed. Called from interrupt context. */
+typedef void (*DMD_UpdateCallback)(void);
+
 /** @struct DMD_DisplayGeometry
  *  @brief Dimensions of the display
  */
@@ -242,6 +248,40 @@ EMSTATUS DMD_readData(uint16_t x, uint16_t y,
 EMSTATUS DMD_writeColor(uint16_t x, uint16_t y, uint8_t red,
                         uint8_t green, uint8_t blue, uint32_t numPixels);
 
+/***************************************************************************//**
+ *  @brief
+ *    Draws up to 32 pixels of one line in the same color, skipping the
+ *    pixels whose bit in mask is 0
+ *
+ *  @param x
+ *    X coordinate of the first pixel, relative to the clipping area
+ *
+ *  @param y
+ *    Y coordinate of the line, relative to the clipping area
+ *
+ *  @param mask
+ *    Bit n set means the pixel at x + n is written
+ *
+ *  @param numPixels
+ *    Number of pixels covered by mask, 32 at most
+ *
+ *  @param red
+ *    Red component of the color
+ *
+ *  @param green
+ *    Green component of the color
+ *
+ *  @param blue
+ *    Blue component of the color
+ *
+ *  @return
+ *    DMD_OK on success, DMD_ERROR_NOT_SUPPORTED if the display has no
+ *    fast path for this, otherwise error code
+ ******************************************************************************/
+EMSTATUS DMD_writeColorMask(uint16_t x, uint16_t y, uint32_t mask,
+                            uint32_t numPixels, uint8_t red,
+                            uint8_t green, uint8_t blue);
+
 /***************************************************************************//**
  *  @brief
  *    Turns off the display and puts it into sleep mode
@@ -315,6 +355,26 @@ EMSTATUS DMD_getFrameBuffer (void **framebuffer);
  ******************************************************************************/
 EMSTATUS DMD_updateDisplay (void);
 
+/***************************************************************************//**
+ *  @brief
+ *    Start updating the display device with the dirty rows/lines of the
+ *    active framebuffer in the background.
+ *
+ *  @details
+ *    Returns as soon as the transfer is started, callback is called from
+ *    interrupt context when it has completed. The framebuffer must not be
+ *    drawn to, and no other display update started, until then.
+ *
+ *  @param callback
+ *    Function called when the update has completed, may be NULL.
+ *
+ *  @return
+ *    Returns DMD_OK if the update was started, DMD_ERROR_BUSY if an update is
+ *    still in progress, DMD_ERROR_NOT_SUPPORTED if the display can't update in
+ *    the background, error otherwise.
+ ******************************************************************************/
+EMSTATUS DMD_updateDisplayAsync (DMD_UpdateCallback callback);
+
 /** @cond DO_NOT_INCLUDE_WITH_DOXYGEN */
 /* Test functions */
 EMSTATUS DMD_testParameterChecks(void);
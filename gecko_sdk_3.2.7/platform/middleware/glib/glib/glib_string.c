@@ -26,6 +26,105 @@
 #include "glib.h"
 #include "glib_color.h"
 
+/**************************************************************************//**
+*  @brief
+*  Reads one row of a glyph from the font pixel map. Bit 0 is the leftmost
+*  pixel of the row.
+******************************************************************************/
+static uint32_t GLIB_fontRow(const GLIB_Font_t *pFont, uint16_t fontIdx)
+{
+  switch (pFont->sizeOfMapElement) {
+    case 1:
+      return ((const uint8_t *)pFont->pFontPixMap)[fontIdx];
+
+    case 2:
+      return ((const uint16_t *)pFont->pFontPixMap)[fontIdx];
+
+    default:
+      return ((const uint32_t *)pFont->pFontPixMap)[fontIdx];
+  }
+}
+
+/**************************************************************************//**
+*  @brief
+*  Draws a char a whole row at a time through DMD_writeColorMask(), instead
+*  of a clipping check and a DMD_writeColor() call for every pixel.
+*
+*  @return
+*  Returns DMD_ERROR_NOT_SUPPORTED when the display driver has no masked
+*  write, before anything is drawn. Otherwise as GLIB_drawChar().
+******************************************************************************/
+static EMSTATUS GLIB_drawCharMasked(GLIB_Context_t *pContext, uint16_t fontIdx,
+                                    int32_t x, int32_t y, bool opaque)
+{
+  EMSTATUS status;
+  uint8_t fgRed, fgGreen, fgBlue;
+  uint8_t bgRed, bgGreen, bgBlue;
+  int32_t cellWidth = pContext->font.fontWidth + pContext->font.charSpacing;
+  int32_t xStart = x;
+  int32_t numPixels = cellWidth;
+  int32_t skipped = 0;
+  uint32_t glyphMask;
+  uint32_t cellMask;
+  uint32_t fgMask;
+  uint16_t row;
+  uint32_t drawnElements = 0;
+
+  if (cellWidth > 32) {
+    return DMD_ERROR_NOT_SUPPORTED;
+  }
+
+  /* Clip the columns of the char against the clipping region */
+  if (xStart < pContext->clippingRegion.xMin) {
+    skipped = pContext->clippingRegion.xMin - xStart;
+    xStart = pContext->clippingRegion.xMin;
+    numPixels -= skipped;
+  }
+  if (xStart + numPixels - 1 > pContext->clippingRegion.xMax) {
+    numPixels = pContext->clippingRegion.xMax - xStart + 1;
+  }
+  if (numPixels <= 0) {
+    return GLIB_ERROR_NOTHING_TO_DRAW;
+  }
+
+  glyphMask = (pContext->font.fontWidth < 32)
+              ? (1UL << pContext->font.fontWidth) - 1 : 0xFFFFFFFF;
+  cellMask = (numPixels < 32) ? (1UL << numPixels) - 1 : 0xFFFFFFFF;
+
+  GLIB_colorTranslate24bpp(pContext->foregroundColor, &fgRed, &fgGreen, &fgBlue);
+  GLIB_colorTranslate24bpp(pContext->backgroundColor, &bgRed, &bgGreen, &bgBlue);
+
+  for (row = 0; row < pContext->font.fontHeight; row++, fontIdx += pContext->font.fontRowOffset) {
+    if ((y + row < pContext->clippingRegion.yMin)
+        || (y + row > pContext->clippingRegion.yMax)) {
+      continue;
+    }
+
+    /* Bit 1 means draw, Bit 0 means do not draw */
+    fgMask = ((GLIB_fontRow(&pContext->font, fontIdx) & glyphMask) >> skipped) & cellMask;
+
+    if (fgMask) {
+      status = DMD_writeColorMask(xStart, y + row, fgMask, numPixels,
+                                  fgRed, fgGreen, fgBlue);
+      if (status != DMD_OK) {
+        return status;
+      }
+      drawnElements++;
+    }
+
+    /* Background pixels, including the character spacing */
+    if (opaque && (fgMask != cellMask)) {
+      status = DMD_writeColorMask(xStart, y + row, ~fgMask & cellMask, numPixels,
+                                  bgRed, bgGreen, bgBlue);
+      if (status != DMD_OK) {
+        return status;
+      }
+      drawnElements++;
+    }
+  }
+  return ((drawnElements == 0) ? GLIB_ERROR_NOTHING_TO_DRAW : GLIB_OK);
+}
+
 /**************************************************************************//**
 *  @brief
 *  Draws a char using the font supplied with the library.
@@ -54,9 +153,6 @@ EMSTATUS GLIB_drawChar(GLIB_Context_t *pContext, char myChar, int32_t x, int32_t
 {
   EMSTATUS status;
   uint16_t fontIdx;
-  uint8_t *pPixMap8;
-  uint16_t *pPixMap16;
-  uint32_t *pPixMap32;
   uint16_t row;
   uint32_t currentRow;
   uint16_t xOffset;
@@ -89,24 +185,15 @@ EMSTATUS GLIB_drawChar(GLIB_Context_t *pContext, char myChar, int32_t x, int32_t
     return GLIB_ERROR_INVALID_CHAR;
   }
 
-  /* Loop through the rows and draw the font */
-  pPixMap8 = (uint8_t *)pContext->font.pFontPixMap;
-  pPixMap16 = (uint16_t *)pContext->font.pFontPixMap;
-  pPixMap32 = (uint32_t *)pContext->font.pFontPixMap;
+  /* Draw whole glyph rows when the display driver supports it */
+  status = GLIB_drawCharMasked(pContext, fontIdx, x, y, opaque);
+  if (status != DMD_ERROR_NOT_SUPPORTED) {
+    return status;
+  }
 
+  /* Loop through the rows and draw the font pixel by pixel */
   for (row = 0; row < pContext->font.fontHeight; row++) {
-    switch (pContext->font.sizeOfMapElement) {
-      case 1:
-        currentRow = pPixMap8[fontIdx];
-        break;
-
-      case 2:
-        currentRow = pPixMap16[fontIdx];
-        break;
-
-      default:
-        currentRow = pPixMap32[fontIdx];
-    }
+    currentRow = GLIB_fontRow(&pContext->font, fontIdx);
 
     for (xOffset = 0; xOffset < pContext->font.fontWidth; ++xOffset) {
       /* Bit 1 means draw, Bit 0 means do not draw */
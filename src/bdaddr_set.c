@@ -0,0 +1,84 @@
+/* @file      bdaddr_set.c
+ * @version   1.0
+ * @brief     Hash set of Bluetooth device addresses
+ *
+ * @author    Anuhya Kuraparthy, anuhya.kuraparthy@colorado.edu
+ * @date      Nov 03, 2023
+ *
+ * @institution University of Colorado Boulder (UCB)
+ * @course      ECEN 5823: IoT Embedded Firmware
+ * @instructor  David Sluiter
+ *
+ * @assignment Assignment 9 - BLE Client with Security
+ * @due        Nov 03
+ *
+ * @resources  FNV-1a hash, http://www.isthe.com/chongo/tech/comp/fnv/
+ */
+
+#include <string.h>
+
+#include "src/bdaddr_set.h"
+
+#define FNV_OFFSET_BASIS    (2166136261u)
+#define FNV_PRIME           (16777619u)
+
+
+// FNV-1a over the 6 address bytes, folded down to a slot index
+static uint32_t bdaddr_hash(const bd_addr *addr)
+{
+  uint32_t hash = FNV_OFFSET_BASIS;
+
+  for (int i = 0; i < (int) sizeof(addr->addr); i++) {
+      hash ^= addr->addr[i];
+      hash *= FNV_PRIME;
+  }
+
+  return (hash ^ (hash >> 16)) & (BDADDR_SET_SIZE - 1);
+} // bdaddr_hash()
+
+
+// Slot holding addr, or the empty slot where it would go
+static uint32_t bdaddr_probe(const bdaddr_set_t *set, const bd_addr *addr)
+{
+  uint32_t slot = bdaddr_hash(addr);
+
+  while (set->used[slot] &&
+         (memcmp(set->addr[slot].addr, addr->addr, sizeof(addr->addr)) != 0)) {
+      slot = (slot + 1) & (BDADDR_SET_SIZE - 1);
+  }
+
+  return slot;
+} // bdaddr_probe()
+
+
+void bdaddr_set_init(bdaddr_set_t *set)
+{
+  memset(set, 0, sizeof(*set));
+} // bdaddr_set_init()
+
+
+bool bdaddr_set_add(bdaddr_set_t *set, const bd_addr *addr)
+{
+  uint32_t slot = bdaddr_probe(set, addr);
+
+  if (set->used[slot]) {
+      return false;
+  }
+
+  // keep one slot free so a failed lookup always terminates
+  if (set->count >= (BDADDR_SET_SIZE - 1)) {
+      return true;
+  }
+
+  set->addr[slot] = *addr;
+  set->used[slot] = true;
+  set->count++;
+
+  return false;
+} // bdaddr_set_add()
+
+
+bool bdaddr_set_contains(const bdaddr_set_t *set, const bd_addr *addr)
+{
+  return set->used[bdaddr_probe(set, addr)];
+} // bdaddr_set_contains()
@@ -0,0 +1,73 @@
+/* @file      bdaddr_set.h
+ * @version   1.0
+ * @brief     Application interface provided for bdaddr_set.c
+ *
+ * @author    Anuhya Kuraparthy, anuhya.kuraparthy@colorado.edu
+ * @date      Nov 03, 2023
+ *
+ * @institution University of Colorado Boulder (UCB)
+ * @course      ECEN 5823: IoT Embedded Firmware
+ * @instructor  David Sluiter
+ *
+ * @assignment Assignment 9 - BLE Client with Security
+ * @due        Nov 03
+ *
+ * @resources  -
+ */
+
+#ifndef SRC_BDADDR_SET_H_
+#define SRC_BDADDR_SET_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "sl_bt_api.h"
+
+// Slots in the set, must be a power of two and larger than the number of
+// addresses added so probing always finds an empty slot
+#define BDADDR_SET_SIZE     (16)
+
+
+/*
+ * Open addressing hash set of Bluetooth device addresses, used by the
+ * Client as its allow-list of Servers. Lookups hash the 6 address bytes and
+ * probe linearly, so a scan report is checked in O(1) however many Servers
+ * are listed.
+ */
+typedef struct {
+  bd_addr   addr[BDADDR_SET_SIZE];
+  bool      used[BDADDR_SET_SIZE];
+  uint8_t   count;
+} bdaddr_set_t;
+
+
+/**
+* @brief Function to empty a set
+*
+*
+* @param set  set to initialise
+* @return void
+*/
+void bdaddr_set_init(bdaddr_set_t *set);
+
+/**
+* @brief Function to add an address, adding an address twice is a no-op
+*
+*
+* @param set   set to add to
+* @param addr  address to add
+* @return bool false on success, true if the set is full
+*/
+bool bdaddr_set_add(bdaddr_set_t *set, const bd_addr *addr);
+
+/**
+* @brief Function to look up an address
+*
+*
+* @param set   set to search
+* @param addr  address to look for
+* @return bool true when addr is in the set
+*/
+bool bdaddr_set_contains(const bdaddr_set_t *set, const bd_addr *addr);
+
+#endif /* SRC_BDADDR_SET_H_ */
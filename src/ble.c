@@ -22,33 +22,55 @@
 
 #include "gatt_db.h"
 #include "sl_status.h"
-#include "math.h" // need function prototype for pow()
 
 #include "src/i2c.h"
 #include "src/lcd.h"
 #include "src/gpio.h"
 #include "src/scheduler.h"
+#include "src/ring.h"
+#include "src/irq.h"
+#include "src/bdaddr_set.h"
+#include "src/workq.h"
 
 #define INCLUDE_LOG_DEBUG 1
 #include "src/log.h"
 
-#define QUEUE_DEPTH      (16)
+#define CONNECTION_QUEUE_SIZE     (512)     // bytes per connection, must be a power of two
+#define BUTTON_RING_SIZE          (32)      // bytes, must be a power of two
+#define NOTIFICATION_BATCH_MAX    (4)       // notifications queued per drain call
+#define PAYLOAD_REPORT_MS         (10000)   // how often the throughput is logged
+
+// ring_init() refuses anything else, and no indication could be queued
+_Static_assert(RING_SIZE_OK(CONNECTION_QUEUE_SIZE) &&
+               RING_MAX_LEN_OK(CONNECTION_QUEUE_SIZE, INDICATION_MAX_LEN),
+               "CONNECTION_QUEUE_SIZE must be a power of two that holds an INDICATION_MAX_LEN record");
 
 // BLE private data
 ble_data_struct_t ble_data;
 sl_status_t sc = 0;
-bd_addr server_addr = SERVER_BT_ADDRESS;
-int32_t temperature_from_server = 0;
 
-queue_struct_t   my_queue[QUEUE_DEPTH]; // This is the storage for your queue
+// Per-connection state. connection_slot[] maps a connection handle to its
+// index + 1 (0 = not connected) so every event finds its entry in O(1).
+// The server indexes connections[], the client indexes servers[].
+static ble_connection_t  connections[BLE_MAX_CONNECTIONS];
+#if DEVICE_IS_BLE_SERVER
+static uint8_t           connection_queue_storage[BLE_MAX_CONNECTIONS][CONNECTION_QUEUE_SIZE];
+#endif
+static uint8_t           connection_slot[256];
 
-//circular buffer metadata
-uint32_t         wptr = 0;              // write pointer
-uint32_t         rptr = 0;              // read pointer
-bool isFullflag = false;                // Flag to handle the full condition
+// Button edges captured by the GPIO ISR, drained by the BT event loop
+static uint8_t   button_ring_storage[BUTTON_RING_SIZE];
+static ring_t    button_ring = RING_INIT(button_ring_storage, sizeof(uint8_t));
 
 queue_struct_t dequeued_element;
 
+#if DEVICE_IS_BLE_SERVER
+// Temperature samples waiting to go out as one gattdb_temperature_batch packet
+static uint8_t   temp_batch[INDICATION_MAX_LEN];
+static uint8_t   temp_batch_count = 0;
+static uint32_t  temp_batch_start_ms = 0;
+#endif
+
 typedef enum uint32_t {
   PB0_pressed,
   PB1_pressed,
@@ -65,6 +87,19 @@ static const uint8_t service_uuid[2] = { 0x09, 0x18 };
 static const uint8_t button_characteristic_uuid[] =  { 0x89, 0x62, 0x13, 0x2d, 0x2a, 0x65, 0xec, 0x87, 0x3e, 0x43, 0xc8, 0x38, 0x02, 0x00, 0x00, 0x00 }; // Reverse the byte order for little-endian format
 static const uint8_t button_service_uuid[] =  { 0x89, 0x62, 0x13, 0x2d, 0x2a, 0x65, 0xec, 0x87, 0x3e, 0x43, 0xc8, 0x38, 0x01, 0x00, 0x00, 0x00 };
 
+// Servers we connect to, from ble_device_type.h
+static const bd_addr server_addresses[] = SERVER_BT_ADDRESS_LIST;
+#define NUM_SERVER_ADDRESSES    (sizeof(server_addresses) / sizeof(server_addresses[0]))
+
+static const uint8_t gatt_service_uuid[] = { 0x01, 0x18 };
+
+static bdaddr_set_t  server_allow_list;
+static ble_server_t  servers[BLE_MAX_CONNECTIONS];
+
+// Discovered handles of the Servers seen since boot
+static ble_discovery_cache_t  discovery_cache[DISCOVERY_CACHE_SIZE];
+static uint32_t               discovery_cache_clock = 0;
+
 #endif
 
 
@@ -74,47 +109,314 @@ ble_data_struct_t* getBleDataPtr() {
 } // getBleDataPtr()
 
 
-static uint32_t nextPtr(uint32_t ptr)
+#if !DEVICE_IS_BLE_SERVER
+
+ble_server_t* ble_server_find(uint8_t connection_handle)
 {
+  uint8_t slot = connection_slot[connection_handle];
 
-  if(ptr+1 == QUEUE_DEPTH)
-    return 0;
-  else
-    return ptr + 1;
+  if (slot == 0)
+    return NULL;
+
+  return &servers[slot - 1];
+} // ble_server_find()
+
+
+// Claim a free table entry for a newly connected Server, NULL if full
+static ble_server_t* server_add(uint8_t connection_handle, uint8_t bonding, const bd_addr *address)
+{
+  ble_data_struct_t *bleDataPtr = getBleDataPtr();
+  ble_server_t      *server;
+
+  for (int i = 0; i < BLE_MAX_CONNECTIONS; i++)
+    {
+      server = &servers[i];
+
+      if (server->in_use)
+        continue;
+
+      memset(server, 0, sizeof(*server));
+      server->address = *address;
+      server->connection_handle = connection_handle;
+      server->bonding = bonding;
+      server->opened_ms = letimerMilliseconds();
+      server->in_use = true;
+
+      connection_slot[connection_handle] = (uint8_t) (i + 1);
+      bleDataPtr->num_connections++;
+
+      return server;
+    }
+
+  return NULL;
+} // server_add()
 
-} // nextPtr()
 
+// Discovery reports every service and characteristic, so compare the
+// length too: a 16-bit UUID must not match the start of a 128-bit one
+static bool uuid_matches(const uint8array *uuid, const uint8_t *expected, size_t len)
+{
+  return (uuid->len == len) && (memcmp(uuid->data, expected, len) == 0);
+} // uuid_matches()
 
-//typedef struct {
-//  uint8_t        buffer[5];     // The actual data buffer for the indication.
-//  uint16_t       charHandle;    // Char handle from gatt_db.h
-//  size_t        bufferLength;    // Length of buffer in bytes to send
-//} queue_struct_t;
 
-bool write_queue (uint8_t a[], uint16_t b, size_t c)
+ble_discovery_cache_t* ble_discovery_cache_find(const bd_addr *address)
 {
-    if(isFullflag)
+  for (int i = 0; i < DISCOVERY_CACHE_SIZE; i++)
     {
-      LOG_INFO("\n Buffer is Full \n");
-      return true;
+      if (discovery_cache[i].valid &&
+          (memcmp(discovery_cache[i].address.addr, address->addr, sizeof(address->addr)) == 0))
+        {
+          discovery_cache[i].last_used = ++discovery_cache_clock;
+          return &discovery_cache[i];
+        }
     }
-    else
+
+  return NULL;
+} // ble_discovery_cache_find()
+
+
+void ble_discovery_cache_store(const ble_server_t *server)
+{
+  ble_discovery_cache_t *entry = ble_discovery_cache_find(&server->address);
+
+  if (entry == NULL)
     {
-      my_queue[wptr].bufferLength = c;
-      my_queue[wptr].charHandle = b;
+      // an empty slot, else the least recently used one
+      entry = &discovery_cache[0];
+      for (int i = 0; i < DISCOVERY_CACHE_SIZE; i++)
+        {
+          if (!discovery_cache[i].valid)
+            {
+              entry = &discovery_cache[i];
+              break;
+            }
+          if (discovery_cache[i].last_used < entry->last_used)
+            entry = &discovery_cache[i];
+        }
+    }
 
-      for (unsigned int i=0; i < c; i++){
-        my_queue[wptr].buffer[i] = a[i];
-      }
+  entry->address = server->address;
+  entry->last_used = ++discovery_cache_clock;
+  entry->characteristic = server->characteristic;
+  entry->button_characteristic = server->button_characteristic;
+  entry->hash_characteristic = server->hash_characteristic;
+  memcpy(entry->database_hash, server->database_hash, DATABASE_HASH_LEN);
+  entry->valid = true;
+} // ble_discovery_cache_store()
 
-      if (nextPtr(wptr) == rptr)
-      {
-        isFullflag = true;      //write pointer suppression
+
+static void server_remove(ble_server_t *server)
+{
+  ble_data_struct_t *bleDataPtr = getBleDataPtr();
+
+  connection_slot[server->connection_handle] = 0;
+  server->in_use = false;
+  bleDataPtr->num_connections--;
+} // server_remove()
+
+
+// True when address is already connected, so its adverts can be ignored
+static bool server_is_connected(const bd_addr *address)
+{
+  for (int i = 0; i < BLE_MAX_CONNECTIONS; i++)
+    {
+      if (servers[i].in_use &&
+          (memcmp(servers[i].address.addr, address->addr, sizeof(address->addr)) == 0))
+        return true;
+    }
+
+  return false;
+} // server_is_connected()
+
+
+// Start scanning while there are allow-listed Servers left to connect to
+// and no connection attempt is outstanding, stop once all are connected
+static void scan_for_servers()
+{
+  ble_data_struct_t *bleDataPtr = getBleDataPtr();
+  bool want_scan = (bleDataPtr->connection_pending == false) &&
+                   (bleDataPtr->num_connections < BLE_MAX_CONNECTIONS) &&
+                   (bleDataPtr->num_connections < server_allow_list.count);
+
+  if (want_scan && !bleDataPtr->scanning)
+    {
+      sc = sl_bt_scanner_start(1, sl_bt_scanner_discover_generic);
+      if (sc != SL_STATUS_OK) {
+          LOG_ERROR("sl_bt_scanner_start() returned != 0 status=0x%04x", (unsigned int) sc);
       }
-      else
-      {
-        wptr = nextPtr(wptr);
+      bleDataPtr->scanning = true;
+    }
+  else if (!want_scan && bleDataPtr->scanning)
+    {
+      sc = sl_bt_scanner_stop();
+      if (sc != SL_STATUS_OK) {
+          LOG_ERROR("sl_bt_scanner_stop() returned != 0 status=0x%04x", (unsigned int) sc);
       }
+      bleDataPtr->scanning = false;
+    }
+
+  if (bleDataPtr->num_connections == 0)
+    displayPrintf(DISPLAY_ROW_CONNECTION, "Scanning");
+  else
+    displayPrintf(DISPLAY_ROW_CONNECTION, "Servers %d/%d",
+                  (int) bleDataPtr->num_connections, (int) server_allow_list.count);
+} // scan_for_servers()
+
+
+// Show the min/avg/max of the latest temperature from every Server
+static void display_temperatures()
+{
+  int32_t  sum = 0;
+  int32_t  min = INT32_MAX;
+  int32_t  max = INT32_MIN;
+  int      count = 0;
+
+  for (int i = 0; i < BLE_MAX_CONNECTIONS; i++)
+    {
+      if (servers[i].in_use && servers[i].temperature_valid)
+        {
+          sum += servers[i].temperature;
+          if (servers[i].temperature < min)
+            min = servers[i].temperature;
+          if (servers[i].temperature > max)
+            max = servers[i].temperature;
+          count++;
+        }
+    }
+
+  if (count == 0)
+    {
+      displayPrintf(DISPLAY_ROW_TEMPVALUE, "");
+      displayPrintf(DISPLAY_ROW_8, "");
+      return;
+    }
+
+  displayPrintf(DISPLAY_ROW_TEMPVALUE, "Temp = %d (%d)", (int) (sum / count), count);
+  displayPrintf(DISPLAY_ROW_8, "Min=%d Max=%d", (int) min, (int) max);
+} // display_temperatures()
+
+#endif
+
+#if DEVICE_IS_BLE_SERVER
+
+// Connection table entry for a connection handle, NULL if not connected
+static ble_connection_t* connection_find(uint8_t connection_handle)
+{
+  uint8_t slot = connection_slot[connection_handle];
+
+  if (slot == 0)
+    return NULL;
+
+  return &connections[slot - 1];
+} // connection_find()
+
+
+// Claim a free table entry for a new connection, NULL if the table is full
+static ble_connection_t* connection_add(uint8_t connection_handle, uint8_t bonding)
+{
+  ble_data_struct_t *bleDataPtr = getBleDataPtr();
+  ble_connection_t  *conn;
+
+  for (int i = 0; i < BLE_MAX_CONNECTIONS; i++)
+    {
+      conn = &connections[i];
+
+      if (conn->in_use)
+        continue;
+
+      // the consumer reads into dequeued_element.buffer, INDICATION_MAX_LEN long
+      if (ring_init(&conn->queue, connection_queue_storage[i], CONNECTION_QUEUE_SIZE, INDICATION_MAX_LEN))
+        {
+          LOG_ERROR("ring_init() failed for connection %d", (int) connection_handle);
+          return NULL;
+        }
+
+      conn->payload_bytes_sent = 0;
+      conn->payload_report_start_ms = letimerMilliseconds();
+      conn->mtu = ATT_DEFAULT_MTU;            // until the MTU exchange completes
+      conn->connection_interval = 0;
+      conn->tx_size = 0;
+      conn->connection_handle = connection_handle;
+      conn->bonding = bonding;
+      conn->htm_client_config = sl_bt_gatt_server_disable;
+      conn->button_client_config = sl_bt_gatt_server_disable;
+      conn->batch_client_config = sl_bt_gatt_server_disable;
+      conn->bonded = (bonding != SL_BT_INVALID_BONDING_HANDLE);
+      conn->indication_in_flight = false;
+      conn->in_use = true;
+
+      connection_slot[connection_handle] = (uint8_t) (i + 1);
+      bleDataPtr->num_connections++;
+
+      return conn;
+    }
+
+  return NULL;
+} // connection_add()
+
+
+// Release a table entry, anything still queued for it is discarded
+static void connection_remove(ble_connection_t *conn)
+{
+  ble_data_struct_t *bleDataPtr = getBleDataPtr();
+
+  connection_slot[conn->connection_handle] = 0;
+  conn->in_use = false;
+  bleDataPtr->num_connections--;
+} // connection_remove()
+
+
+// Recompute the any-client summaries in ble_data_struct_t and the LEDs
+// after a CCCD changed or a connection closed
+static void update_subscriptions()
+{
+  ble_data_struct_t *bleDataPtr = getBleDataPtr();
+  uint8_t htm = sl_bt_gatt_server_disable;
+  uint8_t button = sl_bt_gatt_server_disable;
+  uint8_t batch = sl_bt_gatt_server_disable;
+
+  for (int i = 0; i < BLE_MAX_CONNECTIONS; i++)
+    {
+      if (connections[i].in_use)
+        {
+          htm    |= connections[i].htm_client_config;
+          button |= connections[i].button_client_config;
+          batch  |= connections[i].batch_client_config;
+        }
+    }
+
+  if (bleDataPtr->ok_to_send_htm_indications && (htm == sl_bt_gatt_server_disable))
+    displayPrintf(DISPLAY_ROW_TEMPVALUE, " ");
+
+  bleDataPtr->ok_to_send_htm_indications = (htm != sl_bt_gatt_server_disable);
+  bleDataPtr->button_indication = (button != sl_bt_gatt_server_disable);
+  bleDataPtr->batch_client_config = batch;
+
+  // nobody will receive the pending samples
+  if (batch == sl_bt_gatt_server_disable)
+    temp_batch_count = 0;
+
+  if (bleDataPtr->ok_to_send_htm_indications)
+    gpioLed0SetOn();
+  else
+    gpioLed0SetOff();
+
+  if (bleDataPtr->button_indication)
+    gpioLed1SetOn();
+  else
+    gpioLed1SetOff();
+} // update_subscriptions()
+
+#endif
+
+
+bool write_queue (ble_connection_t *conn, uint8_t a[], uint16_t b, size_t c)
+{
+    if (ring_put(&conn->queue, b, a, c))
+    {
+      LOG_INFO("\n Buffer is Full for connection %d \n", (int) conn->connection_handle);
+      return true;
     }
 
     return false;
@@ -122,35 +424,271 @@ bool write_queue (uint8_t a[], uint16_t b, size_t c)
 } // write_queue()
 
 
+void ble_button_event_from_isr(uint8_t button_value)
+{
+  // A full ring only loses the newest edge, the scheduler event still fires
+  (void) ring_put(&button_ring, gattdb_button_state, &button_value, sizeof(button_value));
+} // ble_button_event_from_isr()
+
 
-// read_queue(
-bool read_queue (uint8_t *a, uint16_t *b, size_t *c)
+// Client characteristic configuration for a characteristic we queue updates for
+static uint8_t client_config_for(const ble_connection_t *conn, uint16_t charHandle)
 {
+  if (charHandle == gattdb_temperature_measurement)
+    return conn->htm_client_config;
 
-  if(wptr == rptr && isFullflag != 1)
-  {
-      LOG_INFO("\n Buffer is Empty \n");
-      return true;
-  }
+  if (charHandle == gattdb_button_state)
+    return conn->button_client_config;
+
+  if (charHandle == gattdb_temperature_batch)
+    return conn->batch_client_config;
+
+  return sl_bt_gatt_server_disable;
+} // client_config_for()
+
+
+// Send the updates queued for one connection in FIFO order.
+// Entries whose CCCD has notifications enabled go out back to back as
+// notifications, up to NOTIFICATION_BATCH_MAX per call, so they share a
+// connection event. An entry for a client that only enabled indications is
+// sent as an indication and stops the batch until it is confirmed.
+// Called whenever something is queued and whenever the in-flight indication
+// is confirmed or times out.
+static void drain_indication_queue(ble_connection_t *conn)
+{
+  uint8_t            client_config;
+
+  if (conn->in_use != true)
+    {
+      return;
+    }
+
+  for (int i = 0; i < NOTIFICATION_BATCH_MAX; i++)
+    {
+      // Leave the entry queued until the stack has accepted it
+      if (ring_peek(&conn->queue,
+                    &(dequeued_element.charHandle),
+                    &(dequeued_element.buffer[0]),
+                    &(dequeued_element.bufferLength),
+                    sizeof(dequeued_element.buffer)))
+        {
+          return;
+        }
+
+      client_config = client_config_for(conn, dequeued_element.charHandle);
+
+      // ATT_MTU only grows during a connection and the queue is reset on
+      // open, so this only guards against a producer ignoring the MTU
+      if (dequeued_element.bufferLength > (size_t) (conn->mtu - ATT_HEADER_LEN))
+        {
+          LOG_ERROR("Dropping %u byte update, ATT_MTU is %u",
+                    (unsigned int) dequeued_element.bufferLength, (unsigned int) conn->mtu);
+          ring_drop(&conn->queue);
+          continue;
+        }
+
+      if (client_config & sl_bt_gatt_server_notification)
+        {
+          sc = sl_bt_gatt_server_send_notification(conn->connection_handle,
+                                                   dequeued_element.charHandle,
+                                                   dequeued_element.bufferLength,
+                                                   &(dequeued_element.buffer[0]));
+
+          if (sc != SL_STATUS_OK)
+            {
+              // SL_STATUS_NO_MORE_RESOURCE: stack buffers are full for this
+              // connection event, retry on the next queue/confirm/timer event
+              if (sc != SL_STATUS_NO_MORE_RESOURCE)
+                LOG_ERROR("sl_bt_gatt_server_send_notification() returned != 0 status=0x%04x", (unsigned int) sc);
+              return;
+            }
+
+          conn->payload_bytes_sent += dequeued_element.bufferLength;
+          ring_drop(&conn->queue);
+        }
+      else if (client_config & sl_bt_gatt_server_indication)
+        {
+          if (conn->indication_in_flight)
+            {
+              return;
+            }
+
+          sc = sl_bt_gatt_server_send_indication(conn->connection_handle,
+                                                 dequeued_element.charHandle,
+                                                 dequeued_element.bufferLength,
+                                                 &(dequeued_element.buffer[0]));
+
+          if (sc != SL_STATUS_OK)
+            {
+              LOG_ERROR("sl_bt_gatt_server_send_indication() returned != 0 status=0x%04x", (unsigned int) sc);
+              return;
+            }
+
+          conn->indication_in_flight = true;
+          conn->payload_bytes_sent += dequeued_element.bufferLength;
+          ring_drop(&conn->queue);
+          return;
+        }
+      else
+        {
+          // client unsubscribed after this was queued
+          ring_drop(&conn->queue);
+        }
+    }
+} // drain_indication_queue()
+
+
+// Queue one update for every connection subscribed to charHandle and start
+// sending it. Button updates only go to bonded clients.
+static void queue_update(uint8_t data[], uint16_t charHandle, size_t len)
+{
+  ble_connection_t *conn;
+
+  for (int i = 0; i < BLE_MAX_CONNECTIONS; i++)
+    {
+      conn = &connections[i];
+
+      if ((conn->in_use != true) ||
+          (client_config_for(conn, charHandle) == sl_bt_gatt_server_disable))
+        continue;
+
+      if ((charHandle == gattdb_button_state) && (conn->bonded != true))
+        continue;
+
+      write_queue(conn, data, charHandle, len);
+      drain_indication_queue(conn);
+    }
+} // queue_update()
+
+
+#if DEVICE_IS_BLE_SERVER
+
+// Samples that fit in one payload of the smallest ATT_MTU among the
+// temperature batch subscribers, capped by TEMP_BATCH_SAMPLES_PER_PACKET
+static uint8_t temperature_batch_capacity()
+{
+  uint32_t payload = INDICATION_MAX_LEN;
+  uint32_t samples;
+
+  for (int i = 0; i < BLE_MAX_CONNECTIONS; i++)
+    {
+      if ((connections[i].in_use) &&
+          (connections[i].batch_client_config != sl_bt_gatt_server_disable) &&
+          ((uint32_t) (connections[i].mtu - ATT_HEADER_LEN) < payload))
+        {
+          payload = connections[i].mtu - ATT_HEADER_LEN;
+        }
+    }
+
+  samples = (payload - TEMP_BATCH_HEADER_LEN) / TEMP_BATCH_SAMPLE_LEN;
+
+  if (samples > TEMP_BATCH_SAMPLES_PER_PACKET)
+    samples = TEMP_BATCH_SAMPLES_PER_PACKET;
+
+  return (uint8_t) samples;
+} // temperature_batch_capacity()
+
+
+// Queue the pending batch, if any, as one gattdb_temperature_batch update
+static void temperature_batch_flush()
+{
+  if (temp_batch_count == 0)
+    return;
+
+  temp_batch[0] = temp_batch_count;
+  queue_update(temp_batch,
+               gattdb_temperature_batch,
+               TEMP_BATCH_HEADER_LEN + (temp_batch_count * TEMP_BATCH_SAMPLE_LEN));
+  temp_batch_count = 0;
+} // temperature_batch_flush()
+
+
+// Flush the pending batch once its oldest sample reaches TEMP_BATCH_MAX_AGE_MS
+static void temperature_batch_check_age()
+{
+  if ((temp_batch_count != 0) &&
+      ((letimerMilliseconds() - temp_batch_start_ms) >= TEMP_BATCH_MAX_AGE_MS))
+    {
+      temperature_batch_flush();
+    }
+} // temperature_batch_check_age()
+
+
+// Append one sample to the pending batch, flushing on count, size or age
+static void temperature_batch_add(uint32_t htm_temperature_flt)
+{
+  ble_data_struct_t *bleDataPtr = getBleDataPtr();
+  uint32_t now = letimerMilliseconds();
+  uint8_t  *p;
+
+  if (bleDataPtr->batch_client_config == sl_bt_gatt_server_disable)
+    return;
+
+  // the per-sample offset is 16 bits wide
+  if ((temp_batch_count != 0) && ((now - temp_batch_start_ms) > 0xFFFF))
+    temperature_batch_flush();
+
+  if (temp_batch_count == 0)
+    {
+      temp_batch_start_ms = now;
+      p = &temp_batch[1];
+      UINT32_TO_BITSTREAM(p, temp_batch_start_ms);
+    }
+
+  p = &temp_batch[TEMP_BATCH_HEADER_LEN + (temp_batch_count * TEMP_BATCH_SAMPLE_LEN)];
+  *p++ = (uint8_t) (now - temp_batch_start_ms);
+  *p++ = (uint8_t) ((now - temp_batch_start_ms) >> 8);
+  UINT32_TO_BITSTREAM(p, htm_temperature_flt);
+  temp_batch_count++;
+
+  if (temp_batch_count >= temperature_batch_capacity())
+    temperature_batch_flush();
   else
-  {
-      for (unsigned int i = 0; i < *c; i++) {
-          a[i] = my_queue[rptr].buffer[i];
-      }
-    *b = my_queue[rptr].charHandle;
-    *c = my_queue[rptr].bufferLength;
+    temperature_batch_check_age();
+} // temperature_batch_add()
 
-    rptr = nextPtr(rptr);
 
-    if (isFullflag)                   //dequeue an element
+// Log the payload bytes sent per connection interval over the last
+// PAYLOAD_REPORT_MS, run from the work queue after each 1 s soft timer
+static void report_payload_throughput(ble_connection_t *conn)
+{
+  uint32_t now = letimerMilliseconds();
+  uint32_t window_ms = now - conn->payload_report_start_ms;
+
+  if (window_ms < PAYLOAD_REPORT_MS)
+    return;
+
+  // interval is in 1.25 ms units: bytes per interval = bytes * interval * 5 / (window_ms * 4)
+  if ((conn->payload_bytes_sent != 0) && (conn->connection_interval != 0))
     {
-        isFullflag = false;           //clearing the flag
-        wptr = nextPtr(wptr);         //incremeting the wptr
+      LOG_INFO("Connection %u: sent %u payload bytes in %u ms, %u bytes per %u us interval (ATT_MTU=%u, DLE tx=%u)",
+               (unsigned int) conn->connection_handle,
+               (unsigned int) conn->payload_bytes_sent,
+               (unsigned int) window_ms,
+               (unsigned int) ((conn->payload_bytes_sent * conn->connection_interval * 5) / (window_ms * 4)),
+               (unsigned int) (conn->connection_interval * 1250),
+               (unsigned int) conn->mtu,
+               (unsigned int) conn->tx_size);
     }
-  }
 
-  return false;
-} // read_queue()
+  conn->payload_bytes_sent = 0;
+  conn->payload_report_start_ms = now;
+} // report_payload_throughput()
+
+
+// deferred from the soft timer, logging is not radio critical
+static void report_all_throughput(void)
+{
+  for (int i = 0; i < BLE_MAX_CONNECTIONS; i++)
+    {
+      if (connections[i].in_use)
+        report_payload_throughput(&connections[i]);
+    }
+} // report_all_throughput()
+
+static workq_item_t throughput_work = WORKQ_ITEM_INIT(report_all_throughput, WORKQ_PRIORITY_LOW);
+
+#endif
 
 
 void send_temperature()
@@ -159,17 +697,33 @@ void send_temperature()
   uint8_t *p = htm_temperature_buffer;
   uint32_t htm_temperature_flt;
   int32_t temperature_in_c;
+#if SI7021_MEASURE_HUMIDITY
+  int32_t humidity_mrh;
+#endif
   uint8_t flags = 0x00;
 
   ble_data_struct_t *bleDataPtr = getBleDataPtr();
 
   if (bleDataPtr->connection_open == true){
 
-      temperature_in_c = (uint32_t)read_temp_from_si7021();
+      // milli-degrees all the way into the FLOAT, no float maths
+      bleDataPtr->temperature_mc = read_temp_from_si7021();
+      temperature_in_c = bleDataPtr->temperature_mc / 1000;
+
+#if SI7021_MEASURE_HUMIDITY
+      // no GATT characteristic for it yet, shown on the LCD
+      humidity_mrh = read_humidity_from_si7021();
+      if (humidity_mrh == SI7021_HUMIDITY_INVALID) {
+          displayPrintf(DISPLAY_ROW_8, "Humidity=--");
+      } else {
+          bleDataPtr->humidity_mrh = humidity_mrh;
+          displayPrintf(DISPLAY_ROW_8, "Humidity=%d%%", (int) (humidity_mrh / 1000));
+      }
+#endif
 
       UINT8_TO_BITSTREAM(p, flags);
 
-      htm_temperature_flt = UINT32_TO_FLOAT(temperature_in_c*1000, -3);
+      htm_temperature_flt = UINT32_TO_FLOAT(bleDataPtr->temperature_mc, -3);
       // Convert temperature to bitstream and place it in the htm_temperature_buffer
       UINT32_TO_BITSTREAM(p, htm_temperature_flt);
 
@@ -183,33 +737,15 @@ void send_temperature()
                    LOG_ERROR("sl_bt_gatt_server_write_attribute_value() returned != 0 status=0x%04x", (unsigned int) sc);
                }
 
-      // Pass the GATT attribute only if the indications are set
-      if(bleDataPtr->ok_to_send_htm_indications){
-
-        if(bleDataPtr->indication_in_flight == false){
-
-          sc = sl_bt_gatt_server_send_indication(bleDataPtr->connection_handle,
-                                                 gattdb_temperature_measurement,
-                                                 5,
-                                                 &htm_temperature_buffer[0]);
+      displayPrintf(DISPLAY_ROW_TEMPVALUE, "Temp=%d", temperature_in_c);
 
-          if (sc != SL_STATUS_OK) {
-                       LOG_ERROR("sl_bt_gatt_server_send_indication() returned != 0 status=0x%04x", (unsigned int) sc);
-                   }
-          else{
-              bleDataPtr->indication_in_flight = true;
-              displayPrintf(DISPLAY_ROW_TEMPVALUE, "Temp=%d", temperature_in_c);
-          }
-
-        }
-
-        else{
-            bool failure = write_queue(htm_temperature_buffer, gattdb_temperature_measurement, 5);
-
-            if(!failure)
-              bleDataPtr->queued_indications++;
-        }
+#if DEVICE_IS_BLE_SERVER
+      temperature_batch_add(htm_temperature_flt);
+#endif
 
+      // Pass the GATT attribute to every client that enabled it
+      if(bleDataPtr->ok_to_send_htm_indications){
+          queue_update(htm_temperature_buffer, gattdb_temperature_measurement, 5);
       }
   }
 }
@@ -239,42 +775,37 @@ void send_button_indication(uint8_t button_value)
                    LOG_ERROR("sl_bt_gatt_server_write_attribute_value() returned != 0 status=0x%04x", (unsigned int) sc);
                }
 
-      if (bleDataPtr->button_indication && bleDataPtr->bonded)
+      // queue_update() skips clients that are not bonded
+      if (bleDataPtr->button_indication)
         {
-          if (!bleDataPtr->indication_in_flight)
-            {
-              //no indication in-flight
-
-              sc = sl_bt_gatt_server_send_indication(bleDataPtr->connection_handle,
-                                                     gattdb_button_state,
-                                                     2,
-                                                     &button_value_array[0]);
-
-              if (sc != SL_STATUS_OK)
-                      {
-                           LOG_ERROR("sl_bt_gatt_server_write_attribute_value() returned != 0 status=0x%04x", (unsigned int) sc);
-                      }
-              else
-                {
-                  bleDataPtr->indication_in_flight = true;
-                }
-            }
-
-          else
-            {
-              //indicaton in-flight
-              bool failure = write_queue(button_value_array,
-                                         gattdb_button_state,
-                                         2);
-              if(!failure)
-                bleDataPtr->queued_indications++;
-            }
+          queue_update(button_value_array,
+                       gattdb_button_state,
+                       2);
         }
   }
 
 
 }
 
+#if DEVICE_IS_BLE_SERVER
+
+// Replay every button edge the GPIO ISR captured since the last event,
+// so a quick press/release pair is not collapsed into one state
+static void drain_button_events()
+{
+  uint8_t  button_value;
+  uint16_t charHandle;
+  size_t   len;
+
+  while (!ring_get(&button_ring, &charHandle, &button_value, &len, sizeof(button_value)))
+    {
+      displayPrintf(DISPLAY_ROW_9, button_value ? "Button pressed" : "Button released");
+
+      send_button_indication(button_value);
+    }
+} // drain_button_events()
+
+#endif
 
 #if !DEVICE_IS_BLE_SERVER
 
@@ -302,8 +833,17 @@ static int32_t FLOAT_TO_INT32(const uint8_t *value_start_little_endian)
     (value_start_little_endian[3] << 16) |
     (mantissaSignByte << 24) ;
 
-    // value = 10^exponent * mantissa; pow() returns a double type
-    return (int32_t) (pow( (double) 10, (double) exponent) * (double) mantissa);
+    // value = 10^exponent * mantissa, truncated towards zero
+    while (exponent < 0) {
+        mantissa /= 10;
+        exponent++;
+    }
+    while (exponent > 0) {
+        mantissa *= 10;
+        exponent--;
+    }
+
+    return mantissa;
 } // FLOAT_TO_INT32
 
 #endif
@@ -318,6 +858,11 @@ void handle_ble_event(sl_bt_msg_t *evt) {
 #endif
 
   ble_data_struct_t *bleDataPtr = getBleDataPtr();
+#if DEVICE_IS_BLE_SERVER
+  ble_connection_t  *conn;
+#else
+  ble_server_t      *server;
+#endif
 
 
   switch (SL_BT_MSG_ID(evt->header)) {
@@ -393,15 +938,43 @@ void handle_ble_event(sl_bt_msg_t *evt) {
               LOG_ERROR("sl_bt_scanner_set_timing() returned != 0 status=0x%04x", (unsigned int) sc);
           }
 
-          sc = sl_bt_scanner_start(1, sl_bt_scanner_discover_generic);
-          if (sc != SL_STATUS_OK) {
-              LOG_ERROR("sl_bt_scanner_set_timing() returned != 0 status=0x%04x", (unsigned int) sc);
+          bdaddr_set_init(&server_allow_list);
+          for (int i = 0; i < (int) NUM_SERVER_ADDRESSES; i++) {
+              if (bdaddr_set_add(&server_allow_list, &server_addresses[i])) {
+                  LOG_ERROR("Server allow-list is full, %d of %d added", i, (int) NUM_SERVER_ADDRESSES);
+                  break;
+              }
           }
 
+          bleDataPtr->num_connections = 0;
+          bleDataPtr->scanning = false;
+          bleDataPtr->connection_pending = false;
+          bleDataPtr->scan_start_ms = letimerMilliseconds();
+
           displayPrintf(DISPLAY_ROW_NAME, "Client");
-          displayPrintf(DISPLAY_ROW_CONNECTION, "Scanning");
+          scan_for_servers();
+
+#endif
 
+          // Allow the largest ATT_MTU our queue entries can use. The stack
+          // runs the MTU exchange and the LE data length update itself
+          // once a connection opens; the results arrive as
+          // sl_bt_evt_gatt_mtu_exchanged and sl_bt_evt_connection_parameters.
+          {
+            uint16_t max_mtu_out;
+
+#if DEVICE_IS_BLE_SERVER
+            sc = sl_bt_gatt_server_set_max_mtu(ATT_MAX_MTU, &max_mtu_out);
+            if (sc != SL_STATUS_OK) {
+                LOG_ERROR("sl_bt_gatt_server_set_max_mtu() returned != 0 status=0x%04x", (unsigned int) sc);
+            }
+#else
+            sc = sl_bt_gatt_set_max_mtu(ATT_MAX_MTU, &max_mtu_out);
+            if (sc != SL_STATUS_OK) {
+                LOG_ERROR("sl_bt_gatt_set_max_mtu() returned != 0 status=0x%04x", (unsigned int) sc);
+            }
 #endif
+          }
 
           sc = sl_bt_sm_configure(0x0F, sl_bt_sm_io_capability_displayyesno);
           if (sc != SL_STATUS_OK) {
@@ -424,31 +997,55 @@ void handle_ble_event(sl_bt_msg_t *evt) {
 
           // Initialising the flags
           bleDataPtr->connection_open = false;
-          bleDataPtr->indication_in_flight = false;
+          bleDataPtr->num_connections = 0;
           bleDataPtr->ok_to_send_htm_indications = false;
           bleDataPtr->bonded = false;
           bleDataPtr->button_indication = false;
+          bleDataPtr->batch_client_config = sl_bt_gatt_server_disable;
 
       break;
 
     case sl_bt_evt_connection_opened_id:
 
       // handle open event
-      bleDataPtr->connection_open = true;
-      bleDataPtr->connection_handle = evt->data.evt_connection_opened.connection;
-      bleDataPtr->queued_indications = 0;
-
 
 #if DEVICE_IS_BLE_SERVER
 
           //SERVER
-      sc = sl_bt_advertiser_stop((bleDataPtr->advertisingSetHandle));
+      conn = connection_add(evt->data.evt_connection_opened.connection,
+                            evt->data.evt_connection_opened.bonding);
+      if (conn == NULL) {
+          // the stack reserves BLE_MAX_CONNECTIONS too, so this should not happen
+          LOG_ERROR("No free connection slot for connection %d", (int) evt->data.evt_connection_opened.connection);
+          sc = sl_bt_connection_close(evt->data.evt_connection_opened.connection);
+          if (sc != SL_STATUS_OK) {
+              LOG_ERROR("sl_bt_connection_close() returned != 0 status=0x%04x", (unsigned int) sc);
+          }
+          break;
+      }
 
-      if (sc != SL_STATUS_OK) {
-                    LOG_ERROR("sl_bt_advertiser_stop() returned != 0 status=0x%04x", (unsigned int) sc);
+      bleDataPtr->connection_open = true;
+
+      // The stack stops advertising when a connection opens, keep taking
+      // centrals until the table is full
+      if (bleDataPtr->num_connections < BLE_MAX_CONNECTIONS) {
+          sc = sl_bt_advertiser_start((bleDataPtr->advertisingSetHandle),
+                                      sl_bt_advertiser_general_discoverable,
+                                      sl_bt_advertiser_connectable_scannable);
+
+          if (sc != SL_STATUS_OK) {
+              LOG_ERROR("sl_bt_advertiser_start() returned != 0 status=0x%04x", (unsigned int) sc);
+          }
       }
+      else {
+          sc = sl_bt_advertiser_stop((bleDataPtr->advertisingSetHandle));
 
-      sc = sl_bt_connection_set_parameters(bleDataPtr->connection_handle,
+          if (sc != SL_STATUS_OK) {
+              LOG_ERROR("sl_bt_advertiser_stop() returned != 0 status=0x%04x", (unsigned int) sc);
+          }
+      }
+
+      sc = sl_bt_connection_set_parameters(conn->connection_handle,
                                            0x3c,          //75/1.25
                                            0x3c,
                                            0x04,          //300ms
@@ -460,61 +1057,135 @@ void handle_ble_event(sl_bt_msg_t *evt) {
       }
 
 
+      displayPrintf(DISPLAY_ROW_CONNECTION, "Connected");
+
 #else
+      bleDataPtr->connection_pending = false;
+
+      server = server_add(evt->data.evt_connection_opened.connection,
+                          evt->data.evt_connection_opened.bonding,
+                          &evt->data.evt_connection_opened.address);
+      if (server == NULL) {
+          LOG_ERROR("No free server slot for connection %d", (int) evt->data.evt_connection_opened.connection);
+          sc = sl_bt_connection_close(evt->data.evt_connection_opened.connection);
+          if (sc != SL_STATUS_OK) {
+              LOG_ERROR("sl_bt_connection_close() returned != 0 status=0x%04x", (unsigned int) sc);
+          }
+          scan_for_servers();
+          break;
+      }
+
+      bleDataPtr->connection_open = true;
+      bleDataPtr->connection_handle = server->connection_handle;
+
       displayPrintf(DISPLAY_ROW_BTADDR2,  "%02X:%02X:%02X:%02X:%02X:%02X",
-                    server_addr.addr[0],
-                    server_addr.addr[1],
-                    server_addr.addr[2],
-                    server_addr.addr[3],
-                    server_addr.addr[4],
-                    server_addr.addr[5]);
+                    server->address.addr[0],
+                    server->address.addr[1],
+                    server->address.addr[2],
+                    server->address.addr[3],
+                    server->address.addr[4],
+                    server->address.addr[5]);
+
+      if (bleDataPtr->num_connections == server_allow_list.count) {
+          LOG_INFO("All %d servers connected in %u ms",
+                   (int) bleDataPtr->num_connections,
+                   (unsigned int) (letimerMilliseconds() - bleDataPtr->scan_start_ms));
+      }
 
-#endif
+      // look for the remaining Servers
+      scan_for_servers();
 
-      displayPrintf(DISPLAY_ROW_CONNECTION, "Connected");
+#endif
 
       break;
 
      case sl_bt_evt_connection_closed_id:
 
        // handle close event
-       bleDataPtr->connection_open = false;
-       bleDataPtr->bonded = false;
-       bleDataPtr->queued_indications = 0;
-       bleDataPtr->indication_in_flight = false;
 
-       displayPrintf(DISPLAY_ROW_9, "");
-       displayPrintf(DISPLAY_ROW_TEMPVALUE, "");
-       displayPrintf(DISPLAY_ROW_PASSKEY, "");
-       displayPrintf(DISPLAY_ROW_ACTION, "");
-       displayPrintf(DISPLAY_ROW_BTADDR2, "");
-       gpioLed1SetOff();
-       gpioLed0SetOff();
-
-       sc = sl_bt_sm_delete_bondings();
-       if (sc != SL_STATUS_OK) {
-           LOG_ERROR("sl_bt_sm_delete_bondings() returned != 0 status=0x%04x", (unsigned int) sc);
-       }
+       scheduler_log_stats();
 
 #if DEVICE_IS_BLE_SERVER
 
-       sc = sl_bt_advertiser_start((bleDataPtr->advertisingSetHandle),
-                                   sl_bt_advertiser_general_discoverable,       // Discoverable using general discovery procedure
-                                   sl_bt_advertiser_connectable_scannable);     // Undirected connectable scannable
+       conn = connection_find(evt->data.evt_connection_closed.connection);
+       if (conn != NULL) {
+           bool was_full = (bleDataPtr->num_connections == BLE_MAX_CONNECTIONS);
 
-       if (sc != SL_STATUS_OK) {
-           LOG_ERROR("sl_bt_advertiser_start() returned != 0 status=0x%04x", (unsigned int) sc);
+           if (conn->bonding != SL_BT_INVALID_BONDING_HANDLE) {
+               sc = sl_bt_sm_delete_bonding(conn->bonding);
+               if (sc != SL_STATUS_OK) {
+                   LOG_ERROR("sl_bt_sm_delete_bonding() returned != 0 status=0x%04x", (unsigned int) sc);
+               }
+           }
+
+           connection_remove(conn);
+           update_subscriptions();
+
+           // advertising was stopped when the table filled up
+           if (was_full) {
+               sc = sl_bt_advertiser_start((bleDataPtr->advertisingSetHandle),
+                                           sl_bt_advertiser_general_discoverable,       // Discoverable using general discovery procedure
+                                           sl_bt_advertiser_connectable_scannable);     // Undirected connectable scannable
+
+               if (sc != SL_STATUS_OK) {
+                   LOG_ERROR("sl_bt_advertiser_start() returned != 0 status=0x%04x", (unsigned int) sc);
+               }
+           }
        }
 
-       displayPrintf(DISPLAY_ROW_CONNECTION, "Advertising");
+       if (evt->data.evt_connection_closed.connection == bleDataPtr->connection_handle) {
+           bleDataPtr->bonded = false;
+           displayPrintf(DISPLAY_ROW_PASSKEY, "");
+           displayPrintf(DISPLAY_ROW_ACTION, "");
+       }
+
+       if (bleDataPtr->num_connections == 0) {
+           bleDataPtr->connection_open = false;
+           displayPrintf(DISPLAY_ROW_9, "");
+           displayPrintf(DISPLAY_ROW_TEMPVALUE, "");
+           displayPrintf(DISPLAY_ROW_8, "");
+           displayPrintf(DISPLAY_ROW_CONNECTION, "Advertising");
+       }
 
 #else
 
-       sc = sl_bt_scanner_start(1, sl_bt_scanner_discover_generic);
-       if (sc != SL_STATUS_OK) {
-           LOG_ERROR("sl_bt_scanner_set_timing() returned != 0 status=0x%04x", (unsigned int) sc);
+       server = ble_server_find(evt->data.evt_connection_closed.connection);
+       if (server != NULL) {
+           // restart the time-to-all-connected measurement
+           if (bleDataPtr->num_connections == server_allow_list.count) {
+               bleDataPtr->scan_start_ms = letimerMilliseconds();
+           }
+
+           if (server->bonding != SL_BT_INVALID_BONDING_HANDLE) {
+               sc = sl_bt_sm_delete_bonding(server->bonding);
+               if (sc != SL_STATUS_OK) {
+                   LOG_ERROR("sl_bt_sm_delete_bonding() returned != 0 status=0x%04x", (unsigned int) sc);
+               }
+           }
+
+           server_remove(server);
+           display_temperatures();
+       }
+       else {
+           // sl_bt_connection_open() failed before the connection opened
+           bleDataPtr->connection_pending = false;
        }
-       displayPrintf(DISPLAY_ROW_CONNECTION, "Scanning");
+
+       if (evt->data.evt_connection_closed.connection == bleDataPtr->connection_handle) {
+           bleDataPtr->bonded = false;
+           displayPrintf(DISPLAY_ROW_PASSKEY, "");
+           displayPrintf(DISPLAY_ROW_ACTION, "");
+       }
+
+       if (bleDataPtr->num_connections == 0) {
+           bleDataPtr->connection_open = false;
+           displayPrintf(DISPLAY_ROW_9, "");
+           displayPrintf(DISPLAY_ROW_BTADDR2, "");
+           gpioLed1SetOff();
+           gpioLed0SetOff();
+       }
+
+       scan_for_servers();
 
 #endif
 
@@ -522,10 +1193,35 @@ void handle_ble_event(sl_bt_msg_t *evt) {
 
      case sl_bt_evt_connection_parameters_id:
 
-//       LOG_INFO("Connection parameters: Connection=%d \n\r", (int)(evt->data.evt_connection_parameters.connection));
-//       LOG_INFO("Interval=%d \n\r", (int)(evt->data.evt_connection_parameters.interval*1.25));
-//       LOG_INFO("Latency=%d \n\r", (int)(evt->data.evt_connection_parameters.latency));
-//       LOG_INFO("Timeout=%d \n\r", (int)(evt->data.evt_connection_parameters.timeout*10));
+#if DEVICE_IS_BLE_SERVER
+       conn = connection_find(evt->data.evt_connection_parameters.connection);
+       if (conn != NULL) {
+           conn->connection_interval = evt->data.evt_connection_parameters.interval;
+           conn->tx_size = evt->data.evt_connection_parameters.txsize;
+       }
+#endif
+
+       LOG_INFO("Connection %d parameters: Interval=%d us Latency=%d Timeout=%d ms DLE tx=%d",
+                (int)(evt->data.evt_connection_parameters.connection),
+                (int)(evt->data.evt_connection_parameters.interval * 1250),
+                (int)(evt->data.evt_connection_parameters.latency),
+                (int)(evt->data.evt_connection_parameters.timeout * 10),
+                (int)(evt->data.evt_connection_parameters.txsize));
+
+       break;
+
+     case sl_bt_evt_gatt_mtu_exchanged_id:
+
+#if DEVICE_IS_BLE_SERVER
+       conn = connection_find(evt->data.evt_gatt_mtu_exchanged.connection);
+       if (conn != NULL) {
+           conn->mtu = evt->data.evt_gatt_mtu_exchanged.mtu;
+       }
+#endif
+
+       LOG_INFO("Connection %d ATT_MTU=%d",
+                (int) evt->data.evt_gatt_mtu_exchanged.connection,
+                (int) evt->data.evt_gatt_mtu_exchanged.mtu);
 
        break;
 
@@ -539,7 +1235,7 @@ void handle_ble_event(sl_bt_msg_t *evt) {
              {
                case PB0_pressed:
                  nextState = PB0_pressed;
-                 if(evt->data.evt_system_external_signal.extsignals == evt_button_pressed && (bleDataPtr->button_status == true))
+                 if((evt->data.evt_system_external_signal.extsignals & evt_button_pressed) && (bleDataPtr->button_status == true))
                    {
                      nextState = PB1_pressed;
                    }
@@ -547,7 +1243,7 @@ void handle_ble_event(sl_bt_msg_t *evt) {
 
                case PB1_pressed:
                  nextState = PB1_pressed;      //default
-                 if (evt->data.evt_system_external_signal.extsignals == evt_button_pressed && (bleDataPtr->pb1_button_status == true))
+                 if ((evt->data.evt_system_external_signal.extsignals & evt_button_pressed) && (bleDataPtr->pb1_button_status == true))
                    {
                      nextState = PB1_released;
                    }
@@ -555,7 +1251,7 @@ void handle_ble_event(sl_bt_msg_t *evt) {
 
                case PB1_released:
                  nextState = PB1_released;
-                 if (evt->data.evt_system_external_signal.extsignals == evt_button_released && (bleDataPtr->pb1_button_status == false))
+                 if ((evt->data.evt_system_external_signal.extsignals & evt_button_released) && (bleDataPtr->pb1_button_status == false))
                    {
                      nextState = PB0_released;
                    }
@@ -563,28 +1259,35 @@ void handle_ble_event(sl_bt_msg_t *evt) {
 
                case PB0_released:
                  nextState = PB0_released;
-                 if (evt->data.evt_system_external_signal.extsignals == evt_button_released && (bleDataPtr->button_status == false))
+                 if ((evt->data.evt_system_external_signal.extsignals & evt_button_released) && (bleDataPtr->button_status == false))
                    {
-                     if(bleDataPtr->button_indication_client)
-                       {
-                         //bleDataPtr->button_indication = false;
-                         sc = sl_bt_gatt_set_characteristic_notification(bleDataPtr->connection_handle,
-                                                                         bleDataPtr->button_characteristic,
-                                                                         sl_bt_gatt_disable);
-                         bleDataPtr->button_indication_client = false;
-                         if (sc != SL_STATUS_OK) {
-                                      LOG_ERROR("sl_bt_gatt_set_characteristic_notification() returned != 0 status=0x%04x", (unsigned int) sc);
-                                  }
-                       }
-                     else
+                     // toggle button indications on every connected Server
+                     for (int i = 0; i < BLE_MAX_CONNECTIONS; i++)
                        {
-                         sc = sl_bt_gatt_set_characteristic_notification(bleDataPtr->connection_handle,
-                                                                         bleDataPtr->button_characteristic,
-                                                                         sl_bt_gatt_indication);
-                         bleDataPtr->button_indication_client = true;
-                         if (sc != SL_STATUS_OK) {
-                                      LOG_ERROR("sl_bt_gatt_set_characteristic_notification() returned != 0 status=0x%04x", (unsigned int) sc);
-                                  }
+                         server = &servers[i];
+                         if (!server->in_use)
+                           continue;
+
+                         if(server->button_indication_client)
+                           {
+                             sc = sl_bt_gatt_set_characteristic_notification(server->connection_handle,
+                                                                             server->button_characteristic,
+                                                                             sl_bt_gatt_disable);
+                             server->button_indication_client = false;
+                             if (sc != SL_STATUS_OK) {
+                                          LOG_ERROR("sl_bt_gatt_set_characteristic_notification() returned != 0 status=0x%04x", (unsigned int) sc);
+                                      }
+                           }
+                         else
+                           {
+                             sc = sl_bt_gatt_set_characteristic_notification(server->connection_handle,
+                                                                             server->button_characteristic,
+                                                                             sl_bt_gatt_indication);
+                             server->button_indication_client = true;
+                             if (sc != SL_STATUS_OK) {
+                                          LOG_ERROR("sl_bt_gatt_set_characteristic_notification() returned != 0 status=0x%04x", (unsigned int) sc);
+                                      }
+                           }
                        }
                      nextState = PB0_pressed;
                    }
@@ -598,17 +1301,18 @@ void handle_ble_event(sl_bt_msg_t *evt) {
 
 #endif
 
-       if(evt->data.evt_system_external_signal.extsignals == evt_button_pressed)
+#if DEVICE_IS_BLE_SERVER
+       if((evt->data.evt_system_external_signal.extsignals & evt_button_pressed) ||
+          (evt->data.evt_system_external_signal.extsignals & evt_button_released))
          {
+           drain_button_events();
+         }
+#endif
 
-#if DEVICE_IS_BLE_SERVER
+       if(evt->data.evt_system_external_signal.extsignals & evt_button_pressed)
+         {
 
-           displayPrintf(DISPLAY_ROW_9, "Button pressed");
-           if(bleDataPtr->bonded)
-             {
-                 send_button_indication(0x01);
-             }
-#else
+#if !DEVICE_IS_BLE_SERVER
            if(bleDataPtr->pb1_button_status)
            {
                if(bleDataPtr->button_status)
@@ -617,10 +1321,16 @@ void handle_ble_event(sl_bt_msg_t *evt) {
                }
                else
                {
-                   sc = sl_bt_gatt_read_characteristic_value(bleDataPtr->connection_handle,
-                                                         bleDataPtr->button_characteristic);
-                   if (sc != SL_STATUS_OK) {
-                   LOG_ERROR("sl_bt_gatt_read_characteristic_value() returned != 0 status=0x%04x", (unsigned int) sc);
+                   for (int i = 0; i < BLE_MAX_CONNECTIONS; i++)
+                   {
+                       if (!servers[i].in_use)
+                         continue;
+
+                       sc = sl_bt_gatt_read_characteristic_value(servers[i].connection_handle,
+                                                                 servers[i].button_characteristic);
+                       if (sc != SL_STATUS_OK) {
+                       LOG_ERROR("sl_bt_gatt_read_characteristic_value() returned != 0 status=0x%04x", (unsigned int) sc);
+                       }
                    }
                }
            }
@@ -636,17 +1346,6 @@ void handle_ble_event(sl_bt_msg_t *evt) {
              }
          }
 
-#if DEVICE_IS_BLE_SERVER
-       else if(evt->data.evt_system_external_signal.extsignals == evt_button_released)
-    {
-           displayPrintf(DISPLAY_ROW_9, "Button released");
-
-           if(bleDataPtr->bonded){
-             send_button_indication(0x00);
-           }
-    }
-#endif
-
        break;
 
      case sl_bt_evt_system_soft_timer_id:
@@ -654,43 +1353,17 @@ void handle_ble_event(sl_bt_msg_t *evt) {
 
 #if DEVICE_IS_BLE_SERVER
 
-       bool success;
+       temperature_batch_check_age();
+       workq_post(&throughput_work);
 
-       if (!bleDataPtr->indication_in_flight && bleDataPtr->queued_indications)
+       for (int i = 0; i < BLE_MAX_CONNECTIONS; i++)
          {
-
-           success = read_queue(&(dequeued_element.buffer[0]),
-                                        &(dequeued_element.charHandle),
-                                        &(dequeued_element.bufferLength));
-//           LOG_INFO("Reading the values");
-//           LOG_INFO("buffer length=%d \n\r", (int)(dequeued_element.bufferLength));
-//           LOG_INFO("char handle=%d \n\r", (int)(dequeued_element.charHandle));
-//           LOG_INFO("Buffer value: %d %d %d %d %d \n\r",  dequeued_element.buffer[4],
-//               dequeued_element.buffer[3],
-//               dequeued_element.buffer[2],
-//               dequeued_element.buffer[1],
-//               dequeued_element.buffer[0]);
-
-
-           if (!success)
+           if (connections[i].in_use)
              {
-               sc = sl_bt_gatt_server_send_indication(bleDataPtr->connection_handle,
-                                               dequeued_element.charHandle,
-                                               dequeued_element.bufferLength,
-                                               &(dequeued_element.buffer[0]));
-
-               if (sc != SL_STATUS_OK)
-               {
-                   LOG_ERROR("sl_bt_gatt_send_indication() returned != 0 status=0x%04x", (unsigned int) sc);
-               }
-
-               else
-               {
-                   bleDataPtr->indication_in_flight = true;
-                   bleDataPtr->queued_indications--;
-               }
+               // The queue is drained from the confirmation event, this only
+               // retries entries the stack refused for lack of buffers
+               drain_indication_queue(&connections[i]);
              }
-
          }
 #endif
 
@@ -698,7 +1371,7 @@ void handle_ble_event(sl_bt_msg_t *evt) {
 
      case sl_bt_evt_sm_confirm_bonding_id:
 
-       sc = sl_bt_sm_bonding_confirm(bleDataPtr->connection_handle, 1);
+       sc = sl_bt_sm_bonding_confirm(evt->data.evt_sm_confirm_bonding.connection, 1);
        if (sc != SL_STATUS_OK) {
            LOG_ERROR("sl_bt_bonding_confirm() returned != 0 status=0x%04x", (unsigned int) sc);
        }
@@ -707,6 +1380,9 @@ void handle_ble_event(sl_bt_msg_t *evt) {
 
      case sl_bt_evt_sm_confirm_passkey_id:
 
+       // PB0 confirms the passkey of the connection that asked last
+       bleDataPtr->connection_handle = evt->data.evt_sm_confirm_passkey.connection;
+       bleDataPtr->bonded = false;
        bleDataPtr->passkey = evt->data.evt_sm_confirm_passkey.passkey;
 
        displayPrintf(DISPLAY_ROW_PASSKEY, "%d", bleDataPtr->passkey);
@@ -715,6 +1391,19 @@ void handle_ble_event(sl_bt_msg_t *evt) {
 
      case sl_bt_evt_sm_bonded_id:
 
+#if DEVICE_IS_BLE_SERVER
+       conn = connection_find(evt->data.evt_sm_bonded.connection);
+       if (conn != NULL) {
+           conn->bonded = true;
+           conn->bonding = evt->data.evt_sm_bonded.bonding;
+       }
+#else
+       server = ble_server_find(evt->data.evt_sm_bonded.connection);
+       if (server != NULL) {
+           server->bonding = evt->data.evt_sm_bonded.bonding;
+       }
+#endif
+
        displayPrintf(DISPLAY_ROW_CONNECTION, "Bonded");
        displayPrintf(DISPLAY_ROW_PASSKEY, "");
        displayPrintf(DISPLAY_ROW_ACTION, "");
@@ -728,7 +1417,7 @@ void handle_ble_event(sl_bt_msg_t *evt) {
        bleDataPtr->bonded = false;
 
        //close connection
-       sc = sl_bt_connection_close(bleDataPtr->connection_handle);
+       sc = sl_bt_connection_close(evt->data.evt_sm_bonding_failed.connection);
        if(sc != SL_STATUS_OK) {
            LOG_ERROR("sl_bt_connection_close() returned != 0 status=0x%04x\n\r", (unsigned int)sc);
        }
@@ -739,78 +1428,67 @@ void handle_ble_event(sl_bt_msg_t *evt) {
 
      case sl_bt_evt_gatt_server_characteristic_status_id:
 
-       // Checking for the correct characteristic
-       if (evt->data.evt_gatt_server_characteristic_status.characteristic == gattdb_temperature_measurement)
+       conn = connection_find(evt->data.evt_gatt_server_characteristic_status.connection);
+       if (conn == NULL)
          {
-           if (evt->data.evt_gatt_server_characteristic_status.status_flags == sl_bt_gatt_server_client_config)
-             {
-                 if (evt->data.evt_gatt_server_characteristic_status.client_config_flags == sl_bt_gatt_server_disable){
-                   bleDataPtr->ok_to_send_htm_indications = false;            // Notifications are disabled
-                   displayPrintf(DISPLAY_ROW_TEMPVALUE, " ");
-                   gpioLed0SetOff();
-                 }
-
-                 if (evt->data.evt_gatt_server_characteristic_status.client_config_flags == sl_bt_gatt_server_indication){
-                   bleDataPtr->ok_to_send_htm_indications = true;             // Client has enabled notifications
-                   gpioLed0SetOn();
-                 }
-             }
+           break;
+         }
 
-           if (evt->data.evt_gatt_server_characteristic_status.status_flags == sl_bt_gatt_server_confirmation)
+       if (evt->data.evt_gatt_server_characteristic_status.status_flags == sl_bt_gatt_server_client_config)
+         {
+           // Checking for the correct characteristic
+           if (evt->data.evt_gatt_server_characteristic_status.characteristic == gattdb_temperature_measurement)
              {
-               bleDataPtr->indication_in_flight = false;
+               conn->htm_client_config = (uint8_t) evt->data.evt_gatt_server_characteristic_status.client_config_flags;
              }
 
-         }
-
-
-       // Checking for the correct characteristic
-       if (evt->data.evt_gatt_server_characteristic_status.characteristic == gattdb_button_state)
-         {
-           if (evt->data.evt_gatt_server_characteristic_status.status_flags == sl_bt_gatt_server_client_config)
+           if (evt->data.evt_gatt_server_characteristic_status.characteristic == gattdb_button_state)
              {
-                 if (evt->data.evt_gatt_server_characteristic_status.client_config_flags == sl_bt_gatt_server_disable){
-                   bleDataPtr->button_indication = false;            // Notifications are disabled
-                   gpioLed1SetOff();
-                 }
-
-                 if (evt->data.evt_gatt_server_characteristic_status.client_config_flags == sl_bt_gatt_server_indication){
-                   bleDataPtr->button_indication = true;             // Client has enabled notifications
-                   gpioLed1SetOn();
-                 }
+               conn->button_client_config = (uint8_t) evt->data.evt_gatt_server_characteristic_status.client_config_flags;
              }
 
-           if (evt->data.evt_gatt_server_characteristic_status.status_flags == sl_bt_gatt_server_confirmation)
+           if (evt->data.evt_gatt_server_characteristic_status.characteristic == gattdb_temperature_batch)
              {
-               bleDataPtr->indication_in_flight = false;
+               conn->batch_client_config = (uint8_t) evt->data.evt_gatt_server_characteristic_status.client_config_flags;
              }
 
+           // LEDs and the scheduler follow whether any client is subscribed
+           update_subscriptions();
+         }
+
+       // One indication is in flight per connection, whatever its characteristic
+       if (evt->data.evt_gatt_server_characteristic_status.status_flags == sl_bt_gatt_server_confirmation)
+         {
+           conn->indication_in_flight = false;
+           drain_indication_queue(conn);
          }
 
        break;
 
      case sl_bt_evt_gatt_server_indication_timeout_id:
 
-       bleDataPtr->indication_in_flight = false;
+       conn = connection_find(evt->data.evt_gatt_server_indication_timeout.connection);
+       if (conn != NULL)
+         {
+           conn->indication_in_flight = false;
+           drain_indication_queue(conn);
+         }
        break;
 
 #else
 
      case sl_bt_evt_scanner_scan_report_id:
 
+       // connect to allow-listed Servers we are not connected to yet, one
+       // connection attempt at a time
        if ( (evt->data.evt_scanner_scan_report.packet_type == 0) &&
            (evt->data.evt_scanner_scan_report.address_type == 0) &&
-           (evt->data.evt_scanner_scan_report.address.addr[0] == server_addr.addr[0]) &&
-           (evt->data.evt_scanner_scan_report.address.addr[1] == server_addr.addr[1]) &&
-           (evt->data.evt_scanner_scan_report.address.addr[2] == server_addr.addr[2]) &&
-           (evt->data.evt_scanner_scan_report.address.addr[3] == server_addr.addr[3]) &&
-           (evt->data.evt_scanner_scan_report.address.addr[4] == server_addr.addr[4]) &&
-           (evt->data.evt_scanner_scan_report.address.addr[5] == server_addr.addr[5]) )
+           (bleDataPtr->connection_pending == false) &&
+           bdaddr_set_contains(&server_allow_list, &evt->data.evt_scanner_scan_report.address) &&
+           !server_is_connected(&evt->data.evt_scanner_scan_report.address) )
          {
-           sc = sl_bt_scanner_stop();
-           if (sc != SL_STATUS_OK) {
-               LOG_ERROR("sl_bt_scanner_stop() returned != 0 status=0x%04x", (unsigned int) sc);
-           }
+           bleDataPtr->connection_pending = true;
+           scan_for_servers();                  // stops the scanner
 
            sc = sl_bt_connection_open(evt->data.evt_scanner_scan_report.address,
                                       sl_bt_gap_public_address,
@@ -818,6 +1496,8 @@ void handle_ble_event(sl_bt_msg_t *evt) {
                                       NULL);
            if (sc != SL_STATUS_OK) {
                LOG_ERROR("sl_bt_connection_open() returned != 0 status=0x%04x", (unsigned int) sc);
+               bleDataPtr->connection_pending = false;
+               scan_for_servers();
            }
 
          }
@@ -828,7 +1508,7 @@ void handle_ble_event(sl_bt_msg_t *evt) {
 
        if(evt->data.evt_gatt_procedure_completed.result == 0x110F) {
 
-           sc = sl_bt_sm_increase_security(bleDataPtr->connection_handle);
+           sc = sl_bt_sm_increase_security(evt->data.evt_gatt_procedure_completed.connection);
            if (sc != SL_STATUS_OK) {
                LOG_ERROR("sl_bt_sm_increase_security() returned != 0 status=0x%04x", (unsigned int) sc);
            }
@@ -838,15 +1518,21 @@ void handle_ble_event(sl_bt_msg_t *evt) {
 
      case sl_bt_evt_gatt_service_id:
 
-    //   bleDataPtr->service_handle = evt->data.evt_gatt_service.service;
+       server = ble_server_find(evt->data.evt_gatt_service.connection);
+       if (server == NULL)
+         break;
 
-       if (memcmp(evt->data.evt_gatt_service.uuid.data, service_uuid, sizeof(service_uuid)) == 0)
+       if (uuid_matches(&evt->data.evt_gatt_service.uuid, service_uuid, sizeof(service_uuid)))
+         {
+           server->service_handle = evt->data.evt_gatt_service.service;
+         }
+       else if (uuid_matches(&evt->data.evt_gatt_service.uuid, button_service_uuid, sizeof(button_service_uuid)))
          {
-           bleDataPtr->service_handle = evt->data.evt_gatt_service.service;
+           server->button_service_handle = evt->data.evt_gatt_service.service;
          }
-       else if (memcmp(evt->data.evt_gatt_service.uuid.data, button_service_uuid, sizeof(button_service_uuid)) == 0)
+       else if (uuid_matches(&evt->data.evt_gatt_service.uuid, gatt_service_uuid, sizeof(gatt_service_uuid)))
          {
-           bleDataPtr->button_service_handle = evt->data.evt_gatt_service.service;
+           server->gatt_service_handle = evt->data.evt_gatt_service.service;
          }
 
        break;
@@ -854,15 +1540,17 @@ void handle_ble_event(sl_bt_msg_t *evt) {
 
      case sl_bt_evt_gatt_characteristic_id:
 
-//       bleDataPtr->characteristic = evt->data.evt_gatt_characteristic.characteristic;
+       server = ble_server_find(evt->data.evt_gatt_characteristic.connection);
+       if (server == NULL)
+         break;
 
-       if (memcmp(evt->data.evt_gatt_characteristic.uuid.data, characteristic_uuid, sizeof(characteristic_uuid)) == 0)
+       if (uuid_matches(&evt->data.evt_gatt_characteristic.uuid, characteristic_uuid, sizeof(characteristic_uuid)))
          {
-           bleDataPtr->characteristic = evt->data.evt_gatt_characteristic.characteristic;
+           server->characteristic = evt->data.evt_gatt_characteristic.characteristic;
          }
-       else if (memcmp(evt->data.evt_gatt_characteristic.uuid.data, button_characteristic_uuid, sizeof(button_characteristic_uuid)) == 0)
+       else if (uuid_matches(&evt->data.evt_gatt_characteristic.uuid, button_characteristic_uuid, sizeof(button_characteristic_uuid)))
          {
-           bleDataPtr->button_characteristic = evt->data.evt_gatt_characteristic.characteristic;
+           server->button_characteristic = evt->data.evt_gatt_characteristic.characteristic;
          }
        break;
 
@@ -871,22 +1559,50 @@ void handle_ble_event(sl_bt_msg_t *evt) {
 
        if(evt->data.evt_gatt_characteristic_value.att_opcode == sl_bt_gatt_handle_value_indication)
          {
-           sc = sl_bt_gatt_send_characteristic_confirmation(bleDataPtr->connection_handle);
+           sc = sl_bt_gatt_send_characteristic_confirmation(evt->data.evt_gatt_characteristic_value.connection);
            if (sc != SL_STATUS_OK)
              {
                LOG_ERROR("sl_bt_gatt_send_characteristic_confirmation() returned != 0 status=0x%04x", (unsigned int) sc);
              }
 
          }
-       if (evt->data.evt_gatt_characteristic_value.characteristic == bleDataPtr->characteristic)
+
+       server = ble_server_find(evt->data.evt_gatt_characteristic_value.connection);
+       if (server == NULL)
+         break;
+
+       // Database Hash read by discovery_state_machine(). Indications that
+       // arrive during the read still fall through to the handlers below.
+       if (server->reading_database_hash &&
+           evt->data.evt_gatt_characteristic_value.att_opcode != sl_bt_gatt_handle_value_indication &&
+           evt->data.evt_gatt_characteristic_value.characteristic != server->characteristic &&
+           evt->data.evt_gatt_characteristic_value.characteristic != server->button_characteristic)
+         {
+           if (evt->data.evt_gatt_characteristic_value.value.len == DATABASE_HASH_LEN)
+             {
+               server->hash_characteristic = evt->data.evt_gatt_characteristic_value.characteristic;
+               memcpy(server->database_hash, evt->data.evt_gatt_characteristic_value.value.data, DATABASE_HASH_LEN);
+               server->database_hash_valid = true;
+             }
+           break;
+         }
+
+       if (evt->data.evt_gatt_characteristic_value.characteristic == server->characteristic)
          {
-           //Receiving the temperature indications from the Server and displaying it on the Client’s LCD.
-        bleDataPtr->characteristic_value = &(evt->data.evt_gatt_characteristic_value.value.data[0]);
-        temperature_from_server = FLOAT_TO_INT32(bleDataPtr->characteristic_value);
-        displayPrintf(DISPLAY_ROW_TEMPVALUE, "Temp = %d",temperature_from_server);
+           //Receiving the temperature indications from the Server and showing the aggregate on the Client’s LCD.
+           if (!server->temperature_valid)
+             {
+               LOG_INFO("Connection %d: first temperature %u ms after open (%s discovery)",
+                        (int) server->connection_handle,
+                        (unsigned int) (letimerMilliseconds() - server->opened_ms),
+                        server->discovery_from_cache ? "cached" : "full");
+             }
+           server->temperature = FLOAT_TO_INT32(&(evt->data.evt_gatt_characteristic_value.value.data[0]));
+           server->temperature_valid = true;
+           display_temperatures();
          }
 
-       if (evt->data.evt_gatt_characteristic_value.characteristic == bleDataPtr->button_characteristic)
+       if (evt->data.evt_gatt_characteristic_value.characteristic == server->button_characteristic)
          {
            if(evt->data.evt_gatt_characteristic_value.value.data[1] == 1) {
                displayPrintf(DISPLAY_ROW_9, "Button Pressed");
@@ -899,7 +1615,7 @@ void handle_ble_event(sl_bt_msg_t *evt) {
        // for PB1 press
        if(evt->data.evt_gatt_characteristic_value.att_opcode == sl_bt_gatt_read_response)
          {
-           if (evt->data.evt_gatt_characteristic_value.characteristic == bleDataPtr->button_characteristic)
+           if (evt->data.evt_gatt_characteristic_value.characteristic == server->button_characteristic)
       {
            if(evt->data.evt_gatt_characteristic_value.value.data[0] == 1) {
                displayPrintf(DISPLAY_ROW_9, "Button Pressed");
@@ -23,21 +23,107 @@
 #include "src/ble_device_type.h"
 #include "sl_bluetooth.h"
 #include "sl_bt_api.h"
+#include "src/ring.h"
 
 
 // Helper Macros
 #define UINT8_TO_BITSTREAM(p, n) { *(p)++ = (uint8_t)(n); } // use this for the flags byte, which you set = 0
 #define UINT32_TO_BITSTREAM(p, n) { *(p)++ = (uint8_t)(n); *(p)++ = (uint8_t)((n) >> 8); \
     *(p)++ = (uint8_t)((n) >> 16); *(p)++ = (uint8_t)((n) >> 24); }
-#define UINT32_TO_FLOAT(m, e) (((uint32_t)(m) & 0x00FFFFFFU) | (uint32_t)((int32_t)(e) << 24))
+#define UINT32_TO_FLOAT(m, e) (((uint32_t)(m) & 0x00FFFFFFU) | ((uint32_t)(int32_t)(e) << 24))
 
 
+#define ATT_DEFAULT_MTU       (23)
+#define ATT_MAX_MTU           (247)     // requested at boot, 244 byte payload with 251 byte LE data length
+#define ATT_HEADER_LEN        (3)
+
+// Centrals the server serves, or Servers the client connects to, at once.
+// The stack reserves the same number.
+#define BLE_MAX_CONNECTIONS   (SL_BT_CONFIG_MAX_CONNECTIONS)
+
+// Largest indication/notification payload we queue (ATT_MTU 247 - 3 byte header)
+#define INDICATION_MAX_LEN    (244)
+
+
+// Batched temperature characteristic (gattdb_temperature_batch).
+// Packet layout, little endian:
+//   [0]        number of samples N
+//   [1..4]     uint32 timestamp of the first sample in ms (letimerMilliseconds())
+//   N times:   uint16 offset in ms from the first sample,
+//              uint32 IEEE-11073 FLOAT temperature in degrees C
+// A batch is sent when it holds TEMP_BATCH_SAMPLES_PER_PACKET samples, when
+// the next sample would not fit in the ATT payload, or when the oldest
+// sample is TEMP_BATCH_MAX_AGE_MS old.
+#define TEMP_BATCH_SAMPLES_PER_PACKET   (10)
+#define TEMP_BATCH_MAX_AGE_MS           (30000)
+#define TEMP_BATCH_HEADER_LEN           (5)
+#define TEMP_BATCH_SAMPLE_LEN           (6)
+
 typedef struct {
-  uint8_t        buffer[5];     // The actual data buffer for the indication.
+  uint8_t        buffer[INDICATION_MAX_LEN];     // The actual data buffer for the indication.
   uint16_t       charHandle;    // Char handle from gatt_db.h
   size_t        bufferLength;    // Length of buffer in bytes to send
 } queue_struct_t;
 
+// Server side state of one connected client, see connection_find() in ble.c
+typedef struct {
+  ring_t    queue;                      // indications/notifications waiting to be sent
+  uint32_t  payload_bytes_sent;         // notification/indication payload since the last report
+  uint32_t  payload_report_start_ms;    // letimerMilliseconds() at the start of the report window
+  uint16_t  mtu;                        // negotiated ATT_MTU, ATT_DEFAULT_MTU until exchanged
+  uint16_t  connection_interval;        // in 1.25 ms units, from sl_bt_evt_connection_parameters
+  uint16_t  tx_size;                    // LE data length, max link layer payload per air packet
+  uint8_t   connection_handle;
+  uint8_t   bonding;                    // bonding handle, SL_BT_INVALID_BONDING_HANDLE if none
+  uint8_t   htm_client_config;          // temperature CCCD, sl_bt_gatt_server_client_configuration_t
+  uint8_t   button_client_config;       // button state CCCD, sl_bt_gatt_server_client_configuration_t
+  uint8_t   batch_client_config;        // temperature batch CCCD, sl_bt_gatt_server_client_configuration_t
+  bool      in_use;
+  bool      bonded;
+  bool      indication_in_flight;       // true when an indication is in-flight
+} ble_connection_t;
+
+// Length of the Database Hash characteristic (UUID 0x2B2A) value
+#define DATABASE_HASH_LEN     (16)
+
+// Servers whose discovered handles the client remembers
+#define DISCOVERY_CACHE_SIZE  (8)
+
+// Client side state of one connected Server, see ble_server_find()
+typedef struct {
+  bd_addr   address;
+  int32_t   temperature;                // last temperature indicated by this Server
+  uint32_t  opened_ms;                  // letimerMilliseconds() when the connection opened
+  uint32_t  service_handle;
+  uint32_t  button_service_handle;
+  uint32_t  gatt_service_handle;        // Generic Attribute service, holds the Database Hash
+  uint16_t  characteristic;             // temperature measurement characteristic handle
+  uint16_t  button_characteristic;      // button state characteristic handle
+  uint16_t  hash_characteristic;        // Database Hash characteristic handle
+  uint8_t   database_hash[DATABASE_HASH_LEN];
+  uint8_t   connection_handle;
+  uint8_t   bonding;                    // bonding handle, SL_BT_INVALID_BONDING_HANDLE if none
+  uint8_t   discovery_state;            // owned by discovery_state_machine()
+  bool      in_use;
+  bool      temperature_valid;          // true once temperature has been received
+  bool      button_indication_client;   // true when button indications are enabled
+  bool      reading_database_hash;      // set while discovery reads the Database Hash
+  bool      database_hash_valid;        // true once database_hash has been read
+  bool      discovery_from_cache;       // true when the handles came from the discovery cache
+} ble_server_t;
+
+// Handles discovered on a Server, reused on reconnect while its Database
+// Hash is unchanged, see ble_discovery_cache_find()
+typedef struct {
+  bd_addr   address;
+  uint32_t  last_used;                  // for least recently used replacement
+  uint16_t  characteristic;
+  uint16_t  button_characteristic;
+  uint16_t  hash_characteristic;
+  uint8_t   database_hash[DATABASE_HASH_LEN];
+  bool      valid;
+} ble_discovery_cache_t;
+
 typedef struct {
       // values that are common to servers and clients
       bd_addr myAddress;
@@ -45,43 +131,49 @@ typedef struct {
 
       // values unique for server
       uint8_t advertisingSetHandle;
-      uint8_t connection_handle;
+      uint8_t connection_handle;        // client: last opened, both: connection showing its passkey
+      uint8_t num_connections;          // entries in use in the connection table
       bool connection_open;             // true when in an open connection
-      bool ok_to_send_htm_indications;  // true when client enabled indications
-      bool indication_in_flight;        // true when an indication is in-flight
+      bool scanning;                    // client: scanner is running
+      bool connection_pending;          // client: sl_bt_connection_open() has not completed
+      uint32_t scan_start_ms;           // client: when the first Server was looked for
+      // summaries of every connection's CCCDs, see update_subscriptions()
+      bool ok_to_send_htm_indications;  // true when any client enabled temperature updates
+      uint8_t batch_client_config;      // OR of every temperature batch CCCD
       uint32_t passkey;
+      int32_t temperature_mc;           // server: milli-degrees C from the last measurement
+      int32_t humidity_mrh;             // server: milli-%RH from the last measurement, SI7021_MEASURE_HUMIDITY
 
 
       //A8
-      bool button_indication;
+      bool button_indication;           // server: true when any client enabled button updates
       bool htm_indication;
       bool button_status;
       bool pb1_button_status;
-      bool bonded;
-      uint8_t queued_indications;
-      bool button_indication_client;
-
-      //client
-      uint32_t service_handle;
-      uint16_t characteristic;          //characteristic handle ie. address
-      uint8_t * characteristic_value;
-
-      uint32_t button_service_handle;
-      uint16_t button_characteristic;          //characteristic handle ie. address
-      uint8_t * button_characteristic_value;
+      bool bonded;                      // connection_handle is bonded
 
 } ble_data_struct_t;
 
 
 /**
 * @brief Function to pass the temperature read from Si7021 as a GATT attribute
-*         to the client.
+*         to the client. The temperature, and the humidity in humidity mode,
+*         are also kept in ble_data_struct_t.
 *
 * @param void
 * @return void
 */
 void send_temperature();
 
+/**
+* @brief Function to queue a button edge from the GPIO ISR. The edge is
+*        replayed from the BT event loop on the next button external signal.
+*
+* @param button_value  1 when pressed, 0 when released
+* @return void
+*/
+void ble_button_event_from_isr(uint8_t button_value);
+
 /**
 * @brief Function that returns a pointer to the BLE private data so it can be
 *         used in other .c files as well.
@@ -91,6 +183,31 @@ void send_temperature();
 */
 ble_data_struct_t* getBleDataPtr(void);
 
+/**
+* @brief Function that returns the Client's state for a connected Server
+*
+* @param connection_handle  connection handle from a stack event
+* @return ble_server_t*     NULL if no Server is connected on that handle
+*/
+ble_server_t* ble_server_find(uint8_t connection_handle);
+
+/**
+* @brief Function to look up the handles cached for a Server
+*
+* @param address                  Server address
+* @return ble_discovery_cache_t*  NULL if the Server has not been discovered
+*/
+ble_discovery_cache_t* ble_discovery_cache_find(const bd_addr *address);
+
+/**
+* @brief Function to remember a Server's discovered handles and Database Hash,
+*        replacing its old entry or the least recently used one
+*
+* @param server  Server whose discovery just completed
+* @return void
+*/
+void ble_discovery_cache_store(const ble_server_t *server);
+
 /**
 * @brief Function to handle BLE events.
 *
@@ -31,8 +31,11 @@
  * Students:
  * Set to 1 to configure this build as a BLE server.
  * Set to 0 to configure as a BLE client
+ * The host tests build both roles with -DDEVICE_IS_BLE_SERVER=1 or 0.
  */
+#ifndef DEVICE_IS_BLE_SERVER
 #define DEVICE_IS_BLE_SERVER 1
+#endif
 
 
 // Students:
@@ -44,6 +47,11 @@
 // This also can work:
 //#define SERVER_BT_ADDRESS (bd_addr) { .addr = { 0x85, 0x61, 0x17, 0x57, 0x0b, 0x00 } }
 
+// Every Server the Client connects to, at most BLE_MAX_CONNECTIONS of them.
+// Add one bd_addr initialiser per Gecko, e.g.
+//   #define SERVER_BT_ADDRESS_LIST { SERVER_BT_ADDRESS, {{ 0x85, 0x61, 0x17, 0x57, 0x0b, 0x00 }} }
+#define SERVER_BT_ADDRESS_LIST { SERVER_BT_ADDRESS }
+
 
 #if DEVICE_IS_BLE_SERVER
 
@@ -0,0 +1,86 @@
+/* @file      fsm.c
+ * @version   1.0
+ * @brief     Table driven state machine engine
+ *
+ * @author    Anuhya Kuraparthy, anuhya.kuraparthy@colorado.edu
+ * @date      Nov 03, 2023
+ *
+ * @institution University of Colorado Boulder (UCB)
+ * @course      ECEN 5823: IoT Embedded Firmware
+ * @instructor  David Sluiter
+ *
+ * @assignment Assignment 9 - BLE Client with Security
+ * @due        Nov 03
+ *
+ * @resources  -
+ */
+
+#include "em_device.h"          // for DWT and CoreDebug
+#include "src/fsm.h"
+
+#define INCLUDE_LOG_DEBUG 1
+#include "src/log.h"
+
+
+void fsm_init(void)
+{
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CYCCNT = 0;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+} // fsm_init()
+
+
+uint8_t fsm_dispatch(const fsm_t *fsm, uint8_t state, uint8_t event, void *ctx, sl_bt_msg_t *evt)
+{
+  uint32_t                index;
+  const fsm_transition_t *transition;
+  fsm_stats_t            *stats;
+  uint32_t                start;
+  uint32_t                cycles;
+  uint8_t                 next_state;
+
+  if ((state >= fsm->num_states) || (event >= fsm->num_events)) {
+      return state;
+  }
+
+  index = ((uint32_t) state * fsm->num_events) + event;
+  transition = &fsm->table[index];
+
+  if (transition->action == NULL) {
+      return state;
+  }
+
+  start = DWT->CYCCNT;
+  next_state = transition->action(ctx, evt, transition->next_state);
+  cycles = DWT->CYCCNT - start;
+
+  stats = &fsm->stats[index];
+  stats->count++;
+  stats->total_cycles += cycles;
+  if (cycles > stats->max_cycles) {
+      stats->max_cycles = cycles;
+  }
+
+  return next_state;
+} // fsm_dispatch()
+
+
+void fsm_log_stats(const fsm_t *fsm)
+{
+  const fsm_stats_t *stats;
+
+  for (uint32_t i = 0; i < (uint32_t) fsm->num_states * fsm->num_events; i++) {
+      stats = &fsm->stats[i];
+      if (stats->count == 0) {
+          continue;
+      }
+
+      LOG_INFO("%s: state %u event %u ran %u times, mean %u max %u cycles",
+               fsm->name,
+               (unsigned int) (i / fsm->num_events),
+               (unsigned int) (i % fsm->num_events),
+               (unsigned int) stats->count,
+               (unsigned int) (stats->total_cycles / stats->count),
+               (unsigned int) stats->max_cycles);
+  }
+} // fsm_log_stats()
@@ -0,0 +1,101 @@
+/* @file      fsm.h
+ * @version   1.0
+ * @brief     Application interface provided for fsm.c
+ *
+ * @author    Anuhya Kuraparthy, anuhya.kuraparthy@colorado.edu
+ * @date      Nov 03, 2023
+ *
+ * @institution University of Colorado Boulder (UCB)
+ * @course      ECEN 5823: IoT Embedded Firmware
+ * @instructor  David Sluiter
+ *
+ * @assignment Assignment 9 - BLE Client with Security
+ * @due        Nov 03
+ *
+ * @resources  -
+ */
+
+#ifndef SRC_FSM_H_
+#define SRC_FSM_H_
+
+#include <stdint.h>
+
+#include "sl_bluetooth.h"
+
+
+/*
+ * Table driven state machines.
+ *
+ * A machine is a num_states x num_events array of transitions, indexed
+ * directly by (state, event), so dispatch costs the same whatever the
+ * number of states. Tables are written as a list of
+ *   X(state, event, action, next_state)
+ * rows and expanded with FSM_TRANSITION(); (state, event) pairs that are not
+ * listed are ignored.
+ */
+
+/*
+ * Transition action. next_state is the state from the table; the action
+ * returns the state to move to, normally next_state, so guarded branches
+ * can pick a different one.
+ */
+typedef uint8_t (*fsm_action_t)(void *ctx, sl_bt_msg_t *evt, uint8_t next_state);
+
+typedef struct {
+  fsm_action_t  action;         // NULL: the event is ignored in this state
+  uint8_t       next_state;
+} fsm_transition_t;
+
+// Per transition timing, in CPU cycles
+typedef struct {
+  uint32_t  count;
+  uint32_t  total_cycles;
+  uint32_t  max_cycles;
+} fsm_stats_t;
+
+typedef struct {
+  const char              *name;
+  const fsm_transition_t  *table;       // num_states * num_events, row per state
+  fsm_stats_t             *stats;       // same shape as table
+  uint8_t                  num_states;
+  uint8_t                  num_events;
+} fsm_t;
+
+// Designated initialiser for one table row, see the comment above
+#define FSM_TRANSITION(num_events, state, event, action, next_state) \
+  [((state) * (num_events)) + (event)] = { (action), (next_state) },
+
+
+/**
+* @brief Function to start the cycle counter used for the transition timing
+*
+*
+* @param void
+* @return void
+*/
+void fsm_init(void);
+
+/**
+* @brief Function to run the transition for (state, event)
+*
+*
+* @param fsm    machine to run
+* @param state  current state
+* @param event  event index, < fsm->num_events
+* @param ctx    passed to the action
+* @param evt    BT event, passed to the action
+* @return uint8_t  the new state, state itself when the event is ignored
+*/
+uint8_t fsm_dispatch(const fsm_t *fsm, uint8_t state, uint8_t event, void *ctx, sl_bt_msg_t *evt);
+
+/**
+* @brief Function to log the count, mean and max cycles of every transition
+*        that has run
+*
+*
+* @param fsm  machine to report
+* @return void
+*/
+void fsm_log_stats(const fsm_t *fsm);
+
+#endif /* SRC_FSM_H_ */
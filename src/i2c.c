@@ -17,10 +17,13 @@
 
 #include "em_i2c.h"
 #include "em_gpio.h"
+#include "em_core.h"
 #include "sl_i2cspm.h"
+#include "sl_power_manager.h"
 #include "app.h"
 #include "src/gpio.h"
 #include "src/timers.h"
+#include "src/scheduler.h"
 
 #define INCLUDE_LOG_DEBUG 1
 #include "src/log.h"
@@ -30,13 +33,99 @@
 
 #define SI7021_DEVICE_ADDR 0x40
 
+#define SI7021_CMD_MEASURE_RH       (0xF5)    // Measure RH, No Hold Master Mode
+#define SI7021_CMD_MEASURE_T        (0xF3)    // Measure Temperature, No Hold Master Mode
+#define SI7021_CMD_READ_T_FROM_RH   (0xE0)    // Temperature taken by the last RH measurement
+#define SI7021_CMD_WRITE_USER_REG   (0xE6)
+
+// User register 1 after reset, the resolution bits are replaced
+#define SI7021_USER_REG_RESET       (0x3A)
+#define SI7021_USER_REG_RES_MASK    (0x81)
+
 
 /* Global variables */
-I2C_TransferSeq_TypeDef transferSequence;
 uint8_t cmd_data;
 uint8_t read_data[2];
 uint16_t temp_value;
 
+static volatile bool si7021_configured = false;
+static uint8_t  si7021_config_cmd[2] = {
+  SI7021_CMD_WRITE_USER_REG,
+  (SI7021_USER_REG_RESET & ~SI7021_USER_REG_RES_MASK) | SI7021_RESOLUTION
+};
+
+#if SI7021_MEASURE_HUMIDITY
+static uint8_t  rh_data[2];
+static volatile bool rh_read_ok = false;
+static uint8_t  read_t_cmd = SI7021_CMD_READ_T_FROM_RH;
+#endif
+
+// Transaction queue, the head is the one on the bus
+static i2c_transaction_t *i2c_head = NULL;
+static i2c_transaction_t *i2c_tail = NULL;
+static bool               i2c_busy = false;
+
+static void si7021_done(I2C_TransferReturn_TypeDef status, void *arg);
+static void si7021_config_done(I2C_TransferReturn_TypeDef status, void *arg);
+#if SI7021_MEASURE_HUMIDITY
+static void si7021_read_rh_done(I2C_TransferReturn_TypeDef status, void *arg);
+#endif
+
+// the measure command queued behind it reports to the state machine
+static i2c_transaction_t si7021_config = {
+  .seq = {
+    .addr  = SI7021_DEVICE_ADDR << 1,
+    .flags = I2C_FLAG_WRITE,
+    .buf   = { { &si7021_config_cmd[0], sizeof(si7021_config_cmd) } },
+  },
+  .callback = si7021_config_done,
+};
+
+static i2c_transaction_t si7021_write = {
+  .seq = {
+    .addr  = SI7021_DEVICE_ADDR << 1,             // shift device address left
+    .flags = I2C_FLAG_WRITE,                      // Indicate plain write sequence: S+ADDR(W)+DATA0+P.
+    .buf   = { { &cmd_data, sizeof(cmd_data) } },
+  },
+  .callback = si7021_done,
+};
+
+#if SI7021_MEASURE_HUMIDITY
+
+// the temperature read queued behind it reports to the state machine
+static i2c_transaction_t si7021_read_rh = {
+  .seq = {
+    .addr  = SI7021_DEVICE_ADDR << 1,
+    .flags = I2C_FLAG_READ,
+    .buf   = { { &rh_data[0], sizeof(rh_data) } },
+  },
+  .callback = si7021_read_rh_done,
+};
+
+// S+ADDR(W)+0xE0+Sr+ADDR(R)+DATA0+DATA1+P, no conversion wait needed
+static i2c_transaction_t si7021_read = {
+  .seq = {
+    .addr  = SI7021_DEVICE_ADDR << 1,
+    .flags = I2C_FLAG_WRITE_READ,
+    .buf   = { { &read_t_cmd, sizeof(read_t_cmd) },
+               { &read_data[0], sizeof(read_data) } },
+  },
+  .callback = si7021_done,
+};
+
+#else
+
+static i2c_transaction_t si7021_read = {
+  .seq = {
+    .addr  = SI7021_DEVICE_ADDR << 1,             // shift device address left
+    .flags = I2C_FLAG_READ,                       // Indicate plain read sequence: S+ADDR(R)+DATA0+P.
+    .buf   = { { &read_data[0], sizeof(read_data) } },
+  },
+  .callback = si7021_done,
+};
+
+#endif
+
 
 void initI2C(void)
 {
@@ -58,57 +147,204 @@ void initI2C(void)
 }
 
 
-void i2c_write()
+// put the head of the queue on the bus, call with interrupts disabled
+static void i2c_start(void)
 {
-
   I2C_TransferReturn_TypeDef transferStatus;
 
-  initI2C();
+  transferStatus = I2C_TransferInit (I2C0, &i2c_head->seq);    // Prepare and start an I2C transfer (single master mode only)
 
-  cmd_data = 0xF3;                  /* Measure Temperature, No Hold Master Mode */
+  if (transferStatus < 0) {
+      LOG_ERROR("I2C_TransferInit() error = %d", transferStatus);
+      i2c_transfer_done(transferStatus);
+  }
+}
 
-  transferSequence.addr = SI7021_DEVICE_ADDR << 1;      // shift device address left
-  transferSequence.flags = I2C_FLAG_WRITE;              // Indicate plain write sequence: S+ADDR(W)+DATA0+P.
-  transferSequence.buf[0].data = &cmd_data;             // pointer to data
-  transferSequence.buf[0].len = sizeof(cmd_data);
 
-  NVIC_EnableIRQ(I2C0_IRQn);              // Enabling the interrupt in NVIC
+bool i2c_submit(i2c_transaction_t *transaction)
+{
+  bool queued = false;
+
+  CORE_DECLARE_IRQ_STATE;
+  CORE_ENTER_CRITICAL();
+
+  if (transaction->queued) {
+      queued = true;
+  }
+  else {
+      transaction->queued = true;
+      transaction->next = NULL;
+
+      if (i2c_tail == NULL) {
+          i2c_head = transaction;
+      }
+      else {
+          i2c_tail->next = transaction;
+      }
+      i2c_tail = transaction;
+
+      if (!i2c_busy) {
+          i2c_busy = true;
+          sl_power_manager_add_em_requirement(SL_POWER_MANAGER_EM1);    // Power requirement for I2C
+          NVIC_ClearPendingIRQ(I2C0_IRQn);
+          NVIC_EnableIRQ(I2C0_IRQn);
+          i2c_start();
+      }
+  }
+
+  CORE_EXIT_CRITICAL();
+
+  return queued;
+} // i2c_submit()
+
+
+void i2c_transfer_done(I2C_TransferReturn_TypeDef status)
+{
+  i2c_transaction_t *transaction;
+
+  CORE_DECLARE_IRQ_STATE;
+  CORE_ENTER_CRITICAL();
+
+  transaction = i2c_head;
+  if (transaction != NULL) {
+      i2c_head = transaction->next;
+      if (i2c_head == NULL) {
+          i2c_tail = NULL;
+      }
+      transaction->queued = false;
+
+      // i2c_busy is still set, a submit from the callback only queues
+      if (transaction->callback != NULL) {
+          transaction->callback(status, transaction->arg);
+      }
+  }
+
+  if (i2c_head != NULL) {
+      i2c_start();
+  }
+  else if (i2c_busy) {
+      i2c_busy = false;
+      NVIC_DisableIRQ(I2C0_IRQn);
+      sl_power_manager_remove_em_requirement(SL_POWER_MANAGER_EM1);
+  }
+
+  CORE_EXIT_CRITICAL();
+} // i2c_transfer_done()
+
+
+// A failed resolution write is retried with the next measurement
+static void si7021_config_done(I2C_TransferReturn_TypeDef status, void *arg)
+{
+  (void) arg;
 
-  transferStatus = I2C_TransferInit (I2C0, &transferSequence);    // Prepare and start an I2C transfer (single master mode only)
+  if (status != i2cTransferDone) {
+      si7021_configured = false;
+  }
+}
 
-  if (transferStatus < 0)
-      LOG_ERROR("I2C_TransferInit() Write error = %d", transferStatus);
 
+#if SI7021_MEASURE_HUMIDITY
+// read_humidity_from_si7021() checks this before using rh_data
+static void si7021_read_rh_done(I2C_TransferReturn_TypeDef status, void *arg)
+{
+  (void) arg;
 
+  rh_read_ok = (status == i2cTransferDone);
 }
+#endif
 
-void i2c_read()
+
+// Si7021 transfers report completion to the temperature state machine
+static void si7021_done(I2C_TransferReturn_TypeDef status, void *arg)
 {
-  I2C_TransferReturn_TypeDef transferStatus;
+  (void) arg;
 
-  initI2C();
+  if (status == i2cTransferDone) {
+      schedulerSetEventI2CTransfer();                // setting I2C transaction event
+  }
+}
 
-  transferSequence.addr = SI7021_DEVICE_ADDR << 1;          // shift device address left
-  transferSequence.flags = I2C_FLAG_READ;                   // Indicate plain read sequence: S+ADDR(R)+DATA0+P.
-  transferSequence.buf[0].data = &read_data[0];             // pointer to data to write into
-  transferSequence.buf[0].len = sizeof(read_data);
 
-  NVIC_EnableIRQ(I2C0_IRQn);
+void i2c_write()
+{
+#if SI7021_MEASURE_HUMIDITY
+  cmd_data = SI7021_CMD_MEASURE_RH;
+#else
+  cmd_data = SI7021_CMD_MEASURE_T;
+#endif
+
+  // the resolution survives until the Si7021 loses power, set it once,
+  // si7021_config_done() clears the flag again if the write fails
+  if (!si7021_configured) {
+      si7021_configured = !i2c_submit(&si7021_config);
+  }
+
+  if (i2c_submit(&si7021_write)) {
+      LOG_ERROR("i2c_write() previous write still queued");
+  }
+}
+
+void i2c_read()
+{
+#if SI7021_MEASURE_HUMIDITY
+  rh_read_ok = false;
+  if (i2c_submit(&si7021_read_rh)) {
+      LOG_ERROR("i2c_read() previous humidity read still queued");
+  }
+#endif
+
+  if (i2c_submit(&si7021_read)) {
+      LOG_ERROR("i2c_read() previous read still queued");
+  }
+}
 
-  transferStatus = I2C_TransferInit (I2C0, &transferSequence);    // Prepare and start an I2C transfer (single master mode only).
 
-  if (transferStatus < 0)
-      LOG_ERROR("I2C_TransferInit() Read error = %d", transferStatus);
+// 1000 * 175.72 / 65536 = 21965 / 8192. The offset is taken off before
+// rounding so halves round away from zero below 0 C as well, like
+// lround(); 21965 * 0xFFFF still fits in an int32_t.
+#define SI7021_T_MUL        (21965)
+#define SI7021_T_OFFSET_MC  (46850)
 
-}
+// 1000 * 125 / 65536 = 15625 / 8192
+#define SI7021_RH_MUL       (15625)
+#define SI7021_RH_OFFSET    (6000)
 
+#define SI7021_SHIFT        (13)
+#define SI7021_ROUND        (1 << (SI7021_SHIFT - 1))
 
-float read_temp_from_si7021()
+
+int32_t read_temp_from_si7021()
 {
-    float temperature;
+    int32_t n;
+
     temp_value = (read_data[0] << 8) + read_data[1];
-    temperature = (((175.72*temp_value)/65536) - 46.85);
 
-    return temperature;
+    // milli-degrees C scaled by 2^SI7021_SHIFT
+    n = (SI7021_T_MUL * (int32_t) temp_value) - (SI7021_T_OFFSET_MC << SI7021_SHIFT);
+
+    return (n >= 0) ? ((n + SI7021_ROUND) >> SI7021_SHIFT) :
+                      -((-n + SI7021_ROUND) >> SI7021_SHIFT);
 }
 
+
+#if SI7021_MEASURE_HUMIDITY
+int32_t read_humidity_from_si7021()
+{
+    int32_t humidity;
+    uint16_t rh_value = (rh_data[0] << 8) + rh_data[1];
+
+    if (!rh_read_ok)
+      return SI7021_HUMIDITY_INVALID;
+
+    humidity = (int32_t) (((SI7021_RH_MUL * (uint32_t) rh_value) + SI7021_ROUND) >> SI7021_SHIFT) -
+               SI7021_RH_OFFSET;
+
+    // the datasheet formula can run slightly outside 0..100 %
+    if (humidity < 0)
+      humidity = 0;
+    else if (humidity > 100000)
+      humidity = 100000;
+
+    return humidity;
+}
+#endif
@@ -18,13 +18,111 @@
 #ifndef SRC_I2C_H_
 #define SRC_I2C_H_
 
+#include <stdbool.h>
+
+#include "em_i2c.h"
+
+
+/*
+ * Queued I2C transactions.
+ *
+ * Callers own statically allocated transactions and submit them; they run
+ * one after another on I2C0, each driven by I2C0_IRQHandler(). EM1 is
+ * held and the I2C0 IRQ enabled only while the queue is busy. The
+ * callback runs in the I2C0 interrupt and may submit again.
+ */
+// Si7021 measurement resolution, RES1:RES0 of user register 1
+#define SI7021_RES_RH12_T14       (0x00)
+#define SI7021_RES_RH8_T12        (0x01)
+#define SI7021_RES_RH10_T13       (0x80)
+#define SI7021_RES_RH11_T11       (0x81)
+
+// 1: measure humidity, then read the temperature taken with it (0xE0)
+// 0: measure temperature only (0xF3)
+#define SI7021_MEASURE_HUMIDITY   (1)
+
+// Lower resolutions convert faster
+#define SI7021_RESOLUTION         (SI7021_RES_RH12_T14)
+
+// Maximum conversion times in us for SI7021_RESOLUTION, from the datasheet
+#if   (SI7021_RESOLUTION == SI7021_RES_RH12_T14)
+#define SI7021_RH_CONVERSION_US   (12000)
+#define SI7021_T_CONVERSION_US    (10800)
+#elif (SI7021_RESOLUTION == SI7021_RES_RH8_T12)
+#define SI7021_RH_CONVERSION_US   (3100)
+#define SI7021_T_CONVERSION_US    (3800)
+#elif (SI7021_RESOLUTION == SI7021_RES_RH10_T13)
+#define SI7021_RH_CONVERSION_US   (4500)
+#define SI7021_T_CONVERSION_US    (6200)
+#elif (SI7021_RESOLUTION == SI7021_RES_RH11_T11)
+#define SI7021_RH_CONVERSION_US   (7000)
+#define SI7021_T_CONVERSION_US    (2400)
+#else
+#error "SI7021_RESOLUTION must be one of SI7021_RES_*"
+#endif
+
+// Wait between the measure command and the read. A humidity measurement
+// also converts the temperature that 0xE0 returns.
+#if SI7021_MEASURE_HUMIDITY
+#define SI7021_CONVERSION_US      (SI7021_RH_CONVERSION_US + SI7021_T_CONVERSION_US)
+#else
+#define SI7021_CONVERSION_US      (SI7021_T_CONVERSION_US)
+#endif
+
+// read_humidity_from_si7021() when the humidity read failed
+#define SI7021_HUMIDITY_INVALID   (-1)
+
+
+typedef void (*i2c_callback_t)(I2C_TransferReturn_TypeDef status, void *arg);
+
+typedef struct i2c_transaction {
+  I2C_TransferSeq_TypeDef   seq;          // address, flags and buffers
+  i2c_callback_t            callback;     // run when the transfer ends, may be NULL
+  void                     *arg;          // passed to callback
+  struct i2c_transaction   *next;         // next queued transaction
+  volatile bool             queued;       // submitted and not finished yet
+} i2c_transaction_t;
+
+
+/**
+* @brief Function to initialise I2C0 and its pins. Call once at start-up,
+*        the peripheral keeps its configuration through EM2.
+*
+*
+* @param void
+* @return void
+*/
 void initI2C(void);
 
 /**
-* @brief Function to initiate i2c write sequence to device
+* @brief Function to queue a transaction, it starts at once if the bus is
+*        idle. Safe to call from an ISR.
+*
+*
+* @param transaction  transaction to run, must stay valid until its callback
+* @return bool        false on success, true if it is already queued
+*/
+bool i2c_submit(i2c_transaction_t *transaction);
+
+/**
+* @brief Function to finish the running transaction and start the next one.
+*        Called from I2C0_IRQHandler() once I2C_Transfer() stops returning
+*        i2cTransferInProgress.
+*
+*
+* @param status  result of the transfer
+* @return void
+*/
+void i2c_transfer_done(I2C_TransferReturn_TypeDef status);
+
+/**
+* @brief Function to queue the Si7021 measure command, humidity or
+*        temperature depending on SI7021_MEASURE_HUMIDITY. The first call
+*        also sets SI7021_RESOLUTION.
 *
 * I2C transfer sequence passes the transfer message structure which holds the device address,
-* buffer to hold data to send from master, and sequence type
+* buffer to hold data to send from master, and sequence type. Completion is
+* reported as the I2C transfer event.
 *
 * @param void
 * @return void
@@ -32,10 +130,12 @@ void initI2C(void);
 void i2c_write();
 
 /**
-* @brief Function to initiate i2c read sequence to device
+* @brief Function to queue a read of the Si7021 measurement, in humidity
+*        mode followed by the temperature from that measurement
 *
 * I2C transfer sequence passes the transfer message structure which holds the device address,
-* buffer to hold data to receive into from device, and sequence type
+* buffer to hold data to receive into from device, and sequence type. Completion is
+* reported as the I2C transfer event.
 *
 * @param void
 * @return void
@@ -44,13 +144,26 @@ void i2c_read();
 
 
 /**
-* @brief Function to calculate temperature from the 16-bit word returned by Si7021 the temperature value is logged on
-* the serial terminal
+* @brief Function to calculate temperature from the 16-bit word returned by Si7021,
+*        round(1000 * (175.72 * code / 65536 - 46.85)) in integer arithmetic
 *
 *
 * @param void
-* @return void
+* @return int32_t  temperature in milli-degrees C
+*/
+int32_t read_temp_from_si7021();
+
+#if SI7021_MEASURE_HUMIDITY
+/**
+* @brief Function to calculate relative humidity from the 16-bit word returned by Si7021,
+*        round(1000 * (125 * code / 65536 - 6)) in integer arithmetic
+*
+*
+* @param void
+* @return int32_t  relative humidity in milli-%, clamped to 0..100000, or
+*                  SI7021_HUMIDITY_INVALID if the humidity read failed
 */
-float read_temp_from_si7021();
+int32_t read_humidity_from_si7021();
+#endif
 
 #endif /* SRC_I2C_H_ */
@@ -23,6 +23,7 @@
 #include "sl_i2cspm.h"
 #include "em_letimer.h"
 #include "src/irq.h"
+#include "src/i2c.h"
 #include "gpio.h"
 #include "src/scheduler.h"
 #include "src/timers.h"
@@ -30,13 +31,13 @@
 #include "sl_bt_api.h"
 #include "src/ble_device_type.h"
 #include "sl_bluetooth.h"
+#include "sl_memlcd.h"
 
 
 #define INCLUDE_LOG_DEBUG 1
 #include "src/log.h"
 
 
-uint32_t count = 0;
 
 void LETIMER0_IRQHandler (void)
 {
@@ -49,40 +50,42 @@ void LETIMER0_IRQHandler (void)
 
   LETIMER_IntClear(LETIMER0, flags);
 
+  // COMP1 belongs to the software timers, they also count the underflow for
+  // the timestamps and re-arm COMP1 every period
+  timerService(flags);
+
   CORE_EXIT_CRITICAL();
 
   if (flags & LETIMER_IF_UF)                    // checking the underflow flag bit
     {
       schedulerSetEventUF();
-      count++;
     }
 
-  if (flags & LETIMER_IF_COMP1)                 // checking the COMP1 flag bit - DOS
-  {
-      // DOS: Probably a bug, you want to disable this IRQ until the next call to timerWaitUs_interrupt()
-      //      otherwise it will keep going off.
-      LETIMER_IntDisable(LETIMER0, LETIMER_IEN_COMP1);        /* Attribution: Instructor Dave Sluiter*/
-      schedulerSetEventCOMP1();                               // setting COMP1 event
-  }
-
 }
 
 void I2C0_IRQHandler(void)
 {
   I2C_TransferReturn_TypeDef transferStatus;
   transferStatus = I2C_Transfer(I2C0);             // continue an initiated I2C transfer in interrupt mode
-  if (transferStatus == i2cTransferDone)          // I2C transfer completed successfully
-    schedulerSetEventI2CTransfer();                // setting I2C transaction event
 
   if (transferStatus < 0)
       LOG_ERROR("%d", transferStatus);              // error logging
+
+  // done or failed, hand the result to its owner and start the next one
+  if (transferStatus != i2cTransferInProgress)
+      i2c_transfer_done(transferStatus);
+}
+
+void USART1_TX_IRQHandler(void)
+{
+  // refill the SPI transmit buffer for the LCD update in progress
+  sl_memlcd_tx_irq_handler();
 }
 
 uint32_t letimerMilliseconds(void)
 {
-    uint32_t time;
-    time = (count)*3000;
-    return time;
+    // low 32 bits, differences of two readings are still right across a wrap
+    return (uint32_t) timerNowMs();
 }
 
 void GPIO_EVEN_IRQHandler(void)
@@ -97,11 +100,17 @@ void GPIO_EVEN_IRQHandler(void)
   if (button_value)       //pressed = 0
     {
       bleDataPtr->button_status = false;
+#if DEVICE_IS_BLE_SERVER
+      ble_button_event_from_isr(0x00);
+#endif
       schedulerSetEventButtonReleased();
     }
   else
     {
       bleDataPtr->button_status = true;
+#if DEVICE_IS_BLE_SERVER
+      ble_button_event_from_isr(0x01);
+#endif
       schedulerSetEventButtonPressed();
     }
 }
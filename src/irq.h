@@ -43,11 +43,21 @@ void LETIMER0_IRQHandler (void);
 void I2C0_IRQHandler(void);
 
 /**
-* @brief Function to return the current timer; Uses LE timer with a resolution
-*         of 3000ms. Used by LOG_<> functions.
+* @brief Interrupt handler for the USART1 transmitter, which drives the LCD
+*         SPI. Keeps a background display update going, see displayFlush().
+*
 *
 * @param void
 * @return void
 */
+void USART1_TX_IRQHandler(void);
+
+/**
+* @brief Function to return the current time in milliseconds, the low 32 bits
+*         of timerNowMs(). Used by LOG_<> functions.
+*
+* @param void
+* @return uint32_t  milliseconds since initLETIMER0()
+*/
 uint32_t letimerMilliseconds(void);
 #endif /* SRC_IRQ_H_ */
@@ -58,6 +58,7 @@
 
 #include "string.h"
 #include "sl_bt_api.h"
+#include "sl_power_manager.h"
 
 #include "ble_device_type.h"
 #include "gpio.h"
@@ -67,6 +68,7 @@
 
 
 #include "lcd.h"
+#include "workq.h"
 
 
 // Include logging specifically for this .c file
@@ -91,6 +93,18 @@ struct display_data {
 	// GLIB_Context required for use with GLIB_ functions
 	GLIB_Context_t           glibContext;
 
+  // text of every row, drawn by displayFlush()
+  char                     rows[DISPLAY_NUMBER_OF_ROWS][DISPLAY_ROW_LEN+1];
+
+  // text of every row as it is currently drawn in the frame buffer
+  char                     shown[DISPLAY_NUMBER_OF_ROWS][DISPLAY_ROW_LEN+1];
+
+  // bit n set: rows[n] changed since the last displayFlush()
+  uint32_t                 dirty_rows;
+
+  // a frame is being sent to the LCD, the frame buffer must not change
+  volatile bool            updating;
+
 };
 
 
@@ -108,6 +122,203 @@ static struct display_data         *displayGetData() {
 }
 
 
+static void displayFlush(void);
+
+// Redraws are deferred to app_process_action() so the BT event handler never
+// waits on GLIB and the SPI transfer
+static workq_item_t display_work = WORKQ_ITEM_INIT(displayFlush, WORKQ_PRIORITY_LOW);
+
+
+// Character cells across one row, 128 pixels / 6 pixel pitch rounded up
+#define DISPLAY_ROW_CELLS  (DISPLAY_ROW_LEN+1)
+
+
+// private function to lay text out on a row of character cells the way
+// GLIB_drawStringOnLine(GLIB_ALIGN_CENTER) positions it, unused cells are spaces
+static void displayLayoutRow(char *cells, int32_t num_cells, int32_t first_cell, const char *text)
+{
+   for (int32_t i=0; i<num_cells; i++) {
+       cells[i] = ' ';
+   }
+
+   for (int32_t i=0; text[i] != 0; i++) {
+       if ((first_cell + i) >= 0 && (first_cell + i) < num_cells) {
+           cells[first_cell + i] = text[i];
+       }
+   }
+} // displayLayoutRow()
+
+
+// private function to bring one row of the frame buffer up to date with
+// rows[row]. When the old and the new text land on the same character grid
+// only the cells that differ are drawn, otherwise the row is erased and
+// redrawn. Returns true when any pixels were drawn.
+static bool displayDrawRow(struct display_data *display, int row)
+{
+   EMSTATUS               status;
+   GLIB_Context_t         *ctx = &display->glibContext;
+   const char             *was = &display->shown[row][0];
+   const char             *now = &display->rows[row][0];
+   int32_t                width = ctx->pDisplayGeometry->xSize;
+   int32_t                pitch = ctx->font.fontWidth + ctx->font.charSpacing;
+   int32_t                y     = row * (ctx->font.fontHeight + ctx->font.lineSpacing);
+   int32_t                was_x, now_x, origin, num_cells, start, k;
+   char                   was_cells[DISPLAY_ROW_CELLS];
+   char                   now_cells[DISPLAY_ROW_CELLS];
+   char                   strToErase[DISPLAY_ROW_LEN+1];   // +1 for null terminator
+   bool                   drawn = false;
+
+   if (strcmp(was, now) == 0) {
+       return false;
+   }
+
+   // Same x as GLIB_drawStringOnLine() computes for centered text
+   was_x = (width - (int32_t) strlen(was) * ctx->font.fontWidth) / 2;
+   now_x = (width - (int32_t) strlen(now) * ctx->font.fontWidth) / 2;
+
+   if (((was_x - now_x) % pitch) == 0) {
+       origin    = now_x % pitch;
+       num_cells = (width - origin) / pitch;
+       if (num_cells > DISPLAY_ROW_CELLS) {
+           num_cells = DISPLAY_ROW_CELLS;
+       }
+
+       displayLayoutRow(was_cells, num_cells, (was_x - origin) / pitch, was);
+       displayLayoutRow(now_cells, num_cells, (now_x - origin) / pitch, now);
+
+       // Draw each run of changed cells, opaque so spaces erase
+       k = 0;
+       while (k < num_cells) {
+           if (was_cells[k] == now_cells[k]) {
+               k++;
+               continue;
+           }
+
+           start = k;
+           while (k < num_cells && was_cells[k] != now_cells[k]) {
+               k++;
+           }
+
+           status = GLIB_drawString(ctx,
+                                    &now_cells[start],
+                                    k - start,
+                                    origin + start * pitch,
+                                    y,
+                                    true);    // opaque
+           if (status != GLIB_OK) {
+               LOG_ERROR("GLIB_drawString() returned non-zero error code=0x%04x", (unsigned int) status);
+           }
+           drawn = true;
+       }
+   }
+   else {
+       // The text moved by half a character, erase the whole line first, then
+       // draw the new string. This way we don't leave any pixels set from the
+       // previous characters.
+       for (int i=0; i<DISPLAY_ROW_LEN; i++) {
+           strToErase[i] = ' ';         // space
+       }
+       strToErase[DISPLAY_ROW_LEN] = 0; // null
+
+       // Erase the row
+       status = GLIB_drawStringOnLine(ctx,
+                                       &strToErase[0],
+                                       row,
+                                       GLIB_ALIGN_CENTER,
+                                       0,        // x offset
+                                       0,        // y offset
+                                       true);    // opaque
+       if (status != GLIB_OK) {
+           LOG_ERROR("Erase GLIB_drawStringOnLine() returned non-zero error code=0x%04x", (unsigned int) status);
+       }
+
+       // Draw the new string on the memory lcd display
+       status = GLIB_drawStringOnLine(ctx,
+                                      now,
+                                      row,
+                                      GLIB_ALIGN_CENTER,
+                                      0,        // x offset
+                                      0,        // y offset
+                                      true);    // opaque
+       if (status != GLIB_OK) {
+           LOG_ERROR("Draw GLIB_drawStringOnLine() returned non-zero error code=0x%04x", (unsigned int) status);
+       }
+       drawn = true;
+   }
+
+   memcpy(&display->shown[row][0], now, DISPLAY_ROW_LEN+1);
+
+   return drawn;
+} // displayDrawRow()
+
+
+// private function called from the SPI interrupt once the LCD has the frame
+static void displayFlushDone(void)
+{
+   struct display_data    *display = displayGetData();
+
+   sl_power_manager_remove_em_requirement(SL_POWER_MANAGER_EM1);
+   display->updating = false;
+
+   // draw any rows printed while the frame was on the wire
+   workq_post(&display_work);
+
+} // displayFlushDone()
+
+
+// private function to draw every changed row and push one update to the LCD
+static void displayFlush(void)
+{
+   EMSTATUS               status;
+   struct display_data    *display = displayGetData();
+   bool                   drawn = false;
+
+   // displayFlushDone() runs us again when the LCD is free
+   if (display->updating) {
+       return;
+   }
+
+   if (display->dirty_rows == 0) {
+       return;
+   }
+
+   for (int row=0; row<DISPLAY_NUMBER_OF_ROWS; row++) {
+       if ((display->dirty_rows & (1UL << row)) == 0) {
+           continue;
+       }
+
+       // a row set back to what is shown before we got here draws nothing
+       if (displayDrawRow(display, row)) {
+           drawn = true;
+       }
+   }
+
+   display->dirty_rows = 0;
+
+   if (!drawn) {
+       return;
+   }
+
+   // Update the data the LCD is displaying, once for all rows drawn above.
+   // The SPI interrupt sends it while we sleep in EM1, USART1 stops in EM2.
+   display->updating = true;
+   sl_power_manager_add_em_requirement(SL_POWER_MANAGER_EM1);
+
+   status = DMD_updateDisplayAsync(displayFlushDone);
+   if (status != DMD_OK) {
+       sl_power_manager_remove_em_requirement(SL_POWER_MANAGER_EM1);
+       display->updating = false;
+       LOG_ERROR("DMD_updateDisplayAsync() returned non-zero error code=0x%04x", (unsigned int) status);
+
+       status = DMD_updateDisplay();
+       if (status != DMD_OK) {
+           LOG_ERROR("DMD_updateDisplay() returned non-zero error code=0x%04x", (unsigned int) status);
+       }
+   }
+
+} // displayFlush()
+
+
 
 // ****************************************************************
 // The following routines are the public functions
@@ -122,9 +333,10 @@ static struct display_data         *displayGetData() {
  *    Example:
  *       displayPrintf(DISPLAY_ROW_TEMPVALUE, "Temp=%d", temp);
  *
- *    The implementation always erases a row first before drawing the
- *    string passed in. This is done so that all pixels from the previously
- *    displayed text will be erased.
+ *    The text is drawn later from app_process_action(), see displayFlush().
+ *    Printing the text a row already holds does nothing, otherwise only the
+ *    character cells that changed are redrawn, with spaces where the previous
+ *    text was longer, so no pixels from the previously displayed text remain.
  *    To erase a row, pass in a format string of either "" or " ".
  *
  *    Row indexes >= DISPLAY_NUMBER_OF_ROWS will throw a LOG_ERROR() msg and
@@ -140,11 +352,9 @@ void displayPrintf(enum display_row row, const char *format, ...)
                           // of handling variable number of arguments passed to
                           // a function.
 
-   EMSTATUS               status;
    struct display_data    *display = displayGetData();
    size_t                 strLen;
    char                   strToDisplay[DISPLAY_ROW_LEN+1]; // +1 for null terminator
-   char                   strToErase[DISPLAY_ROW_LEN+1];   // +1 for null terminator
 
    // Range check the row number
    if (row >= DISPLAY_NUMBER_OF_ROWS) {
@@ -189,44 +399,16 @@ void displayPrintf(enum display_row row, const char *format, ...)
    } // else
 
 
-   // We always erase the whole line first, then draw the new string. This way
-   // we don't leave any pixels set from the previous characters.
-   for (int i=0; i<DISPLAY_ROW_LEN; i++) {
-       strToErase[i] = ' ';         // space
-   }
-   strToErase[DISPLAY_ROW_LEN] = 0; // null
-
-   // Erase the row
-   status = GLIB_drawStringOnLine(&display->glibContext,
-                                   &strToErase[0],
-                                   row,
-                                   GLIB_ALIGN_CENTER,
-                                   0,        // x offset
-                                   0,        // y offset
-                                   true);    // opaque
-   if (status != GLIB_OK) {
-       LOG_ERROR("Erase GLIB_drawStringOnLine() returned non-zero error code=0x%04x", (unsigned int) status);
-   }
-
-
-   // Draw the new string on the memory lcd display
-   status = GLIB_drawStringOnLine(&display->glibContext,
-                                  &strToDisplay[0],
-                                  row,
-                                  GLIB_ALIGN_CENTER,
-                                  0,        // x offset
-                                  0,        // y offset
-                                  true);    // opaque
-   if (status != GLIB_OK) {
-       LOG_ERROR("Draw GLIB_drawStringOnLine() returned non-zero error code=0x%04x", (unsigned int) status);
+   // Same text as last time, nothing to draw
+   if (strcmp(&display->rows[row][0], strToDisplay) == 0) {
+       return;
    }
 
-
-   // Update the data the LCD is displaying
-   status = DMD_updateDisplay();
-   if (status != DMD_OK) {
-       LOG_ERROR("DMD_updateDisplay() returned non-zero error code=0x%04x", (unsigned int) status);
-   }
+   // Only remember the text here, displayFlush() draws it. Several updates
+   // to the same row before then cost a single redraw.
+   memcpy(&display->rows[row][0], strToDisplay, DISPLAY_ROW_LEN+1);
+   display->dirty_rows |= (1UL << row);
+   workq_post(&display_work);
 
 } // displayPrintf()
 
@@ -24,6 +24,7 @@
 #include "em_cmu.h"
 
 #include "src/oscillators.h"
+#include "src/timers.h"
 
 
 void oscillator_init()
@@ -49,5 +50,8 @@ void oscillator_init()
   frequency = CMU_ClockFreqGet (cmuClock_LETIMER0); // got 8129
   LOG_INFO("LETIMER0 clock freq = %d", (int) frequency);
 
+  // the delay and timestamp conversions depend on this clock
+  timerSetClock(frequency);
+
 }
 
@@ -0,0 +1,66 @@
+/* @file      pt.h
+ * @version   1.0
+ * @brief     Stackless coroutines (protothreads) for event driven sequences
+ *
+ * @author    Anuhya Kuraparthy, anuhya.kuraparthy@colorado.edu
+ * @date      Nov 03, 2023
+ *
+ * @institution University of Colorado Boulder (UCB)
+ * @course      ECEN 5823: IoT Embedded Firmware
+ * @instructor  David Sluiter
+ *
+ * @assignment Assignment 9 - BLE Client with Security
+ * @due        Nov 03
+ *
+ * @resources  Adam Dunkels, "Protothreads: Simplifying Event-Driven
+ *             Programming of Memory-Constrained Embedded Systems"
+ */
+
+#ifndef SRC_PT_H_
+#define SRC_PT_H_
+
+#include <stdint.h>
+
+
+/*
+ * A protothread is a function that is called once per event and picks up
+ * where it left off, so a multi-step sequence reads top to bottom with
+ * PT_WAIT_*() at every point it has to wait for an interrupt.
+ *
+ * The only state kept between calls is the resume point, a line number.
+ * Local variables are NOT preserved across a wait, keep anything needed
+ * after one in a static or in the caller's context. A protothread body
+ * must not use switch statements that span a wait.
+ */
+
+typedef struct {
+  uint16_t  lc;                 // resume point, 0 = from the top
+} pt_t;
+
+// Return values of a protothread
+#define PT_WAITING    (0)
+#define PT_ENDED      (1)
+
+// Restart a protothread from the top on its next call
+#define PT_INIT(pt)             ((pt)->lc = 0)
+
+// Declare a protothread: static PT_THREAD(task(pt_t *pt, ...))
+#define PT_THREAD(name_args)    uint8_t name_args
+
+#define PT_BEGIN(pt)            switch ((pt)->lc) { case 0:
+
+#define PT_END(pt)              } (pt)->lc = 0; return PT_ENDED;
+
+// Yield until cond is true, cond is evaluated on every call from here on
+#define PT_WAIT_UNTIL(pt, cond)                 \
+  do {                                          \
+    (pt)->lc = __LINE__; case __LINE__:         \
+    if (!(cond)) {                              \
+        return PT_WAITING;                      \
+    }                                           \
+  } while (0)
+
+// Yield until a scheduler event bit is delivered in events
+#define PT_WAIT_EVENT(pt, events, event)        PT_WAIT_UNTIL((pt), ((events) & (event)) != 0)
+
+#endif /* SRC_PT_H_ */
@@ -0,0 +1,156 @@
+/* @file      ring.c
+ * @version   1.0
+ * @brief     Lock-free single-producer / single-consumer ring buffer
+ *
+ * @author    Anuhya Kuraparthy, anuhya.kuraparthy@colorado.edu
+ * @date      Nov 03, 2023
+ *
+ * @institution University of Colorado Boulder (UCB)
+ * @course      ECEN 5823: IoT Embedded Firmware
+ * @instructor  David Sluiter
+ *
+ * @assignment Assignment 9 - BLE Client with Security
+ * @due        Nov 03
+ *
+ * @resources  -
+ */
+
+#include <string.h>
+
+#include "em_device.h"          // for __DMB()
+#include "src/ring.h"
+
+
+// copy len bytes into the ring starting at counter pos, wrapping once if needed
+static void ring_copy_in(ring_t *ring, uint32_t pos, const uint8_t *src, size_t len)
+{
+  uint32_t offset = pos & ring->mask;
+  uint32_t first  = (ring->mask + 1) - offset;
+
+  if (first >= len) {
+      memcpy(&ring->storage[offset], src, len);
+  }
+  else {
+      memcpy(&ring->storage[offset], src, first);
+      memcpy(&ring->storage[0], src + first, len - first);
+  }
+}
+
+// copy len bytes out of the ring starting at counter pos, wrapping once if needed
+static void ring_copy_out(const ring_t *ring, uint32_t pos, uint8_t *dst, size_t len)
+{
+  uint32_t offset = pos & ring->mask;
+  uint32_t first  = (ring->mask + 1) - offset;
+
+  if (first >= len) {
+      memcpy(dst, &ring->storage[offset], len);
+  }
+  else {
+      memcpy(dst, &ring->storage[offset], first);
+      memcpy(dst + first, &ring->storage[0], len - first);
+  }
+}
+
+
+bool ring_init(ring_t *ring, uint8_t *storage, uint32_t size, uint32_t max_len)
+{
+  if (!RING_SIZE_OK(size) || !RING_MAX_LEN_OK(size, max_len)) {
+      return true;
+  }
+
+  ring->storage = storage;
+  ring->mask    = size - 1;
+  ring->max_len = max_len;
+  ring->head    = 0;
+  ring->tail    = 0;
+
+  return false;
+} // ring_init()
+
+
+void ring_reset(ring_t *ring)
+{
+  ring->tail = ring->head;
+} // ring_reset()
+
+
+bool ring_put(ring_t *ring, uint16_t tag, const uint8_t *data, size_t len)
+{
+  uint8_t  header[RING_RECORD_HEADER_LEN];
+  uint32_t head = ring->head;               // only we write head
+  uint32_t used = head - ring->tail;
+
+  // a longer record would sit at the front for good, no consumer reads it
+  if ((len > ring->max_len) ||
+      ((ring->mask + 1) - used < RING_RECORD_HEADER_LEN + len)) {
+      return true;
+  }
+
+  header[0] = (uint8_t) len;
+  header[1] = (uint8_t) tag;
+  header[2] = (uint8_t) (tag >> 8);
+
+  ring_copy_in(ring, head, header, RING_RECORD_HEADER_LEN);
+  ring_copy_in(ring, head + RING_RECORD_HEADER_LEN, data, len);
+
+  // make the record visible before the new head
+  __DMB();
+  ring->head = head + RING_RECORD_HEADER_LEN + len;
+
+  return false;
+} // ring_put()
+
+
+bool ring_peek(ring_t *ring, uint16_t *tag, uint8_t *data, size_t *len, size_t max_len)
+{
+  uint8_t  header[RING_RECORD_HEADER_LEN];
+  uint32_t tail = ring->tail;               // only we write tail
+
+  if (tail == ring->head) {
+      return true;
+  }
+
+  // head was read before the record contents
+  __DMB();
+
+  ring_copy_out(ring, tail, header, RING_RECORD_HEADER_LEN);
+  if (header[0] > max_len) {
+      return true;
+  }
+
+  ring_copy_out(ring, tail + RING_RECORD_HEADER_LEN, data, header[0]);
+
+  *len = header[0];
+  *tag = (uint16_t) (header[1] | (header[2] << 8));
+
+  return false;
+} // ring_peek()
+
+
+void ring_drop(ring_t *ring)
+{
+  uint8_t  len;
+  uint32_t tail = ring->tail;
+
+  if (tail == ring->head) {
+      return;
+  }
+
+  ring_copy_out(ring, tail, &len, 1);
+
+  // finish reading the record before handing the space back
+  __DMB();
+  ring->tail = tail + RING_RECORD_HEADER_LEN + len;
+} // ring_drop()
+
+
+bool ring_get(ring_t *ring, uint16_t *tag, uint8_t *data, size_t *len, size_t max_len)
+{
+  if (ring_peek(ring, tag, data, len, max_len)) {
+      return true;
+  }
+
+  ring_drop(ring);
+
+  return false;
+} // ring_get()
@@ -0,0 +1,153 @@
+/* @file      ring.h
+ * @version   1.0
+ * @brief     Application interface provided for ring.c
+ *
+ * @author    Anuhya Kuraparthy, anuhya.kuraparthy@colorado.edu
+ * @date      Nov 03, 2023
+ *
+ * @institution University of Colorado Boulder (UCB)
+ * @course      ECEN 5823: IoT Embedded Firmware
+ * @instructor  David Sluiter
+ *
+ * @assignment Assignment 9 - BLE Client with Security
+ * @due        Nov 03
+ *
+ * @resources  -
+ */
+
+#ifndef SRC_RING_H_
+#define SRC_RING_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+// Bytes of per-record metadata stored in front of every payload
+#define RING_RECORD_HEADER_LEN    (3)
+
+// Largest payload a single record can carry
+#define RING_MAX_PAYLOAD_LEN      (255)
+
+
+/*
+ * Single-producer / single-consumer ring of variable length records.
+ *
+ * The storage size must be a power of two. head and tail are free running
+ * counters, only the producer writes head and only the consumer writes tail,
+ * so one side may run in an ISR while the other runs from the BT event loop
+ * without a critical section.
+ */
+typedef struct {
+  uint8_t            *storage;      // backing storage, size bytes long
+  uint32_t            mask;         // size - 1
+  uint32_t            max_len;      // longest payload ring_put() accepts
+  volatile uint32_t   head;         // write counter, owned by the producer
+  volatile uint32_t   tail;         // read counter, owned by the consumer
+} ring_t;
+
+// What ring_init() checks at run time, RING_INIT() at compile time
+#define RING_SIZE_OK(size)            (((size) != 0) && (((size) & ((size) - 1)) == 0))
+#define RING_MAX_LEN_OK(size, max_len) \
+  (((max_len) <= RING_MAX_PAYLOAD_LEN) && ((RING_RECORD_HEADER_LEN + (max_len)) <= (size)))
+
+// Static initialiser, storage must be an array whose size is a power of two
+// and consumers must read with a buffer of at least max_len bytes
+#define RING_INIT(storage, max_len)                                                   \
+  { (storage),                                                                        \
+    sizeof(storage) - 1 + (0 * sizeof(struct {                                      \
+      _Static_assert(RING_SIZE_OK(sizeof(storage)),                                 \
+                     "RING_INIT() storage size must be a power of two");            \
+      _Static_assert(RING_MAX_LEN_OK(sizeof(storage), (max_len)),                   \
+                     "RING_INIT() max_len does not fit a record in storage");       \
+      int unused; })),                                                              \
+    (max_len), 0, 0 }
+
+
+/**
+* @brief Function to initialise a ring over caller provided storage
+*
+*
+* @param ring     ring to initialise
+* @param storage  backing storage
+* @param size     size of storage in bytes, must be a power of two
+* @param max_len  longest payload ring_put() accepts, consumers must read
+*                 with a buffer at least this long
+* @return bool    false on success, true if size is not a power of two or a
+*                 max_len record does not fit in it
+*/
+bool ring_init(ring_t *ring, uint8_t *storage, uint32_t size, uint32_t max_len);
+
+/**
+* @brief Function to discard all records in the ring. Only call this when
+*        neither the producer nor the consumer can be running.
+*
+*
+* @param ring  ring to reset
+* @return void
+*/
+void ring_reset(ring_t *ring);
+
+/**
+* @brief Producer side: copy one record into the ring and publish it.
+*        Safe to call from an ISR.
+*
+*
+* @param ring  ring to write into
+* @param tag   caller defined 16-bit tag stored with the record (char handle)
+* @param data  payload to copy
+* @param len   payload length in bytes
+* @return bool false on success, true if the ring is full or len is over
+*              the ring's max_len
+*/
+bool ring_put(ring_t *ring, uint16_t tag, const uint8_t *data, size_t len);
+
+/**
+* @brief Consumer side: look at the oldest record without removing it
+*
+*
+* @param ring     ring to read from
+* @param tag      returns the record tag
+* @param data     returns the payload, must hold max_len bytes
+* @param len      returns the payload length
+* @param max_len  size of data in bytes, at least the ring's max_len
+* @return bool    false on success, true if the ring is empty. A record
+*                 longer than max_len means the buffer is smaller than the
+*                 ring's max_len; it is left in place and true returned.
+*/
+bool ring_peek(ring_t *ring, uint16_t *tag, uint8_t *data, size_t *len, size_t max_len);
+
+/**
+* @brief Consumer side: remove the oldest record
+*
+*
+* @param ring  ring to read from
+* @return void
+*/
+void ring_drop(ring_t *ring);
+
+/**
+* @brief Consumer side: copy out and remove the oldest record
+*
+*
+* @param ring     ring to read from
+* @param tag      returns the record tag
+* @param data     returns the payload, must hold max_len bytes
+* @param len      returns the payload length
+* @param max_len  size of data in bytes, at least the ring's max_len
+* @return bool    false on success, true if the ring is empty, see ring_peek()
+*/
+bool ring_get(ring_t *ring, uint16_t *tag, uint8_t *data, size_t *len, size_t max_len);
+
+/**
+* @brief Function to check for pending records
+*
+*
+* @param ring  ring to check
+* @return bool true when there is nothing to read
+*/
+static inline bool ring_is_empty(const ring_t *ring)
+{
+  return (ring->head == ring->tail);
+}
+
+#endif /* SRC_RING_H_ */
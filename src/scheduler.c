@@ -26,6 +26,9 @@
 #include "src/ble_device_type.h"
 #include "sl_bluetooth.h"
 #include "src/lcd.h"
+#include "src/fsm.h"
+#include "src/pt.h"
+#include "src/workq.h"
 
 
 #define INCLUDE_LOG_DEBUG 1
@@ -33,16 +36,12 @@
 
 
 #define POWERUP_TIME      (80000)
-#define CONVERTION_TIME    (10800)
 
 
-#define   MY_NUM_STATES (5)
-typedef enum uint32_t {
-  STATE0_IDLE,                      // state for POR sequence
-  STATE1_TIMER_WAIT,                // state for writing I2C command
-  STATE2_WARMUP,                    // state for conversion time delay
-  STATE3_MEASUREMENT,               // state for reading I2C command
-  STATE4_REPORT,                    // state to print temperature values
+#if !DEVICE_IS_BLE_SERVER
+
+// Per Server discovery states
+typedef enum {
   STATE0,
   STATE1,
   STATE2,
@@ -51,293 +50,457 @@ typedef enum uint32_t {
   STATE5,
   STATE6,
   STATE7,
-}my_states;
+  STATE8,                           // cached Server, check its Database Hash
+  DISCOVERY_NUM_STATES
+}discovery_states;
 
+// BT events the discovery reacts to
+typedef enum {
+  DISC_EVT_OPENED,
+  DISC_EVT_PROCEDURE_COMPLETED,
+  DISC_NUM_EVENTS
+}discovery_events;
 
+#endif
 
-uint32_t myEvents = 0;          // variable to hold all events
-sl_status_t rc = 0;
 
-static const uint8_t characteristic_uuid[] =  { 0x1c, 0x2a }; // Reverse the byte order for little-endian format
-static const uint8_t service_uuid[2] = { 0x09, 0x18 };
 
-static const uint8_t button_characteristic_uuid[] =  { 0x89, 0x62, 0x13, 0x2d, 0x2a, 0x65, 0xec, 0x87, 0x3e, 0x43, 0xc8, 0x38, 0x02, 0x00, 0x00, 0x00 }; // Reverse the byte order for little-endian format
-static const uint8_t button_service_uuid[] =  { 0x89, 0x62, 0x13, 0x2d, 0x2a, 0x65, 0xec, 0x87, 0x3e, 0x43, 0xc8, 0x38, 0x01, 0x00, 0x00, 0x00 };
+// Events raised by ISRs and not yet handed to the BT event loop. Bits
+// accumulate here and only the first one of a batch costs an external
+// signal, so back-to-back events are never merged into a value nobody
+// matches.
+static volatile uint32_t myEvents = 0;
+sl_status_t rc = 0;
 
+// Order in which coalesced events are dispatched, most urgent first: finish
+// the I2C transfer and release EM1 before anything else runs
+static const uint32_t event_priority[] = {
+  evt_I2CTransferComplete,
+  evtCOMP1_LETIMER0,
+  evtUF_LETIMER0,
+  evt_button_pressed,
+  evt_button_released,
+};
 
+#if !DEVICE_IS_BLE_SERVER
+// Service and characteristic UUIDs are matched in ble.c
+static const uint8_t database_hash_uuid[] = { 0x2a, 0x2b }; // Reverse the byte order for little-endian format
+#endif
 
 
 
-void schedulerSetEventUF()
+// set an event bit, safe to call from any ISR
+static void schedulerSetEvent(uint32_t event)
 {
   CORE_DECLARE_IRQ_STATE;
   CORE_ENTER_CRITICAL();            // enter critical, turn off interrupts in NVIC
-  sl_bt_external_signal(evtUF_LETIMER0);
+
+  // the stack already has a signal outstanding for a non-empty set
+  if (myEvents == 0) {
+      sl_bt_external_signal(SCHEDULER_EXT_SIGNAL);
+  }
+  myEvents |= event;                // RMW
+
   CORE_EXIT_CRITICAL();             // exit critical, re-enable interrupts in NVIC
+} // schedulerSetEvent()
+
+
+void schedulerSetEventUF()
+{
+  schedulerSetEvent(evtUF_LETIMER0);
 }
 
 void schedulerSetEventCOMP1()
 {
-  CORE_DECLARE_IRQ_STATE;
-  CORE_ENTER_CRITICAL();            // enter critical, turn off interrupts in NVIC
-  sl_bt_external_signal(evtCOMP1_LETIMER0);    // RMW
-  CORE_EXIT_CRITICAL();             // exit critical, re-enable interrupts in NVIC
+  schedulerSetEvent(evtCOMP1_LETIMER0);
 }
 
 void schedulerSetEventI2CTransfer()
 {
-  CORE_DECLARE_IRQ_STATE;
-  CORE_ENTER_CRITICAL();                    // enter critical, turn off interrupts in NVIC
-  sl_bt_external_signal(evt_I2CTransferComplete);     // RMW
-  CORE_EXIT_CRITICAL();                     // exit critical, re-enable interrupts in NVIC
+  schedulerSetEvent(evt_I2CTransferComplete);
 }
 
 void schedulerSetEventButtonReleased()
 {
-  CORE_DECLARE_IRQ_STATE;
-  CORE_ENTER_CRITICAL();                    // enter critical, turn off interrupts in NVIC
-  sl_bt_external_signal(evt_button_released);     // RMW
-  CORE_EXIT_CRITICAL();
+  schedulerSetEvent(evt_button_released);
 }
 
 void schedulerSetEventButtonPressed()
 {
+  schedulerSetEvent(evt_button_pressed);
+}
+
+
+uint32_t schedulerGetEvents(void)
+{
+  uint32_t events;
+
   CORE_DECLARE_IRQ_STATE;
-  CORE_ENTER_CRITICAL();                    // enter critical, turn off interrupts in NVIC
-  sl_bt_external_signal(evt_button_pressed);     // RMW
+  CORE_ENTER_CRITICAL();
+  events = myEvents;
+  myEvents = 0;
   CORE_EXIT_CRITICAL();
-}
+
+  return events;
+} // schedulerGetEvents()
+
+
+uint32_t schedulerNextEvent(uint32_t *events)
+{
+  uint32_t event;
+
+  for (uint32_t i = 0; i < sizeof(event_priority) / sizeof(event_priority[0]); i++) {
+      event = event_priority[i];
+      if (*events & event) {
+          *events &= ~event;
+          return event;
+      }
+  }
+
+  // bits nobody defined a priority for, lowest first
+  event = *events & (~*events + 1);
+  *events &= ~event;
+
+  return event;
+} // schedulerNextEvent()
+
+// ---------------------------------------------------------------------------
+// Temperature measurement: power up, write the measure command, wait for the
+// conversion, read the result and report it. Called once per event, events
+// is the single event bit being delivered.
+// ---------------------------------------------------------------------------
+
+static PT_THREAD(temperature_task(pt_t *pt, uint32_t events))
+{
+  PT_BEGIN(pt);
+
+  for (;;)
+    {
+      // one measurement per LETIMER0 period
+      PT_WAIT_EVENT(pt, events, evtUF_LETIMER0);
+
+      //sensor_enable();                          // power up the device
+      timerWaitUs_interrupt(POWERUP_TIME);      // interrupt for powerup time
+      PT_WAIT_EVENT(pt, events, evtCOMP1_LETIMER0);
+
+      // the I2C engine holds EM1 while a transfer is queued
+      i2c_write();                               // I2C write command
+      PT_WAIT_EVENT(pt, events, evt_I2CTransferComplete);
+
+      timerWaitUs_interrupt(SI7021_CONVERSION_US);      // interrupt for conversion time
+      PT_WAIT_EVENT(pt, events, evtCOMP1_LETIMER0);
+
+      i2c_read();
+      PT_WAIT_EVENT(pt, events, evt_I2CTransferComplete);
+
+      //sensor_disable();
+      send_temperature();
+    }
+
+  PT_END(pt);
+} // temperature_task()
+
 
 void state_machine(sl_bt_msg_t *evt)
 {
-  static my_states nextState = STATE0_IDLE;               /* Attribution: Instructor Dave Sluiter*/
-         my_states state;
+  static pt_t temperature_pt = { 0 };               /* Attribution: Instructor Dave Sluiter*/
 
   ble_data_struct_t *bleDataPtr = getBleDataPtr();
 
   /* Attribution: Instructor Dave Sluiter*/
-  // On each call, transfer nextState to state, this is similar to how
-  // a hardware state machine transfers nextState to the state flip-flops
-  // on each rising edge of the clock signal
-  state = nextState;
-
-  /* Attribution: Instructor Dave Sluiter*/
-  //if((SL_BT_MSG_ID(evt->header) == sl_bt_evt_system_external_signal_id)){
   // Return if:
   //   a) not an sl_bt_evt_system_external_signal_id event, or
-  //   b) client has not enabled indications for this characteristic
+  //   b) client has enabled neither the temperature nor the batch characteristic
   //   c) not in an open connection
   if( (SL_BT_MSG_ID(evt->header) != sl_bt_evt_system_external_signal_id) ||
-      (bleDataPtr->ok_to_send_htm_indications != true) ||
+      ((bleDataPtr->ok_to_send_htm_indications != true) &&
+       (bleDataPtr->batch_client_config == sl_bt_gatt_server_disable)) ||
       (bleDataPtr->connection_open != true) ) {
 
      return;
 
   } // if
 
-  switch (state)
-  {
-    case STATE0_IDLE:
-      nextState = STATE0_IDLE;      //default
-      if (evt->data.evt_system_external_signal.extsignals == evtUF_LETIMER0)
-        {
-          //sensor_enable();                          // power up the device
-          timerWaitUs_interrupt(POWERUP_TIME);      // interrupt for powerup time
-          nextState = STATE1_TIMER_WAIT;
-        }
-      break;
+  (void) temperature_task(&temperature_pt, evt->data.evt_system_external_signal.extsignals);
+} // state_machine()
 
-    case STATE1_TIMER_WAIT:
-      nextState = STATE1_TIMER_WAIT;      //default
-      if (evt->data.evt_system_external_signal.extsignals == evtCOMP1_LETIMER0)
-        {
-          sl_power_manager_add_em_requirement(SL_POWER_MANAGER_EM1);    // Power requirement for I2C
-          i2c_write();                               // I2C write command
-          nextState = STATE2_WARMUP;
-        }
-      break;
+#if !DEVICE_IS_BLE_SERVER
 
-    case STATE2_WARMUP:
-      nextState = STATE2_WARMUP;      //default
-      if (evt->data.evt_system_external_signal.extsignals == evt_I2CTransferComplete)
-        {
-          sl_power_manager_remove_em_requirement(SL_POWER_MANAGER_EM1);
-          timerWaitUs_interrupt(CONVERTION_TIME);           // interrupt for powerup time
-          nextState = STATE3_MEASUREMENT;
-        }
-      break;
+// ---------------------------------------------------------------------------
+// Discovery: one pass over all primary services and then one characteristic
+// pass per service of interest. handle_ble_event() picks the HTM, button and
+// Generic Attribute handles out of the sl_bt_evt_gatt_service /
+// sl_bt_evt_gatt_characteristic streams by UUID. ctx is the ble_server_t.
+// ---------------------------------------------------------------------------
 
-    case STATE3_MEASUREMENT:
-      nextState = STATE3_MEASUREMENT;      //default
-      if (evt->data.evt_system_external_signal.extsignals == evtCOMP1_LETIMER0)
-        {
-          sl_power_manager_add_em_requirement(SL_POWER_MANAGER_EM1);
-          i2c_read();
-          nextState = STATE4_REPORT;
-        }
-      break;
+static uint8_t disc_start(void *ctx, sl_bt_msg_t *evt, uint8_t next_state)
+{
+  ble_server_t *server = ctx;
+  ble_discovery_cache_t *cache;
 
-    case STATE4_REPORT:
-      nextState = STATE4_REPORT;      //default
-      if (evt->data.evt_system_external_signal.extsignals == evt_I2CTransferComplete)
-        {
-          sl_power_manager_remove_em_requirement(SL_POWER_MANAGER_EM1);
-          //sensor_disable();
-          NVIC_DisableIRQ(I2C0_IRQn);
-          send_temperature();
-          nextState = STATE0_IDLE;
-        }
-      break;
+  (void) evt;
 
-    default:
+  cache = ble_discovery_cache_find(&server->address);
+  if (cache != NULL)
+    {
+      // Seen this Server before, its handles are still good if
+      // its Database Hash has not changed
+      server->reading_database_hash = true;
+      rc = sl_bt_gatt_read_characteristic_value(server->connection_handle,
+                                                cache->hash_characteristic);
 
-      break;
-  }
+      if (rc != SL_STATUS_OK) {
+                   LOG_ERROR("sl_bt_gatt_read_characteristic_value() returned != 0 status=0x%04x", (unsigned int) rc);
+               }
+      return STATE8;
+    }
 
-}
+  rc = sl_bt_gatt_discover_primary_services(server->connection_handle);
 
-void discovery_state_machine(sl_bt_msg_t *evt)
+  if (rc != SL_STATUS_OK) {
+               LOG_ERROR("sl_bt_gatt_discover_primary_services() returned != 0 status=0x%04x", (unsigned int) rc);
+           }
+
+  return next_state;
+} // disc_start()
+
+static uint8_t disc_htm_characteristics(void *ctx, sl_bt_msg_t *evt, uint8_t next_state)
 {
-  static my_states nextState = STATE0;               /* Attribution: Instructor Dave Sluiter*/
-          my_states state;
+  ble_server_t *server = ctx;
 
-  ble_data_struct_t *bleDataPtr = getBleDataPtr();
+  (void) evt;
 
-  //default state
-  if(SL_BT_MSG_ID(evt->header) == sl_bt_evt_connection_closed_id) {
-      nextState = STATE0;
-  }
+  // every service is known now, walk the HTM service's characteristics
+  rc = sl_bt_gatt_discover_characteristics(server->connection_handle,
+                                           server->service_handle);
 
-  state = nextState;
+  if (rc != SL_STATUS_OK) {
+               LOG_ERROR("sl_bt_gatt_discover_characteristics() returned != 0 status=0x%04x", (unsigned int) rc);
+           }
 
-  switch (state)
-  {
-    case STATE0:
-      nextState = STATE0;      //default
-
-      if(SL_BT_MSG_ID(evt->header) == sl_bt_evt_connection_opened_id)
-          {
-          // 1-time discovery of the HTM service using its service UUID
-              rc = sl_bt_gatt_discover_primary_services_by_uuid(bleDataPtr->connection_handle,
-                                              sizeof(service_uuid),
-                                              (const uint8_t *)service_uuid);
-
-              if (rc != SL_STATUS_OK) {
-                           LOG_ERROR("sl_bt_gatt_discover_primary_services_by_uuid() returned != 0 status=0x%04x", (unsigned int) rc);
-                       }
-              nextState = STATE1;
-          }
-      break;
+  return next_state;
+} // disc_htm_characteristics()
 
-    case STATE1:
-      nextState = STATE1;
+static uint8_t disc_button_characteristics(void *ctx, sl_bt_msg_t *evt, uint8_t next_state)
+{
+  ble_server_t *server = ctx;
 
+  (void) evt;
 
+  rc = sl_bt_gatt_discover_characteristics(server->connection_handle,
+                                           server->button_service_handle);
 
-      if(SL_BT_MSG_ID(evt->header) == sl_bt_evt_gatt_procedure_completed_id)
-        {
-          rc = sl_bt_gatt_discover_characteristics_by_uuid(bleDataPtr->connection_handle,
-                                                           bleDataPtr->service_handle,
-                                                           sizeof(characteristic_uuid),
-                                                           (const uint8_t *)characteristic_uuid);
+  if (rc != SL_STATUS_OK) {
+               LOG_ERROR("sl_bt_gatt_discover_characteristics() returned != 0 status=0x%04x", (unsigned int) rc);
+           }
 
-          if (rc != SL_STATUS_OK) {
-                       LOG_ERROR("sl_bt_gatt_discover_characteristics_by_uuid() returned != 0 status=0x%04x", (unsigned int) rc);
-                   }
+  return next_state;
+} // disc_button_characteristics()
 
-          nextState = STATE2;
-        }
-      break;
+static uint8_t disc_enable_htm(void *ctx, sl_bt_msg_t *evt, uint8_t next_state)
+{
+  ble_server_t *server = ctx;
+
+  (void) evt;
+
+  rc = sl_bt_gatt_set_characteristic_notification(server->connection_handle,
+                                                  server->characteristic,
+                                                  sl_bt_gatt_indication);
+
+  if (rc != SL_STATUS_OK) {
+               LOG_ERROR("sl_bt_gatt_set_characteristic_notification() returned != 0 status=0x%04x", (unsigned int) rc);
+           }
+
+  displayPrintf(DISPLAY_ROW_CONNECTION, "Handling Indications");
+
+  return next_state;
+} // disc_enable_htm()
+
+static uint8_t disc_enable_button(void *ctx, sl_bt_msg_t *evt, uint8_t next_state)
+{
+  ble_server_t *server = ctx;
+
+  (void) evt;
+
+  rc = sl_bt_gatt_set_characteristic_notification(server->connection_handle,
+                                                  server->button_characteristic,
+                                                  sl_bt_gatt_indication);
+
+  server->button_indication_client = true;
+
+  if (rc != SL_STATUS_OK) {
+               LOG_ERROR("sl_bt_gatt_set_characteristic_notification() returned != 0 status=0x%04x", (unsigned int) rc);
+           }
+
+  return next_state;
+} // disc_enable_button()
+
+static uint8_t disc_read_hash(void *ctx, sl_bt_msg_t *evt, uint8_t next_state)
+{
+  ble_server_t *server = ctx;
+
+  (void) evt;
+
+  // Servers without GATT caching have no hash and are always rediscovered
+  if (server->discovery_from_cache || (server->gatt_service_handle == 0))
+    return STATE7;
+
+  // read the Database Hash so the next connection can skip discovery
+  server->reading_database_hash = true;
+  rc = sl_bt_gatt_read_characteristic_value_by_uuid(server->connection_handle,
+                                                    server->gatt_service_handle,
+                                                    sizeof(database_hash_uuid),
+                                                    (const uint8_t *)database_hash_uuid);
 
-    case STATE2:
-      nextState = STATE2;
-      if(SL_BT_MSG_ID(evt->header) == sl_bt_evt_gatt_procedure_completed_id)
-        {
-          rc = sl_bt_gatt_set_characteristic_notification(bleDataPtr->connection_handle,
-                                                          bleDataPtr->characteristic,
-                                                          sl_bt_gatt_indication);
+  if (rc != SL_STATUS_OK) {
+               LOG_ERROR("sl_bt_gatt_read_characteristic_value_by_uuid() returned != 0 status=0x%04x", (unsigned int) rc);
+               server->reading_database_hash = false;
+               return STATE7;
+           }
 
-          if (rc != SL_STATUS_OK) {
-                       LOG_ERROR("sl_bt_gatt_set_characteristic_notification() returned != 0 status=0x%04x", (unsigned int) rc);
-                   }
+  return next_state;
+} // disc_read_hash()
 
-          displayPrintf(DISPLAY_ROW_CONNECTION, "Handling Indications");
+static uint8_t disc_store_hash(void *ctx, sl_bt_msg_t *evt, uint8_t next_state)
+{
+  ble_server_t *server = ctx;
+
+  (void) evt;
+
+  server->reading_database_hash = false;
+
+  if (server->database_hash_valid)
+    {
+      ble_discovery_cache_store(server);
+    }
+
+  return next_state;
+} // disc_store_hash()
+
+static uint8_t disc_check_hash(void *ctx, sl_bt_msg_t *evt, uint8_t next_state)
+{
+  ble_server_t *server = ctx;
+  ble_discovery_cache_t *cache;
+
+  server->reading_database_hash = false;
+  cache = ble_discovery_cache_find(&server->address);
+
+  if ((evt->data.evt_gatt_procedure_completed.result == SL_STATUS_OK) &&
+      (cache != NULL) &&
+      server->database_hash_valid &&
+      (memcmp(server->database_hash, cache->database_hash, DATABASE_HASH_LEN) == 0))
+    {
+      // Database unchanged, go straight to enabling indications
+      server->characteristic = cache->characteristic;
+      server->button_characteristic = cache->button_characteristic;
+      server->hash_characteristic = cache->hash_characteristic;
+      server->discovery_from_cache = true;
+
+      // STATE4 enables the button indications once this completes
+      return disc_enable_htm(server, evt, next_state);
+    }
+
+  // Database changed or unreadable, rediscover from scratch
+  server->database_hash_valid = false;
+
+  rc = sl_bt_gatt_discover_primary_services(server->connection_handle);
+
+  if (rc != SL_STATUS_OK) {
+               LOG_ERROR("sl_bt_gatt_discover_primary_services() returned != 0 status=0x%04x", (unsigned int) rc);
+           }
+
+  return STATE1;
+} // disc_check_hash()
+
+
+// STATE7 has no transitions, the entry is released when the connection closes
+//      state    event                          action                        next state
+#define DISCOVERY_FSM(X) \
+  X(STATE0,  DISC_EVT_OPENED,               disc_start,                   STATE1) \
+  X(STATE1,  DISC_EVT_PROCEDURE_COMPLETED,  disc_htm_characteristics,     STATE2) \
+  X(STATE2,  DISC_EVT_PROCEDURE_COMPLETED,  disc_button_characteristics,  STATE3) \
+  X(STATE3,  DISC_EVT_PROCEDURE_COMPLETED,  disc_enable_htm,              STATE4) \
+  X(STATE4,  DISC_EVT_PROCEDURE_COMPLETED,  disc_enable_button,           STATE5) \
+  X(STATE5,  DISC_EVT_PROCEDURE_COMPLETED,  disc_read_hash,               STATE6) \
+  X(STATE6,  DISC_EVT_PROCEDURE_COMPLETED,  disc_store_hash,              STATE7) \
+  X(STATE8,  DISC_EVT_PROCEDURE_COMPLETED,  disc_check_hash,              STATE4)
+
+#define DISC_TRANSITION(state, event, action, next_state) \
+  FSM_TRANSITION(DISC_NUM_EVENTS, state, event, action, next_state)
+
+static const fsm_transition_t discovery_table[DISCOVERY_NUM_STATES * DISC_NUM_EVENTS] = {
+  DISCOVERY_FSM(DISC_TRANSITION)
+};
+
+static fsm_stats_t discovery_stats[DISCOVERY_NUM_STATES * DISC_NUM_EVENTS];
+
+static const fsm_t discovery_fsm = {
+  "discovery",
+  discovery_table,
+  discovery_stats,
+  DISCOVERY_NUM_STATES,
+  DISC_NUM_EVENTS
+};
 
-          nextState = STATE3;
-        }
+
+void discovery_state_machine(sl_bt_msg_t *evt)
+{
+  ble_server_t *server;
+  uint8_t connection;
+  uint8_t event;
+
+  // Every Server runs its own discovery, find the one this event is for
+  switch (SL_BT_MSG_ID(evt->header))
+  {
+    case sl_bt_evt_connection_opened_id:
+      connection = evt->data.evt_connection_opened.connection;
+      event = DISC_EVT_OPENED;
       break;
 
-    case STATE3:
-      nextState = STATE3;
-      if(SL_BT_MSG_ID(evt->header) == sl_bt_evt_gatt_procedure_completed_id)
-        {
-          rc = sl_bt_gatt_discover_primary_services_by_uuid(bleDataPtr->connection_handle,
-                                                     sizeof(button_service_uuid),
-                                                     (const uint8_t *)button_service_uuid);
-
-          if (rc != SL_STATUS_OK) {
-                                  LOG_ERROR("sl_bt_gatt_discover_primary_services_by_uuid() returned != 0 status=0x%04x", (unsigned int) rc);
-          }
-
-          nextState = STATE4;
-        }
-     break;
-
-    case STATE4:
-      nextState = STATE4;
-      if(SL_BT_MSG_ID(evt->header) == sl_bt_evt_gatt_procedure_completed_id)
-        {
-          rc = sl_bt_gatt_discover_characteristics_by_uuid(bleDataPtr->connection_handle,
-                                                           bleDataPtr->button_service_handle,
-                                                           sizeof(button_characteristic_uuid),
-                                                           (const uint8_t *)button_characteristic_uuid);
-
-          if (rc != SL_STATUS_OK) {
-                       LOG_ERROR("sl_bt_gatt_discover_characteristics_by_uuid() returned != 0 status=0x%04x", (unsigned int) rc);
-                   }
-          nextState = STATE5;
-        }
-     break;
-
-
-    case STATE5:
-      nextState = STATE5;
-      if(SL_BT_MSG_ID(evt->header) == sl_bt_evt_gatt_procedure_completed_id)
-        {
-          rc = sl_bt_gatt_set_characteristic_notification(bleDataPtr->connection_handle,
-                                                          bleDataPtr->button_characteristic,
-                                                          sl_bt_gatt_indication);
-
-          bleDataPtr->button_indication_client = true;
-
-          if (rc != SL_STATUS_OK) {
-                       LOG_ERROR("sl_bt_gatt_set_characteristic_notification() returned != 0 status=0x%04x", (unsigned int) rc);
-                   }
-          nextState = STATE6;
-        }
-     break;
-
-    case STATE6:
-      nextState = STATE6;
-      if(SL_BT_MSG_ID(evt->header) == sl_bt_evt_gatt_procedure_completed_id)
-        {
-          nextState = STATE7;
-        }
-     break;
-
-    case STATE7:
-      nextState = STATE7;
-      if(SL_BT_MSG_ID(evt->header) == sl_bt_evt_connection_closed_id)
-        {
-          nextState = STATE0;
-        }
-     break;
+    case sl_bt_evt_gatt_procedure_completed_id:
+      connection = evt->data.evt_gatt_procedure_completed.connection;
+      event = DISC_EVT_PROCEDURE_COMPLETED;
+      break;
 
     default:
+      // the Server's entry is gone by the time its close event gets here
+      return;
+  }
 
-      break;
+  server = ble_server_find(connection);
+  if (server == NULL) {
+      return;
+  }
 
+  // a new entry starts out zeroed
+  if (event == DISC_EVT_OPENED) {
+      server->discovery_state = STATE0;
   }
-}
+
+  /* Attribution: Instructor Dave Sluiter*/
+  server->discovery_state = fsm_dispatch(&discovery_fsm,
+                                         server->discovery_state,
+                                         event,
+                                         server,
+                                         evt);
+} // discovery_state_machine()
+
+#endif
+
+
+static void scheduler_print_stats(void)
+{
+#if !DEVICE_IS_BLE_SERVER
+  fsm_log_stats(&discovery_fsm);
+#endif
+} // scheduler_print_stats()
+
+static workq_item_t stats_work = WORKQ_ITEM_INIT(scheduler_print_stats, WORKQ_PRIORITY_LOW);
+
+
+void scheduler_log_stats(void)
+{
+  workq_post(&stats_work);
+} // scheduler_log_stats()
 
 //if(SL_BT_MSG_ID(evt->header) == sl_bt_evt_connection_closed_id)
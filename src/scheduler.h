@@ -23,14 +23,19 @@
 
 #include "sl_bluetooth.h"
 
+// Event bits, one per bit so several can be pending at once
 enum {
   evtUF_LETIMER0 = 0x01,           // event for underflow interrupt
   evtCOMP1_LETIMER0 = 0x02,        // event for COMP1 interrupt
   evt_I2CTransferComplete = 0x04,    // event for I2C transaction
   evt_button_released = 0x08,
-  evt_button_pressed = 0x16
+  evt_button_pressed = 0x10
 };
 
+// The one external signal raised towards the stack, the events themselves
+// are collected with schedulerGetEvents()
+#define SCHEDULER_EXT_SIGNAL  (0x01)
+
 
 
 /**
@@ -73,6 +78,24 @@ void schedulerSetEventI2CTransfer();
 void schedulerSetEventButtonReleased();
 void schedulerSetEventButtonPressed();
 
+/**
+* @brief Function to take every event raised since the last call
+*
+*
+* @param void
+* @return uint32_t  bitmask of pending events, cleared by this call
+*/
+uint32_t schedulerGetEvents(void);
+
+/**
+* @brief Function to take the most urgent event out of a set of events
+*
+*
+* @param events  pending events, the returned bit is cleared
+* @return uint32_t  a single event bit, 0 when events is empty
+*/
+uint32_t schedulerNextEvent(uint32_t *events);
+
 /**
 * @brief State machine to control order of events
 *
@@ -91,6 +114,16 @@ void state_machine(sl_bt_msg_t *evt);
 */
 void discovery_state_machine(sl_bt_msg_t *evt);
 
+/**
+* @brief Function to queue logging of how often each state machine transition
+*        ran and how many CPU cycles it took
+*
+*
+* @param void
+* @return void
+*/
+void scheduler_log_stats(void);
+
 
 
 #endif /* SRC_SCHEDULER_H_ */
@@ -16,21 +16,44 @@
  */
 
 #include "em_letimer.h"
+#include "em_core.h"
 #include "app.h"
 #include "em_cmu.h"
 
 #include "src/oscillators.h"
 #include "src/timers.h"
 #include "src/gpio.h"
+#include "src/scheduler.h"
 
 #define INCLUDE_LOG_DEBUG 1
 #include "src/log.h"
 
-#define ACTUAL_CLK_FREQ       (32768/4)
-//#define ACTUAL_CLK_FREQ CMU_ClockFreqGet(cmuClock_LETIMER0)                    // frequency of the selected oscillator
-#define VALUE_TO_LOAD_COMP0 ((LETIMER_PERIOD_MS*ACTUAL_CLK_FREQ)/1000)        // 3000 ms
 #define MIN_VALUE (1)
 
+// A deadline this close is run now, COMP1 could be passed before it is set
+#define TIMER_MIN_TICKS   (1)
+
+
+// Running software timers, a min-heap on expiry
+static sw_timer_t *timer_heap[TIMER_MAX_TIMERS];
+static uint8_t     timer_count = 0;
+
+static volatile uint32_t letimer_periods = 0;      // underflows since initLETIMER0()
+static uint32_t          letimer_period_ticks;     // COMP0 + 1
+static uint32_t          letimer_period_us;        // one period in microseconds
+static uint32_t          letimer_period_ms;        // one period in milliseconds
+
+// LETIMER0 clock as the reduced fraction tick_num ticks per tick_den us,
+// plus Q32 reciprocals so the conversions below need no division
+static uint32_t          tick_num;                 // ticks per second / gcd
+static uint32_t          tick_den;                 // 1000000 / gcd
+static uint32_t          us_to_ticks_q32;          // floor(2^32 * tick_num / tick_den)
+static uint32_t          ticks_to_us_int;          // integer part of tick_den / tick_num
+static uint32_t          ticks_to_us_q32;          // fraction part of tick_den / tick_num, Q32
+
+// timerWaitUs_interrupt() delays, expire as the COMP1 event
+static sw_timer_t        wait_timer = SW_TIMER_INIT(schedulerSetEventCOMP1);
+
 
 const LETIMER_Init_TypeDef LETIMER_INIT_VALUES =
   {
@@ -46,11 +69,88 @@ const LETIMER_Init_TypeDef LETIMER_INIT_VALUES =
     0                  /* Comp0 top Value. */
   };
 
+void timerSetClock(uint32_t frequency)
+{
+  uint32_t a = frequency;
+  uint32_t b = 1000000;
+  uint32_t t;
+
+  if ((frequency == 0) || (frequency >= 1000000)) {
+      LOG_ERROR("timerSetClock() unsupported LETIMER0 frequency %u", (unsigned int) frequency);
+      return;
+  }
+
+  // greatest common divisor of frequency and 1 MHz
+  while (b != 0) {
+      t = a % b;
+      a = b;
+      b = t;
+  }
+
+  tick_num = frequency / a;
+  tick_den = 1000000 / a;
+
+  us_to_ticks_q32 = (uint32_t) (((uint64_t) tick_num << 32) / tick_den);
+  ticks_to_us_int = tick_den / tick_num;
+  ticks_to_us_q32 = (uint32_t) (((uint64_t) (tick_den % tick_num) << 32) / tick_num);
+} // timerSetClock()
+
+
+uint32_t timerUsToTicks(uint32_t us)
+{
+  uint64_t scaled = (uint64_t) us * tick_num;          // exact ticks * tick_den
+  uint32_t ticks;
+  uint64_t rem;
+
+  // the Q32 estimate is floor(exact) or one less
+  ticks = (uint32_t) (((uint64_t) us * us_to_ticks_q32) >> 32);
+  rem   = scaled - ((uint64_t) ticks * tick_den);
+
+  if (rem >= tick_den) {
+      ticks++;
+      rem -= tick_den;
+  }
+
+  // round up, a delay must never come out short
+  if (rem != 0) {
+      ticks++;
+  }
+
+  return ticks;
+} // timerUsToTicks()
+
+
+uint64_t timerTicksToUs(uint32_t ticks)
+{
+  uint64_t scaled = (uint64_t) ticks * tick_den;       // exact us * tick_num
+  uint64_t us;
+  uint64_t rem;
+
+  // the estimate is floor(exact) or one less
+  us  = ((uint64_t) ticks * ticks_to_us_int) +
+        (((uint64_t) ticks * ticks_to_us_q32) >> 32);
+  rem = scaled - (us * tick_num);
+
+  if (rem >= tick_num) {
+      us++;
+      rem -= tick_num;
+  }
+
+  // round to nearest
+  if ((2 * rem) >= tick_num) {
+      us++;
+  }
+
+  return us;
+} // timerTicksToUs()
+
+
 void initLETIMER0()
 {
   LETIMER_Init(LETIMER0, &LETIMER_INIT_VALUES);         /* Initialise LE timer with the structure passed */
 
-  LETIMER_CompareSet(LETIMER0, 0, VALUE_TO_LOAD_COMP0);   /* Load the timer period in COMP0 */
+  // Load the timer period in COMP0, the counter runs COMP0..0 so one less
+  LETIMER_CompareSet(LETIMER0, 0, timerUsToTicks(LETIMER_PERIOD_MS * 1000) - 1);
 
   LETIMER_IntClear (LETIMER0, 0xFFFFFFFF);
 
@@ -60,55 +160,283 @@ void initLETIMER0()
   // Enable LETIMER Interrupt
   LETIMER_IntEnable (LETIMER0, temp);
 
+  letimer_period_ticks = LETIMER_CompareGet(LETIMER0, 0) + 1;
+  letimer_period_us    = (uint32_t) timerTicksToUs(letimer_period_ticks);
+  letimer_period_ms    = letimer_period_us / 1000;
+
   LETIMER_Enable (LETIMER0, true);                  /* Start/Enable the timer */
 
 }
 
 
-void timerWaitUs_interrupt(uint32_t us_wait)
+// ---------------------------------------------------------------------------
+// Software timers. Everything below runs with interrupts disabled.
+// ---------------------------------------------------------------------------
+
+// wrap-safe: does a expire before b
+static bool timer_before(const sw_timer_t *a, const sw_timer_t *b)
 {
-  uint16_t current_tick, underflow_amount;
-  uint16_t time_in_us_per_tick, ticks_required;
-  uint32_t comp0_value, timerPeriodInMicroSeconds;
-  uint32_t quotient;
+  return ((int32_t) (a->expiry - b->expiry) < 0);
+}
 
-  uint32_t frequency = CMU_ClockFreqGet (cmuClock_LETIMER0); // 1000 for EM3, 8192 for EM0 to 2
+static void timer_heap_swap(uint8_t i, uint8_t j)
+{
+  sw_timer_t *temp = timer_heap[i];
 
-  // compute actual time/tick
-  if (frequency == 1000)
-    time_in_us_per_tick = 1000; // 1000us = 1ms
-  else
-    time_in_us_per_tick = 122;  // 122us = 1/8192         /* Attribution: Instructor Dave Sluiter*/
+  timer_heap[i] = timer_heap[j];
+  timer_heap[j] = temp;
+  timer_heap[i]->index = i;
+  timer_heap[j]->index = j;
+}
 
-  comp0_value = LETIMER_CompareGet (LETIMER0, 0);
-  timerPeriodInMicroSeconds = comp0_value * time_in_us_per_tick;
+static void timer_heap_sift_up(uint8_t i)
+{
+  uint8_t parent;
 
-  // range check
-  if (us_wait > timerPeriodInMicroSeconds)         /* Clamping the delay to LE timer period */
-    {
-      us_wait = (timerPeriodInMicroSeconds);
-      LOG_ERROR("Delay requested is longer than time period; Clamping delay to LE timer time period \n\r");
-    }
+  while (i > 0) {
+      parent = (i - 1) / 2;
+      if (!timer_before(timer_heap[i], timer_heap[parent])) {
+          break;
+      }
+      timer_heap_swap(i, parent);
+      i = parent;
+  }
+}
+
+static void timer_heap_sift_down(uint8_t i)
+{
+  uint8_t left, right, first;
 
-  quotient  = us_wait / time_in_us_per_tick; // in number of ticks
-  current_tick = (uint16_t) LETIMER_CounterGet(LETIMER0);
+  for (;;) {
+      left  = (2 * i) + 1;
+      right = left + 1;
+      first = i;
 
-      // non-wrap around case
-      if (current_tick > quotient){
-          ticks_required = current_tick - quotient;
+      if ((left < timer_count) && timer_before(timer_heap[left], timer_heap[first])) {
+          first = left;
       }
-      else{   // wrap-around case
-          underflow_amount = 0xFFFF - (current_tick - quotient + 1);    /* Attribution: Instructor Dave Sluiter*/
-          ticks_required = comp0_value - underflow_amount;
+      if ((right < timer_count) && timer_before(timer_heap[right], timer_heap[first])) {
+          first = right;
       }
+      if (first == i) {
+          break;
+      }
+      timer_heap_swap(i, first);
+      i = first;
+  }
+}
 
-      LETIMER_CompareSet(LETIMER0, 1, ticks_required);     /* Loading the delay period in COMP1 register*/
-      LETIMER_IntClear  (LETIMER0, LETIMER_IFC_COMP1);
+static void timer_heap_insert(sw_timer_t *timer)
+{
+  timer->index = timer_count;
+  timer_heap[timer_count++] = timer;
+  timer_heap_sift_up(timer->index);
+}
+
+static void timer_heap_remove(sw_timer_t *timer)
+{
+  uint8_t     i = timer->index;
+  sw_timer_t *moved;
+
+  timer->index = TIMER_NOT_QUEUED;
+  timer_count--;
+
+  // move the last entry into the hole, it may belong above or below it
+  if (i != timer_count) {
+      moved = timer_heap[timer_count];
+      timer_heap[i] = moved;
+      moved->index = i;
+      timer_heap_sift_down(i);
+      timer_heap_sift_up(moved->index);
+  }
+}
+
+// read the period count and the LETIMER0 counter as one consistent pair
+static void timer_sample(uint32_t *periods, uint32_t *cnt)
+{
+  *periods = letimer_periods;
+  *cnt     = LETIMER_CounterGet(LETIMER0);
+
+  // the counter reloaded but the underflow has not been serviced yet
+  if (LETIMER_IntGet(LETIMER0) & LETIMER_IF_UF) {
+      (*periods)++;
+      *cnt = LETIMER_CounterGet(LETIMER0);
+  }
+}
+
+// current absolute tick, cnt returns the LETIMER0 count it was taken from
+static uint32_t timer_now(uint32_t *cnt)
+{
+  uint32_t periods;
 
-      // DOS: Set COMP1 IEN bit, cleared in your LETIMER0_IRQHandler() if COMP1 IF bit is set.
-      LETIMER_IntEnable (LETIMER0, LETIMER_IEN_COMP1);
-      LETIMER0->IEN = LETIMER0->IEN | LETIMER_IEN_COMP1;  /* Attribution: Instructor Dave Sluiter*/
+  timer_sample(&periods, cnt);
 
+  // the counter runs down from COMP0 to 0
+  return (periods * letimer_period_ticks) + (letimer_period_ticks - 1 - *cnt);
+}
+
+// point COMP1 at the earliest deadline if it is in this period
+static void timer_reprogram(void)
+{
+  uint32_t cnt, now;
+  int32_t  delta;
+
+  if (timer_count == 0) {
+      LETIMER_IntDisable(LETIMER0, LETIMER_IEN_COMP1);
+      return;
+  }
+
+  now   = timer_now(&cnt);
+  delta = (int32_t) (timer_heap[0]->expiry - now);
+
+  if (delta <= TIMER_MIN_TICKS) {
+      // due now, take the COMP1 interrupt straight away
+      LETIMER_IntSet(LETIMER0, LETIMER_IFS_COMP1);
+      LETIMER_IntEnable(LETIMER0, LETIMER_IEN_COMP1);
+  }
+  else if ((uint32_t) delta <= cnt) {
+      LETIMER_CompareSet(LETIMER0, 1, cnt - (uint32_t) delta);
+      LETIMER_IntClear(LETIMER0, LETIMER_IFC_COMP1);
+      LETIMER_IntEnable(LETIMER0, LETIMER_IEN_COMP1);
+  }
+  else {
+      // a later period, the underflow interrupt comes back here
+      LETIMER_IntDisable(LETIMER0, LETIMER_IEN_COMP1);
+  }
+}
+
+
+uint64_t timerNowUs(void)
+{
+  uint32_t periods, cnt;
+
+  // LETIMER0 is not running yet, early log lines read 0
+  if (letimer_period_ticks == 0) {
+      return 0;
+  }
+
+  CORE_DECLARE_IRQ_STATE;
+  CORE_ENTER_CRITICAL();
+  timer_sample(&periods, &cnt);
+  CORE_EXIT_CRITICAL();
+
+  return ((uint64_t) periods * letimer_period_us) +
+         timerTicksToUs(letimer_period_ticks - 1 - cnt);
+} // timerNowUs()
+
+
+uint64_t timerNowMs(void)
+{
+  uint32_t periods, cnt;
+
+  // LETIMER0 is not running yet, early log lines read 0
+  if (letimer_period_ticks == 0) {
+      return 0;
+  }
+
+  CORE_DECLARE_IRQ_STATE;
+  CORE_ENTER_CRITICAL();
+  timer_sample(&periods, &cnt);
+  CORE_EXIT_CRITICAL();
+
+  // a 32-bit divide of the part-period, never a 64-bit one
+  return ((uint64_t) periods * letimer_period_ms) +
+         ((uint32_t) timerTicksToUs(letimer_period_ticks - 1 - cnt) / 1000);
+} // timerNowMs()
+
+
+bool timerStart(sw_timer_t *timer, uint32_t delay_us, uint32_t period_us)
+{
+  uint32_t cnt;
+  bool     full = false;
+
+  CORE_DECLARE_IRQ_STATE;
+  CORE_ENTER_CRITICAL();
+
+  if (timer->index != TIMER_NOT_QUEUED) {
+      timer_heap_remove(timer);
+  }
+
+  if (timer_count >= TIMER_MAX_TIMERS) {
+      full = true;
+  }
+  else {
+      timer->expiry = timer_now(&cnt) + timerUsToTicks(delay_us);
+      timer->period = timerUsToTicks(period_us);
+      if ((period_us != 0) && (timer->period == 0)) {
+          timer->period = 1;
+      }
+
+      timer_heap_insert(timer);
+      timer_reprogram();
+  }
+
+  CORE_EXIT_CRITICAL();
+
+  if (full) {
+      LOG_ERROR("timerStart() all %d software timers are in use", TIMER_MAX_TIMERS);
+  }
+
+  return full;
+} // timerStart()
+
+
+void timerStop(sw_timer_t *timer)
+{
+  CORE_DECLARE_IRQ_STATE;
+  CORE_ENTER_CRITICAL();
+
+  if (timer->index != TIMER_NOT_QUEUED) {
+      timer_heap_remove(timer);
+      timer_reprogram();
+  }
+
+  CORE_EXIT_CRITICAL();
+} // timerStop()
+
+
+void timerService(uint32_t flags)
+{
+  sw_timer_t *timer;
+  uint32_t    cnt, now;
+
+  if ((flags & (LETIMER_IF_UF | LETIMER_IF_COMP1)) == 0) {
+      return;
+  }
+
+  CORE_DECLARE_IRQ_STATE;
+  CORE_ENTER_CRITICAL();
+
+  if (flags & LETIMER_IF_UF) {
+      letimer_periods++;
+  }
+
+  now = timer_now(&cnt);
+
+  while ((timer_count != 0) &&
+         ((int32_t) (timer_heap[0]->expiry - now) <= TIMER_MIN_TICKS)) {
+      timer = timer_heap[0];
+      timer_heap_remove(timer);
+
+      if (timer->period != 0) {
+          timer->expiry += timer->period;
+          timer_heap_insert(timer);
+      }
+
+      timer->callback();
+  }
+
+  timer_reprogram();
+
+  CORE_EXIT_CRITICAL();
+} // timerService()
+
+
+void timerWaitUs_interrupt(uint32_t us_wait)
+{
+  // a one-shot software timer, so the delay is no longer limited to one
+  // LE timer period and other timers can run alongside it
+  (void) timerStart(&wait_timer, us_wait, 0);
 }
 
 
@@ -120,7 +448,6 @@ void timerWaitUs_interrupt(uint32_t us_wait)
 // -----------------------------------------------
 void timerWaitUs_irq (uint32_t delayInMicroSeconds) {
 
-  uint32_t       quotient, remainder;
   uint16_t       delta, new_cnt, count, underflow_amount;
   uint32_t       comp0, timerPeriodInMicroSeconds;
 //  uint32_t       temp;
@@ -131,29 +458,17 @@ void timerWaitUs_irq (uint32_t delayInMicroSeconds) {
   // check for 0/min...
   if (delayInMicroSeconds == 0) { return; } // just return if 0
 
-  uint32_t frequency = CMU_ClockFreqGet (cmuClock_LETIMER0); // 1000 for EM3, 8192 for EM0 to 2
-  uint16_t time_in_us_per_tick;
-
-  // compute actual time/tick
-  if (frequency == 1000)
-    time_in_us_per_tick = 1000; // 1000us = 1ms = 1/1000
-  else
-    time_in_us_per_tick = 122;  // 122us = 1/8192
-
   // check for max, clamp to timer period if requested delay is greater than
   // the timer period
   comp0 = LETIMER_CompareGet (LETIMER0, 0);
-  timerPeriodInMicroSeconds = comp0 * time_in_us_per_tick;
+  timerPeriodInMicroSeconds = (uint32_t) timerTicksToUs(comp0);
 
   if (delayInMicroSeconds > timerPeriodInMicroSeconds) {
     delayInMicroSeconds = timerPeriodInMicroSeconds;
     LOG_INFO ("Requested delay is > than LETIMER0 period, clqmped requested delay to %d\n", delayInMicroSeconds);
   }
 
-  quotient  = delayInMicroSeconds / time_in_us_per_tick; // in number of ticks
-  remainder = delayInMicroSeconds % time_in_us_per_tick; // in number of ticks
-
-  delta = quotient + (remainder ? 1 : 0);
+  delta = (uint16_t) timerUsToTicks(delayInMicroSeconds); // in number of ticks, rounded up
 
   count = (uint16_t) LETIMER_CounterGet (LETIMER0);
 
@@ -197,11 +512,12 @@ void timerWaitUs_irq (uint32_t delayInMicroSeconds) {
 void timerWaitUs_polled(uint32_t us_wait)
 {
   uint32_t current_tick, delay_tick;
-  uint32_t ticks_required = ((us_wait*ACTUAL_CLK_FREQ)/(1000*1000));          /* Number of ticks required*/
+  uint32_t ticks_required = timerUsToTicks(us_wait);          /* Number of ticks required*/
+  uint32_t comp0 = LETIMER_CompareGet(LETIMER0, 0);
 
-  if (ticks_required > (uint32_t)VALUE_TO_LOAD_COMP0)         /* Clamping the delay to LE timer period*/
+  if (ticks_required > comp0)         /* Clamping the delay to LE timer period*/
     {
-      ticks_required = (uint32_t)(VALUE_TO_LOAD_COMP0);
+      ticks_required = comp0;
       LOG_ERROR("Delay requested is longer than time period; Clamping delay to LE timer time period \n\r");
     }
   else if (ticks_required < (uint32_t)(MIN_VALUE))            /* Clamping the delay to LE timer resolution*/
@@ -19,6 +19,68 @@
 #ifndef SRC_TIMERS_H_
 #define SRC_TIMERS_H_
 
+#include <stdbool.h>
+#include <stdint.h>
+
+// Most software timers that can run at once
+#define TIMER_MAX_TIMERS      (8)
+
+// index of a timer that is not running
+#define TIMER_NOT_QUEUED      (0xFF)
+
+
+/*
+ * Software timers multiplexed onto the LETIMER0 COMP1 compare.
+ *
+ * Running timers are kept in a min-heap on their expiry tick. COMP1 is
+ * only programmed for the earliest one and only when it falls inside the
+ * current LETIMER0 period; later deadlines are picked up again at the
+ * underflow, so a delay may span any number of periods.
+ *
+ * Callbacks run in the LETIMER0 interrupt with interrupts disabled, keep
+ * them short, typically a schedulerSetEvent*() call.
+ */
+typedef struct {
+  void      (*callback)(void);      // run when the timer expires
+  uint32_t    expiry;               // absolute LETIMER0 tick
+  uint32_t    period;               // reload in ticks, 0 for a one-shot
+  uint8_t     index;                // heap slot, TIMER_NOT_QUEUED when stopped
+} sw_timer_t;
+
+// Static initialiser for a stopped timer
+#define SW_TIMER_INIT(callback)   { (callback), 0, 0, TIMER_NOT_QUEUED }
+
+
+/**
+* @brief Function to set up the microsecond / tick conversions for the
+*        LETIMER0 clock. Call whenever that clock changes.
+*
+*
+* @param frequency  LETIMER0 clock in Hz, below 1 MHz
+* @return void
+*/
+void timerSetClock(uint32_t frequency);
+
+/**
+* @brief Function to convert microseconds to LETIMER0 ticks, rounded up.
+*        Exact for every input and free of divisions.
+*
+*
+* @param us  time in microseconds
+* @return uint32_t  ticks
+*/
+uint32_t timerUsToTicks(uint32_t us);
+
+/**
+* @brief Function to convert LETIMER0 ticks to microseconds, rounded to
+*        nearest. Exact for every input and free of divisions.
+*
+*
+* @param ticks  time in ticks
+* @return uint64_t  microseconds
+*/
+uint64_t timerTicksToUs(uint32_t ticks);
+
 /**
 * @brief Function to initialize the Low energy timer peripheral.
 *
@@ -31,14 +93,81 @@
 void initLETIMER0();
 
 /**
-* @brief Function to create delay using LE timer and generate COMP1 interrupt
+* @brief Function to create delay using LE timer and generate COMP1 event.
+*        A new call replaces a wait that has not expired yet.
 *
 *
-* @param us_wait  delay required in microseconds
+* @param us_wait  delay required in microseconds, may be longer than the
+*                 LE timer period
 * @return void
 */
 void timerWaitUs_interrupt(uint32_t us_wait);
 
+/**
+* @brief Function to start, or restart, a software timer
+*
+*
+* @param timer      timer to start
+* @param delay_us   time to the first expiry in microseconds
+* @param period_us  time between later expiries, 0 for a one-shot
+* @return bool      false on success, true if all TIMER_MAX_TIMERS are in use
+*/
+bool timerStart(sw_timer_t *timer, uint32_t delay_us, uint32_t period_us);
+
+/**
+* @brief Function to stop a software timer, does nothing if it is not running
+*
+*
+* @param timer  timer to stop
+* @return void
+*/
+void timerStop(sw_timer_t *timer);
+
+/**
+* @brief Function to check whether a software timer is running
+*
+*
+* @param timer  timer to check
+* @return bool  true when the timer is queued
+*/
+static inline bool timerIsRunning(const sw_timer_t *timer)
+{
+  return (timer->index != TIMER_NOT_QUEUED);
+}
+
+/**
+* @brief Function to read the time since initLETIMER0(), resolution one
+*        LETIMER0 tick. Monotonic, never wraps in practice and safe to call
+*        from an ISR.
+*
+*
+* @param void
+* @return uint64_t  microseconds
+*/
+uint64_t timerNowUs(void);
+
+/**
+* @brief Function to read the time since initLETIMER0() in milliseconds,
+*        cheaper than timerNowUs() / 1000
+*
+*
+* @param void
+* @return uint64_t  milliseconds
+*/
+uint64_t timerNowMs(void);
+
+/**
+* @brief Function to run the expired software timers and program COMP1 for
+*        the next one. Called from LETIMER0_IRQHandler() in the same
+*        critical section that clears the flags, so a timestamp read never
+*        sees an underflow that is neither pending nor counted.
+*
+*
+* @param flags  LETIMER0 interrupt flags being serviced
+* @return void
+*/
+void timerService(uint32_t flags);
+
 /* Attribution: Instructor Dave Sluiter*/
 void timerWaitUs_irq (uint32_t delayInMicroSeconds);
 
@@ -0,0 +1,98 @@
+/* @file      workq.c
+ * @version   1.0
+ * @brief     Prioritised deferred work queue
+ *
+ * @author    Anuhya Kuraparthy, anuhya.kuraparthy@colorado.edu
+ * @date      Nov 03, 2023
+ *
+ * @institution University of Colorado Boulder (UCB)
+ * @course      ECEN 5823: IoT Embedded Firmware
+ * @instructor  David Sluiter
+ *
+ * @assignment Assignment 9 - BLE Client with Security
+ * @due        Nov 03
+ *
+ * @resources  -
+ */
+
+#include "em_core.h"
+#include "src/workq.h"
+
+
+// One FIFO of pending items per priority
+static workq_item_t *queue_head[WORKQ_NUM_PRIORITIES];
+static workq_item_t *queue_tail[WORKQ_NUM_PRIORITIES];
+
+
+void workq_post(workq_item_t *item)
+{
+  CORE_DECLARE_IRQ_STATE;
+  CORE_ENTER_CRITICAL();
+
+  if (!item->pending) {
+      item->pending = true;
+      item->next = NULL;
+
+      if (queue_tail[item->priority] == NULL) {
+          queue_head[item->priority] = item;
+      }
+      else {
+          queue_tail[item->priority]->next = item;
+      }
+      queue_tail[item->priority] = item;
+  }
+
+  CORE_EXIT_CRITICAL();
+} // workq_post()
+
+
+// take the highest priority item off its queue, NULL when there is none
+static workq_item_t *workq_pop(void)
+{
+  workq_item_t *item = NULL;
+
+  CORE_DECLARE_IRQ_STATE;
+  CORE_ENTER_CRITICAL();
+
+  for (uint32_t p = 0; p < WORKQ_NUM_PRIORITIES; p++) {
+      item = queue_head[p];
+      if (item == NULL) {
+          continue;
+      }
+
+      queue_head[p] = item->next;
+      if (queue_head[p] == NULL) {
+          queue_tail[p] = NULL;
+      }
+
+      // the job may post itself again while it runs
+      item->pending = false;
+      break;
+  }
+
+  CORE_EXIT_CRITICAL();
+
+  return item;
+} // workq_pop()
+
+
+void workq_run(void)
+{
+  workq_item_t *item;
+
+  while ((item = workq_pop()) != NULL) {
+      item->fn();
+  }
+} // workq_run()
+
+
+bool workq_pending(void)
+{
+  for (uint32_t p = 0; p < WORKQ_NUM_PRIORITIES; p++) {
+      if (queue_head[p] != NULL) {
+          return true;
+      }
+  }
+
+  return false;
+} // workq_pending()
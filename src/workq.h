@@ -0,0 +1,83 @@
+/* @file      workq.h
+ * @version   1.0
+ * @brief     Application interface provided for workq.c
+ *
+ * @author    Anuhya Kuraparthy, anuhya.kuraparthy@colorado.edu
+ * @date      Nov 03, 2023
+ *
+ * @institution University of Colorado Boulder (UCB)
+ * @course      ECEN 5823: IoT Embedded Firmware
+ * @instructor  David Sluiter
+ *
+ * @assignment Assignment 9 - BLE Client with Security
+ * @due        Nov 03
+ *
+ * @resources  -
+ */
+
+#ifndef SRC_WORKQ_H_
+#define SRC_WORKQ_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+
+/*
+ * Deferred work.
+ *
+ * Slow, non radio-critical jobs (LCD redraws, logging, statistics) are
+ * posted from the BT event handler or an ISR and run later from
+ * app_process_action(), highest priority first. Work items are statically
+ * allocated; posting an item that is already pending does nothing, so any
+ * number of requests made before the item runs are served by one call.
+ */
+
+typedef enum {
+  WORKQ_PRIORITY_HIGH,
+  WORKQ_PRIORITY_NORMAL,
+  WORKQ_PRIORITY_LOW,
+  WORKQ_NUM_PRIORITIES
+} workq_priority_t;
+
+typedef struct workq_item {
+  void                (*fn)(void);   // the job
+  struct workq_item    *next;        // next pending item of the same priority
+  uint8_t               priority;    // workq_priority_t
+  volatile bool         pending;     // queued and not yet started
+} workq_item_t;
+
+// Static initialiser for a work item
+#define WORKQ_ITEM_INIT(fn, priority)  { (fn), NULL, (priority), false }
+
+
+/**
+* @brief Function to queue a work item, does nothing if it is already
+*        queued. Safe to call from an ISR.
+*
+*
+* @param item  work item to run
+* @return void
+*/
+void workq_post(workq_item_t *item);
+
+/**
+* @brief Function to run every queued work item, highest priority first.
+*        Items posted while this runs are run before it returns.
+*
+*
+* @param void
+* @return void
+*/
+void workq_run(void);
+
+/**
+* @brief Function to check for queued work
+*
+*
+* @param void
+* @return bool true when at least one item is queued
+*/
+bool workq_pending(void);
+
+#endif /* SRC_WORKQ_H_ */
@@ -0,0 +1,38 @@
+/* @file      dmd_memlcd_reference.c
+ * @version   1.0
+ * @brief     The SDK's dmd_memlcd.c built a second time with
+ *            DMD_MEMLCD_REFERENCE_WRITE_DATA, the original byte at a time
+ *            DMD_writeData(), under ref_ names so it links next to the
+ *            32-bit build test_dmd_memlcd compares it with
+ *
+ * @author    Anuhya Kuraparthy, anuhya.kuraparthy@colorado.edu
+ * @date      Nov 03, 2023
+ *
+ * @institution University of Colorado Boulder (UCB)
+ * @course      ECEN 5823: IoT Embedded Firmware
+ * @instructor  David Sluiter
+ *
+ * @resources  -
+ */
+
+#define DMD_MEMLCD_REFERENCE_WRITE_DATA
+
+#define DMD_init                ref_DMD_init
+#define DMD_getDisplayGeometry  ref_DMD_getDisplayGeometry
+#define DMD_setClippingArea     ref_DMD_setClippingArea
+#define DMD_writeData           ref_DMD_writeData
+#define DMD_readData            ref_DMD_readData
+#define DMD_writeColor          ref_DMD_writeColor
+#define DMD_writeColorMask      ref_DMD_writeColorMask
+#define DMD_sleep               ref_DMD_sleep
+#define DMD_wakeUp              ref_DMD_wakeUp
+#define DMD_flipDisplay         ref_DMD_flipDisplay
+#define DMD_freeFramebuffer     ref_DMD_freeFramebuffer
+#define DMD_selectFramebuffer   ref_DMD_selectFramebuffer
+#define DMD_updateDisplay       ref_DMD_updateDisplay
+#define DMD_updateDisplayAsync  ref_DMD_updateDisplayAsync
+#define DMD_getFrameBuffer      ref_DMD_getFrameBuffer
+
+#include "dmd_memlcd_reference.h"
+
+#include "dmd_memlcd.c"
@@ -0,0 +1,28 @@
+/* @file      dmd_memlcd_reference.h
+ * @version   1.0
+ * @brief     The reference build of dmd_memlcd.c, see dmd_memlcd_reference.c
+ *
+ * @author    Anuhya Kuraparthy, anuhya.kuraparthy@colorado.edu
+ * @date      Nov 03, 2023
+ *
+ * @institution University of Colorado Boulder (UCB)
+ * @course      ECEN 5823: IoT Embedded Firmware
+ * @instructor  David Sluiter
+ *
+ * @resources  -
+ */
+
+#ifndef TESTS_DMD_MEMLCD_REFERENCE_H_
+#define TESTS_DMD_MEMLCD_REFERENCE_H_
+
+#include <stdint.h>
+
+#include "dmd.h"
+
+// same as the DMD_ functions of the same name, on their own frame buffer
+EMSTATUS ref_DMD_init(DMD_InitConfig *initConfig);
+EMSTATUS ref_DMD_setClippingArea(uint16_t xStart, uint16_t yStart, uint16_t width, uint16_t height);
+EMSTATUS ref_DMD_writeData(uint16_t x, uint16_t y, const uint8_t data[], uint32_t numPixels);
+EMSTATUS ref_DMD_getFrameBuffer(void **fb);
+
+#endif /* TESTS_DMD_MEMLCD_REFERENCE_H_ */
@@ -0,0 +1,817 @@
+/* @file      hw_fake.c
+ * @version   1.0
+ * @brief     Host model of LETIMER0, I2C0 + Si7021, USART1, GPIO, CMU, the NVIC,
+ *            CORE critical sections and the power manager
+ *
+ * @author    Anuhya Kuraparthy, anuhya.kuraparthy@colorado.edu
+ * @date      Nov 03, 2023
+ *
+ * @institution University of Colorado Boulder (UCB)
+ * @course      ECEN 5823: IoT Embedded Firmware
+ * @instructor  David Sluiter
+ *
+ * @resources  -
+ */
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "em_common.h"
+#include "em_cmu.h"
+#include "em_core.h"
+#include "em_gpio.h"
+#include "em_i2c.h"
+#include "em_letimer.h"
+#include "sl_i2cspm.h"
+#include "sl_power_manager.h"
+#include "sl_status.h"
+#include "app_log.h"
+
+#include "hw_fake.h"
+
+#define SI7021_ADDR               (0x40)
+#define SI7021_CMD_MEASURE_RH     (0xF5)
+#define SI7021_CMD_MEASURE_T      (0xF3)
+#define SI7021_CMD_READ_T_FROM_RH (0xE0)
+#define SI7021_CMD_WRITE_USER_REG (0xE6)
+
+// Datasheet maximum for a 12 bit RH plus 14 bit temperature measurement
+#define SI7021_CONVERSION_US      (12000 + 10800)
+
+// Handlers that keep their interrupt asserted this often in a row never return
+#define IRQ_STORM_LIMIT           (100000)
+
+
+LETIMER_TypeDef   fake_letimer0;
+I2C_TypeDef       fake_i2c0;
+CoreDebug_Type    fake_core_debug;
+fake_si7021_t     fake_si7021;
+fake_power_t      fake_power;
+uint32_t          fake_irq_count[FAKE_NUM_IRQn];
+bool              fake_log_enable = false;
+
+fake_letimer_read_hook_t  fake_letimer_read_hook;
+
+static uint64_t   now_us;
+
+// interrupts
+static bool       nvic_enabled[FAKE_NUM_IRQn];
+static uint32_t   critical_depth;
+static bool       in_isr;
+
+// LETIMER0 ticks since it was enabled, and when that was
+static uint64_t   letimer_ticks;
+static uint64_t   letimer_start_us;
+
+// CMU
+static bool                 lfa_enabled;
+static CMU_Select_TypeDef   lfa_select;
+static uint32_t             letimer_div;
+
+// I2C0
+static I2C_TransferSeq_TypeDef *i2c_seq;
+static uint64_t                 i2c_done_us;
+static bool                     i2c_irq_line;
+
+// USART1 SPI transmit, for the memory LCD
+static uint64_t   usart1_done_us;
+static bool       usart1_tx_line;
+
+// Si7021 measurement in progress, 0 when none
+static uint8_t    si7021_measuring;
+static uint64_t   si7021_ready_us;
+static bool       si7021_t_from_rh;
+
+// GPIO
+static uint16_t           gpio_out[FAKE_NUM_GPIO_PORTS];
+static uint16_t           gpio_in[FAKE_NUM_GPIO_PORTS];
+static GPIO_Port_TypeDef  gpio_int_port[16];
+static uint16_t           gpio_int_rising;
+static uint16_t           gpio_int_falling;
+static uint32_t           gpio_ien;
+static uint32_t           gpio_if;
+
+
+// Vector table defaults, the application overrides the ones it uses
+SL_WEAK void LETIMER0_IRQHandler(void) {}
+SL_WEAK void I2C0_IRQHandler(void) {}
+SL_WEAK void GPIO_EVEN_IRQHandler(void) {}
+SL_WEAK void GPIO_ODD_IRQHandler(void) {}
+SL_WEAK void USART1_TX_IRQHandler(void) {}
+
+// irq.c provides this in the application, unit tests log virtual time
+SL_WEAK uint32_t letimerMilliseconds(void)
+{
+  return (uint32_t) (now_us / 1000);
+}
+
+
+// ---------------------------------------------------------------------------
+// Virtual clock and interrupts
+// ---------------------------------------------------------------------------
+
+static void clock_to(uint64_t us)
+{
+  if (fake_power.em1_requirements > 0) {
+      fake_power.em1_us += us - now_us;
+  }
+  now_us = us;
+}
+
+uint64_t fake_now_us(void)
+{
+  return now_us;
+}
+
+static bool irq_line(IRQn_Type irq)
+{
+  switch (irq) {
+    case LETIMER0_IRQn:
+      return (fake_letimer0.IF & fake_letimer0.IEN) != 0;
+    case I2C0_IRQn:
+      return i2c_irq_line;
+    case GPIO_EVEN_IRQn:
+      return (gpio_if & gpio_ien & 0x5555) != 0;
+    case GPIO_ODD_IRQn:
+      return (gpio_if & gpio_ien & 0xAAAA) != 0;
+    case USART1_TX_IRQn:
+      return usart1_tx_line;
+    default:
+      return false;
+  }
+}
+
+static void irq_call(IRQn_Type irq)
+{
+  switch (irq) {
+    case LETIMER0_IRQn:   LETIMER0_IRQHandler();  break;
+    case I2C0_IRQn:       I2C0_IRQHandler();      break;
+    case GPIO_EVEN_IRQn:  GPIO_EVEN_IRQHandler(); break;
+    case GPIO_ODD_IRQn:   GPIO_ODD_IRQHandler();  break;
+    case USART1_TX_IRQn:  USART1_TX_IRQHandler(); break;
+    default:                                      break;
+  }
+}
+
+// take every asserted, enabled interrupt, lowest number first
+static void irq_dispatch(void)
+{
+  uint32_t storm = 0;
+  bool     taken;
+
+  if ((critical_depth != 0) || in_isr) {
+      return;
+  }
+
+  do {
+      taken = false;
+      for (int irq = 0; irq < FAKE_NUM_IRQn; irq++) {
+          if (nvic_enabled[irq] && irq_line((IRQn_Type) irq)) {
+              if (++storm > IRQ_STORM_LIMIT) {
+                  fprintf(stderr, "IRQ %d is never cleared by its handler\n", irq);
+                  abort();
+              }
+              in_isr = true;
+              fake_irq_count[irq]++;
+              irq_call((IRQn_Type) irq);
+              in_isr = false;
+              taken = true;
+              break;
+          }
+      }
+  } while (taken);
+}
+
+bool fake_irq_enabled(IRQn_Type irq)
+{
+  return nvic_enabled[irq];
+}
+
+bool fake_in_critical(void)
+{
+  return (critical_depth != 0) || in_isr;
+}
+
+void NVIC_EnableIRQ(IRQn_Type irq)
+{
+  nvic_enabled[irq] = true;
+  irq_dispatch();
+}
+
+void NVIC_DisableIRQ(IRQn_Type irq)
+{
+  nvic_enabled[irq] = false;
+}
+
+void NVIC_ClearPendingIRQ(IRQn_Type irq)
+{
+  (void) irq;
+}
+
+CORE_irqState_t CORE_EnterCritical(void)
+{
+  critical_depth++;
+  return 0;
+}
+
+void CORE_ExitCritical(CORE_irqState_t irqState)
+{
+  (void) irqState;
+
+  if (critical_depth == 0) {
+      fprintf(stderr, "CORE_ExitCritical() without CORE_EnterCritical()\n");
+      abort();
+  }
+  if (--critical_depth == 0) {
+      irq_dispatch();
+  }
+}
+
+DWT_Type *fake_dwt(void)
+{
+  static DWT_Type dwt;
+  struct timespec ts;
+
+  // one "cycle" per host nanosecond
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  dwt.CYCCNT = (uint32_t) ((uint64_t) ts.tv_sec * 1000000000u + (uint64_t) ts.tv_nsec);
+
+  return &dwt;
+}
+
+
+// ---------------------------------------------------------------------------
+// CMU
+// ---------------------------------------------------------------------------
+
+void CMU_OscillatorEnable(CMU_Osc_TypeDef osc, bool enable, bool wait)
+{
+  (void) osc;
+  (void) enable;
+  (void) wait;
+}
+
+void CMU_ClockSelectSet(CMU_Clock_TypeDef clock, CMU_Select_TypeDef ref)
+{
+  if (clock == cmuClock_LFA) {
+      lfa_select = ref;
+      lfa_enabled = true;
+  }
+}
+
+void CMU_ClockDivSet(CMU_Clock_TypeDef clock, CMU_ClkDiv_TypeDef div)
+{
+  if (clock == cmuClock_LETIMER0) {
+      letimer_div = div;
+  }
+}
+
+void CMU_ClockEnable(CMU_Clock_TypeDef clock, bool enable)
+{
+  (void) clock;
+  (void) enable;
+}
+
+uint32_t CMU_ClockFreqGet(CMU_Clock_TypeDef clock)
+{
+  uint32_t lfa;
+
+  if (!lfa_enabled) {
+      return 0;
+  }
+
+  lfa = (lfa_select == cmuSelect_LFXO) ? 32768 : 1000;
+
+  return (clock == cmuClock_LETIMER0) ? (lfa / letimer_div) : lfa;
+}
+
+uint32_t fake_letimer_clock(void)
+{
+  return CMU_ClockFreqGet(cmuClock_LETIMER0);
+}
+
+
+// ---------------------------------------------------------------------------
+// LETIMER0: CNT counts COMP0..0, reloads COMP0 on underflow and sets UF,
+// sets COMP1 when it reaches COMP1
+// ---------------------------------------------------------------------------
+
+// virtual time of LETIMER0 tick number tick, the first tick after enable is 1
+static uint64_t letimer_tick_us(uint64_t tick)
+{
+  uint64_t freq = fake_letimer_clock();
+
+  return letimer_start_us + ((tick * 1000000u) + freq - 1) / freq;
+}
+
+// ticks from now until the next flag is set
+static uint32_t letimer_ticks_to_flag(void)
+{
+  uint32_t to_flag = fake_letimer0.CNT + 1;
+
+  if (fake_letimer0.COMP1 <= fake_letimer0.COMP0) {
+      uint32_t to_comp1;
+
+      if (fake_letimer0.COMP1 < fake_letimer0.CNT) {
+          to_comp1 = fake_letimer0.CNT - fake_letimer0.COMP1;
+      }
+      else {
+          to_comp1 = fake_letimer0.CNT + 1 + (fake_letimer0.COMP0 - fake_letimer0.COMP1);
+      }
+      if (to_comp1 < to_flag) {
+          to_flag = to_comp1;
+      }
+  }
+
+  return to_flag;
+}
+
+// count down n ticks, n never passes more than one flag
+static void letimer_count(uint32_t n)
+{
+  letimer_ticks += n;
+
+  if (n > fake_letimer0.CNT) {
+      fake_letimer0.CNT = fake_letimer0.COMP0 - (n - fake_letimer0.CNT - 1);
+      fake_letimer0.IF |= LETIMER_IF_UF;
+  }
+  else {
+      fake_letimer0.CNT -= n;
+  }
+
+  if ((n != 0) && (fake_letimer0.CNT == fake_letimer0.COMP1)) {
+      fake_letimer0.IF |= LETIMER_IF_COMP1;
+  }
+}
+
+static uint64_t letimer_next_flag_us(void)
+{
+  if (!fake_letimer0.running || (fake_letimer_clock() == 0)) {
+      return FAKE_NEVER;
+  }
+
+  return letimer_tick_us(letimer_ticks + letimer_ticks_to_flag());
+}
+
+void LETIMER_Init(LETIMER_TypeDef *letimer, const LETIMER_Init_TypeDef *init)
+{
+  letimer->running = false;
+  letimer->COMP0 = init->topValue;
+  if (init->enable) {
+      LETIMER_Enable(letimer, true);
+  }
+}
+
+void LETIMER_Enable(LETIMER_TypeDef *letimer, bool enable)
+{
+  if (enable && !letimer->running) {
+      letimer_ticks = 0;
+      letimer_start_us = now_us;
+  }
+  letimer->running = enable;
+}
+
+void LETIMER_CompareSet(LETIMER_TypeDef *letimer, unsigned int comp, uint32_t value)
+{
+  if (comp == 0) {
+      letimer->COMP0 = value & 0xFFFF;
+  }
+  else {
+      letimer->COMP1 = value & 0xFFFF;
+  }
+}
+
+uint32_t LETIMER_CompareGet(LETIMER_TypeDef *letimer, unsigned int comp)
+{
+  return (comp == 0) ? letimer->COMP0 : letimer->COMP1;
+}
+
+uint32_t LETIMER_CounterGet(LETIMER_TypeDef *letimer)
+{
+  if (fake_letimer_read_hook != NULL) {
+      fake_letimer_read_hook();
+  }
+
+  return letimer->CNT;
+}
+
+void LETIMER_IntClear(LETIMER_TypeDef *letimer, uint32_t flags)
+{
+  letimer->IF &= ~flags;
+}
+
+void LETIMER_IntDisable(LETIMER_TypeDef *letimer, uint32_t flags)
+{
+  letimer->IEN &= ~flags;
+}
+
+void LETIMER_IntEnable(LETIMER_TypeDef *letimer, uint32_t flags)
+{
+  letimer->IEN |= flags;
+  irq_dispatch();
+}
+
+uint32_t LETIMER_IntGet(LETIMER_TypeDef *letimer)
+{
+  if (fake_letimer_read_hook != NULL) {
+      fake_letimer_read_hook();
+  }
+
+  return letimer->IF;
+}
+
+uint32_t LETIMER_IntGetEnabled(LETIMER_TypeDef *letimer)
+{
+  return letimer->IF & letimer->IEN;
+}
+
+void LETIMER_IntSet(LETIMER_TypeDef *letimer, uint32_t flags)
+{
+  letimer->IF |= flags;
+  irq_dispatch();
+}
+
+
+// ---------------------------------------------------------------------------
+// I2C0 and the Si7021
+// ---------------------------------------------------------------------------
+
+void I2CSPM_Init(I2CSPM_Init_TypeDef *init)
+{
+  (void) init;
+}
+
+// 9 bits per byte at 93 kHz plus start and stop
+static uint64_t i2c_duration_us(const I2C_TransferSeq_TypeDef *seq)
+{
+  uint32_t bytes = 1 + seq->buf[0].len;
+
+  if (seq->flags & (I2C_FLAG_WRITE_READ | I2C_FLAG_WRITE_WRITE)) {
+      bytes += 1 + seq->buf[1].len;
+  }
+
+  return ((uint64_t) ((bytes * 9) + 2) * 1000000u) / I2C_FREQ_STANDARD_MAX + 1;
+}
+
+static void si7021_put(uint8_t *data, uint16_t len, uint16_t code)
+{
+  if (len > 0) {
+      data[0] = (uint8_t) (code >> 8);
+  }
+  if (len > 1) {
+      data[1] = (uint8_t) code;
+  }
+}
+
+static void si7021_command(const uint8_t *data, uint16_t len)
+{
+  if (len == 0) {
+      return;
+  }
+
+  switch (data[0]) {
+    case SI7021_CMD_MEASURE_RH:
+    case SI7021_CMD_MEASURE_T:
+      si7021_measuring = data[0];
+      si7021_ready_us = now_us + fake_si7021.conversion_us;
+      fake_si7021.measurements++;
+      break;
+    case SI7021_CMD_WRITE_USER_REG:
+      if (len > 1) {
+          fake_si7021.user_reg = data[1];
+      }
+      break;
+    default:
+      break;
+  }
+}
+
+// run one transfer against the Si7021
+static I2C_TransferReturn_TypeDef si7021_transfer(I2C_TransferSeq_TypeDef *seq)
+{
+  fake_si7021.transfers++;
+
+  if ((seq->addr >> 1) != SI7021_ADDR) {
+      fake_si7021.nacks++;
+      return i2cTransferNack;
+  }
+
+  if (fake_si7021.nack_next != 0) {
+      fake_si7021.nack_next--;
+      fake_si7021.nacks++;
+      return i2cTransferNack;
+  }
+
+  if (seq->flags & I2C_FLAG_WRITE) {
+      si7021_command(seq->buf[0].data, seq->buf[0].len);
+  }
+  else if (seq->flags & I2C_FLAG_READ) {
+      // no hold master mode: the address is NACKed until the result is ready
+      if ((si7021_measuring == 0) || (now_us < si7021_ready_us)) {
+          fake_si7021.nacks++;
+          return i2cTransferNack;
+      }
+      si7021_put(seq->buf[0].data, seq->buf[0].len,
+                 (si7021_measuring == SI7021_CMD_MEASURE_RH) ? fake_si7021.rh_code : fake_si7021.temp_code);
+      si7021_t_from_rh = (si7021_measuring == SI7021_CMD_MEASURE_RH);
+      si7021_measuring = 0;
+  }
+  else if (seq->flags & I2C_FLAG_WRITE_READ) {
+      if ((seq->buf[0].len == 0) ||
+          (seq->buf[0].data[0] != SI7021_CMD_READ_T_FROM_RH) ||
+          !si7021_t_from_rh) {
+          fake_si7021.nacks++;
+          return i2cTransferNack;
+      }
+      si7021_put(seq->buf[1].data, seq->buf[1].len, fake_si7021.temp_code);
+  }
+
+  return i2cTransferDone;
+}
+
+I2C_TransferReturn_TypeDef I2C_TransferInit(I2C_TypeDef *i2c, I2C_TransferSeq_TypeDef *seq)
+{
+  (void) i2c;
+
+  if (i2c_seq != NULL) {
+      return i2cTransferUsageFault;
+  }
+
+  i2c_seq = seq;
+  i2c_done_us = now_us + i2c_duration_us(seq);
+  i2c_irq_line = false;
+
+  return i2cTransferInProgress;
+}
+
+I2C_TransferReturn_TypeDef I2C_Transfer(I2C_TypeDef *i2c)
+{
+  I2C_TransferSeq_TypeDef *seq = i2c_seq;
+
+  (void) i2c;
+
+  if ((seq == NULL) || !i2c_irq_line) {
+      return (seq == NULL) ? i2cTransferUsageFault : i2cTransferInProgress;
+  }
+
+  i2c_irq_line = false;
+  i2c_seq = NULL;
+
+  return si7021_transfer(seq);
+}
+
+
+// ---------------------------------------------------------------------------
+// USART1
+// ---------------------------------------------------------------------------
+
+void fake_usart1_tx(uint32_t bytes, uint32_t bit_rate)
+{
+  usart1_done_us = now_us + (((uint64_t) bytes * 8 * 1000000u) + bit_rate - 1) / bit_rate;
+  usart1_tx_line = false;
+}
+
+void fake_usart1_tx_ack(void)
+{
+  usart1_tx_line = false;
+}
+
+
+// ---------------------------------------------------------------------------
+// GPIO
+// ---------------------------------------------------------------------------
+
+void GPIO_DriveStrengthSet(GPIO_Port_TypeDef port, GPIO_DriveStrength_TypeDef strength)
+{
+  (void) port;
+  (void) strength;
+}
+
+void GPIO_PinModeSet(GPIO_Port_TypeDef port, unsigned int pin, GPIO_Mode_TypeDef mode, unsigned int out)
+{
+  (void) mode;
+
+  if (out) {
+      gpio_out[port] |= (uint16_t) (1u << pin);
+  }
+  else {
+      gpio_out[port] &= (uint16_t) ~(1u << pin);
+  }
+}
+
+void GPIO_ExtIntConfig(GPIO_Port_TypeDef port, unsigned int pin, unsigned int intNo,
+                       bool risingEdge, bool fallingEdge, bool enable)
+{
+  (void) pin;
+
+  gpio_int_port[intNo] = port;
+  gpio_int_rising  = (uint16_t) ((gpio_int_rising  & ~(1u << intNo)) | ((risingEdge  ? 1u : 0u) << intNo));
+  gpio_int_falling = (uint16_t) ((gpio_int_falling & ~(1u << intNo)) | ((fallingEdge ? 1u : 0u) << intNo));
+  gpio_if &= ~(1u << intNo);
+  gpio_ien = (gpio_ien & ~(1u << intNo)) | ((enable ? 1u : 0u) << intNo);
+}
+
+void GPIO_PinOutSet(GPIO_Port_TypeDef port, unsigned int pin)
+{
+  gpio_out[port] |= (uint16_t) (1u << pin);
+}
+
+void GPIO_PinOutClear(GPIO_Port_TypeDef port, unsigned int pin)
+{
+  gpio_out[port] &= (uint16_t) ~(1u << pin);
+}
+
+unsigned int GPIO_PinInGet(GPIO_Port_TypeDef port, unsigned int pin)
+{
+  return (gpio_in[port] >> pin) & 1u;
+}
+
+uint32_t GPIO_IntGetEnabled(void)
+{
+  return gpio_if & gpio_ien;
+}
+
+void GPIO_IntClear(uint32_t flags)
+{
+  gpio_if &= ~flags;
+}
+
+bool fake_gpio_out(GPIO_Port_TypeDef port, unsigned int pin)
+{
+  return ((gpio_out[port] >> pin) & 1u) != 0;
+}
+
+void fake_gpio_button(GPIO_Port_TypeDef port, unsigned int pin, bool pressed)
+{
+  uint16_t bit = (uint16_t) (1u << pin);
+  bool     was_high = (gpio_in[port] & bit) != 0;
+
+  if (pressed == !was_high) {
+      return;
+  }
+
+  if (pressed) {
+      gpio_in[port] &= (uint16_t) ~bit;
+  }
+  else {
+      gpio_in[port] |= bit;
+  }
+
+  if ((gpio_int_port[pin] == port) &&
+      ((pressed && (gpio_int_falling & bit)) || (!pressed && (gpio_int_rising & bit)))) {
+      gpio_if |= bit;
+      irq_dispatch();
+  }
+}
+
+
+// ---------------------------------------------------------------------------
+// Power manager
+// ---------------------------------------------------------------------------
+
+void sl_power_manager_add_em_requirement(sl_power_manager_em_t em)
+{
+  if (em == SL_POWER_MANAGER_EM1) {
+      fake_power.em1_requirements++;
+  }
+  else if (em == SL_POWER_MANAGER_EM2) {
+      fake_power.em2_requirements++;
+  }
+}
+
+void sl_power_manager_remove_em_requirement(sl_power_manager_em_t em)
+{
+  int32_t *count = (em == SL_POWER_MANAGER_EM1) ? &fake_power.em1_requirements :
+                                                  &fake_power.em2_requirements;
+
+  if (*count == 0) {
+      fake_power.underflows++;
+      return;
+  }
+  (*count)--;
+}
+
+
+// ---------------------------------------------------------------------------
+// Logging and status strings
+// ---------------------------------------------------------------------------
+
+int fake_app_log(const char *format, ...)
+{
+  va_list va;
+  int     len = 0;
+
+  if (fake_log_enable) {
+      va_start(va, format);
+      len = vprintf(format, va);
+      va_end(va);
+  }
+
+  return len;
+}
+
+int32_t sl_status_get_string_n(sl_status_t status, char *buffer, uint32_t buffer_length)
+{
+  return snprintf(buffer, buffer_length, "SL_STATUS 0x%04x", (unsigned int) status);
+}
+
+
+// ---------------------------------------------------------------------------
+// Time
+// ---------------------------------------------------------------------------
+
+uint64_t fake_hw_next_event_us(void)
+{
+  uint64_t next = letimer_next_flag_us();
+
+  if (i2c_done_us < next) {
+      next = i2c_done_us;
+  }
+  if (usart1_done_us < next) {
+      next = usart1_done_us;
+  }
+
+  return next;
+}
+
+void fake_hw_advance_to(uint64_t us)
+{
+  uint64_t flag_us, reached;
+
+  for (;;) {
+      flag_us = letimer_next_flag_us();
+
+      if ((i2c_done_us <= us) && (i2c_done_us <= flag_us)) {
+          clock_to(i2c_done_us);
+          i2c_done_us = FAKE_NEVER;
+          i2c_irq_line = true;
+          irq_dispatch();
+          continue;
+      }
+
+      if ((usart1_done_us <= us) && (usart1_done_us <= flag_us)) {
+          clock_to(usart1_done_us);
+          usart1_done_us = FAKE_NEVER;
+          usart1_tx_line = true;
+          irq_dispatch();
+          continue;
+      }
+
+      if (flag_us > us) {
+          break;
+      }
+
+      clock_to(flag_us);
+      letimer_count(letimer_ticks_to_flag());
+      irq_dispatch();
+  }
+
+  // part of the way to the next flag
+  if (fake_letimer0.running && (fake_letimer_clock() != 0)) {
+      reached = ((us - letimer_start_us) * fake_letimer_clock()) / 1000000u;
+      if (reached > letimer_ticks) {
+          letimer_count((uint32_t) (reached - letimer_ticks));
+      }
+  }
+
+  clock_to(us);
+}
+
+void fake_hw_reset(void)
+{
+  now_us = 0;
+  memset(&fake_letimer0, 0, sizeof(fake_letimer0));
+  memset(&fake_si7021, 0, sizeof(fake_si7021));
+  memset(&fake_power, 0, sizeof(fake_power));
+  memset(fake_irq_count, 0, sizeof(fake_irq_count));
+  memset(nvic_enabled, 0, sizeof(nvic_enabled));
+  fake_letimer_read_hook = NULL;
+  critical_depth = 0;
+  in_isr = false;
+  letimer_ticks = 0;
+  letimer_start_us = 0;
+  lfa_enabled = false;
+  letimer_div = 1;
+  i2c_seq = NULL;
+  i2c_done_us = FAKE_NEVER;
+  i2c_irq_line = false;
+  usart1_done_us = FAKE_NEVER;
+  usart1_tx_line = false;
+  si7021_measuring = 0;
+  si7021_t_from_rh = false;
+  memset(gpio_out, 0, sizeof(gpio_out));
+  memset(gpio_in, 0xFF, sizeof(gpio_in));
+  gpio_int_rising = 0;
+  gpio_int_falling = 0;
+  gpio_ien = 0;
+  gpio_if = 0;
+
+  // 25.0 C and 50.0 %RH
+  fake_si7021.temp_code = 26797;
+  fake_si7021.rh_code = 29360;
+  fake_si7021.user_reg = 0x3A;
+  fake_si7021.conversion_us = SI7021_CONVERSION_US;
+}
@@ -0,0 +1,190 @@
+/* @file      hw_fake.h
+ * @version   1.0
+ * @brief     Host model of the EFR32BG13P peripherals the application
+ *            drives: a virtual clock, LETIMER0, I2C0 with a Si7021 on it,
+ *            GPIO, the NVIC and the power manager
+ *
+ * @author    Anuhya Kuraparthy, anuhya.kuraparthy@colorado.edu
+ * @date      Nov 03, 2023
+ *
+ * @institution University of Colorado Boulder (UCB)
+ * @course      ECEN 5823: IoT Embedded Firmware
+ * @instructor  David Sluiter
+ *
+ * @resources  -
+ */
+
+#ifndef TESTS_FAKES_HW_FAKE_H_
+#define TESTS_FAKES_HW_FAKE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "em_device.h"
+#include "em_gpio.h"
+#include "em_i2c.h"
+
+#define FAKE_NEVER      (UINT64_MAX)
+
+
+/*
+ * Virtual time. Nothing moves until the test advances it; interrupts are
+ * taken at the instant their flag is raised unless a critical section or
+ * the NVIC holds them off.
+ */
+
+/**
+* @brief Function to read the virtual clock
+*
+*
+* @param void
+* @return uint64_t  microseconds since fake_hw_reset()
+*/
+uint64_t fake_now_us(void);
+
+/**
+* @brief Function to find when the next peripheral interrupt flag is due
+*
+*
+* @param void
+* @return uint64_t  time in us, FAKE_NEVER if nothing is scheduled
+*/
+uint64_t fake_hw_next_event_us(void);
+
+/**
+* @brief Function to run the peripherals up to a point in time, taking
+*        every interrupt that falls due on the way
+*
+*
+* @param us  absolute time, not before fake_now_us()
+* @return void
+*/
+void fake_hw_advance_to(uint64_t us);
+
+/**
+* @brief Function to put every peripheral back to its reset state and the
+*        clock back to 0
+*
+*
+* @param void
+* @return void
+*/
+void fake_hw_reset(void);
+
+
+/*
+ * Interrupts
+ */
+
+// interrupts taken, per IRQ
+extern uint32_t fake_irq_count[FAKE_NUM_IRQn];
+
+bool fake_irq_enabled(IRQn_Type irq);
+bool fake_in_critical(void);
+
+
+/*
+ * Si7021 on I2C0
+ */
+
+typedef struct {
+  uint16_t  temp_code;          // returned by 0xE0 and 0xF3 reads
+  uint16_t  rh_code;            // returned by the read after 0xF5
+  uint8_t   user_reg;           // written by 0xE6
+  uint32_t  conversion_us;      // a read sooner than this after a measure is NACKed
+  uint32_t  nack_next;          // NACK this many transfers from now on
+  uint32_t  transfers;          // transfers completed, NACKed ones too
+  uint32_t  nacks;              // transfers NACKed
+  uint32_t  measurements;       // measure commands received
+} fake_si7021_t;
+
+extern fake_si7021_t fake_si7021;
+
+
+/*
+ * GPIO
+ */
+
+/**
+* @brief Function to read back an output pin
+*
+*
+* @param port  GPIO port
+* @param pin   pin number
+* @return bool pin level
+*/
+bool fake_gpio_out(GPIO_Port_TypeDef port, unsigned int pin);
+
+/**
+* @brief Function to press or release a push button, raises the pin's
+*        external interrupt if it is configured
+*
+*
+* @param port     GPIO port
+* @param pin      pin number
+* @param pressed  true drives the pin low
+* @return void
+*/
+void fake_gpio_button(GPIO_Port_TypeDef port, unsigned int pin, bool pressed);
+
+
+/*
+ * USART1, the memory LCD SPI
+ */
+
+/**
+* @brief Function to start a transmit, USART1_TX_IRQn is raised when the
+*        last bit is out and stays raised until fake_usart1_tx_ack()
+*
+*
+* @param bytes     bytes to send
+* @param bit_rate  SPI clock in Hz
+* @return void
+*/
+void fake_usart1_tx(uint32_t bytes, uint32_t bit_rate);
+
+/**
+* @brief Function to clear the USART1 TX interrupt, call from its handler
+*
+*
+* @param void
+* @return void
+*/
+void fake_usart1_tx_ack(void);
+
+
+/*
+ * Power manager
+ */
+
+typedef struct {
+  int32_t   em1_requirements;   // outstanding EM1 requirements
+  int32_t   em2_requirements;   // outstanding EM2 requirements
+  uint64_t  em1_us;             // virtual time spent with EM1 required
+  uint32_t  underflows;         // removals without a matching add
+} fake_power_t;
+
+extern fake_power_t fake_power;
+
+
+/*
+ * LETIMER0
+ */
+
+/**
+* @brief Function to read the LETIMER0 input clock CMU was set up for
+*
+*
+* @param void
+* @return uint32_t  Hz, 0 before oscillator_init()
+*/
+uint32_t fake_letimer_clock(void);
+
+// Called on every LETIMER_CounterGet() and LETIMER_IntGet() before the
+// register is read, NULL when not set. A hook that moves the clock on
+// models the counter running between two reads in a critical section.
+typedef void (*fake_letimer_read_hook_t)(void);
+
+extern fake_letimer_read_hook_t fake_letimer_read_hook;
+
+#endif /* TESTS_FAKES_HW_FAKE_H_ */
@@ -0,0 +1,222 @@
+/* @file      memlcd_fake.c
+ * @version   1.0
+ * @brief     Host stand-in for the Sharp memory LCD driver, see memlcd_fake.h
+ *
+ * @author    Anuhya Kuraparthy, anuhya.kuraparthy@colorado.edu
+ * @date      Nov 03, 2023
+ *
+ * @institution University of Colorado Boulder (UCB)
+ * @course      ECEN 5823: IoT Embedded Firmware
+ * @instructor  David Sluiter
+ *
+ * @resources  -
+ */
+
+#include <string.h>
+
+#include "em_device.h"
+#include "sl_memlcd.h"
+#include "sl_memlcd_display.h"
+
+#include "hw_fake.h"
+#include "memlcd_fake.h"
+
+// update command and first address in front, two trailing dummy bytes
+#define FRAME_OVERHEAD      (2 + 2)
+// each further row ends the previous one and carries its own address
+#define ROW_OVERHEAD        (2)
+
+#define ROW_MASK_WORDS      ((FAKE_MEMLCD_HEIGHT + 31) / 32)
+
+fake_memlcd_stats_t fake_memlcd_stats;
+uint8_t             fake_memlcd_panel[FAKE_MEMLCD_HEIGHT][FAKE_MEMLCD_ROW_BYTES];
+
+static sl_memlcd_t memlcd = {
+  .width         = SL_MEMLCD_DISPLAY_WIDTH,
+  .height        = SL_MEMLCD_DISPLAY_HEIGHT,
+  .bpp           = SL_MEMLCD_DISPLAY_BPP,
+  .spi_freq      = SL_MEMLCD_SCLK_FREQ,
+  .extcomin_freq = SL_MEMLCD_EXTCOMIN_FREQUENCY,
+  .setup_us      = SL_MEMLCD_SCS_SETUP_US,
+  .hold_us       = SL_MEMLCD_SCS_HOLD_US,
+};
+
+// async frame on the wire
+static bool                  async_busy;
+static const uint8_t        *async_data;
+static uint32_t              async_mask[ROW_MASK_WORDS];
+static sl_memlcd_callback_t  async_callback;
+
+
+static bool row_selected(const uint32_t *row_mask, unsigned int row)
+{
+  return (row_mask[row >> 5] & (1UL << (row & 0x1f))) != 0;
+}
+
+static uint32_t frame_bytes(const uint32_t *row_mask)
+{
+  uint32_t rows = 0;
+
+  for (unsigned int row = 0; row < FAKE_MEMLCD_HEIGHT; row++) {
+      rows += row_selected(row_mask, row) ? 1 : 0;
+  }
+
+  return (rows == 0) ? 0 : (FRAME_OVERHEAD + (rows * (FAKE_MEMLCD_ROW_BYTES + ROW_OVERHEAD)) - ROW_OVERHEAD);
+}
+
+// the panel takes the rows as they are in the frame buffer now
+static void frame_send(const uint8_t *data, const uint32_t *row_mask)
+{
+  const uint8_t *src;
+  uint32_t       bytes = frame_bytes(row_mask);
+
+  if (bytes == 0) {
+      return;
+  }
+
+  fake_memlcd_stats.frames++;
+  fake_memlcd_stats.spi_bytes += bytes;
+
+  for (unsigned int row = 0; row < FAKE_MEMLCD_HEIGHT; row++) {
+      if (!row_selected(row_mask, row)) {
+          continue;
+      }
+
+      fake_memlcd_stats.rows++;
+      src = &data[row * FAKE_MEMLCD_ROW_BYTES];
+      for (unsigned int i = 0; i < FAKE_MEMLCD_ROW_BYTES; i++) {
+          fake_memlcd_stats.pixels_changed += (uint32_t) __builtin_popcount(src[i] ^ fake_memlcd_panel[row][i]);
+      }
+      memcpy(fake_memlcd_panel[row], src, FAKE_MEMLCD_ROW_BYTES);
+  }
+}
+
+void fake_memlcd_reset(void)
+{
+  memset(&fake_memlcd_stats, 0, sizeof(fake_memlcd_stats));
+  memset(fake_memlcd_panel, 0, sizeof(fake_memlcd_panel));
+  async_busy = false;
+}
+
+
+sl_status_t sl_memlcd_init(void)
+{
+  return SL_STATUS_OK;
+}
+
+const sl_memlcd_t *sl_memlcd_get(void)
+{
+  return &memlcd;
+}
+
+sl_status_t sl_memlcd_configure(struct sl_memlcd_t *device)
+{
+  (void) device;
+  return SL_STATUS_OK;
+}
+
+sl_status_t sl_memlcd_power_on(const struct sl_memlcd_t *device, bool on)
+{
+  (void) device;
+  (void) on;
+  return SL_STATUS_OK;
+}
+
+sl_status_t sl_memlcd_refresh(const struct sl_memlcd_t *device)
+{
+  (void) device;
+  return SL_STATUS_OK;
+}
+
+sl_status_t sl_memlcd_clear(const struct sl_memlcd_t *device)
+{
+  (void) device;
+
+  if (async_busy) {
+      fake_memlcd_stats.busy++;
+      return SL_STATUS_BUSY;
+  }
+
+  // the all clear command
+  fake_memlcd_stats.spi_bytes += 2;
+  memset(fake_memlcd_panel, 0xFF, sizeof(fake_memlcd_panel));
+
+  return SL_STATUS_OK;
+}
+
+sl_status_t sl_memlcd_draw(const struct sl_memlcd_t *device, const void *data,
+                           unsigned int row_start, unsigned int row_count)
+{
+  uint32_t mask[ROW_MASK_WORDS] = { 0 };
+
+  // data starts at row_start
+  for (unsigned int row = row_start; (row < row_start + row_count) && (row < FAKE_MEMLCD_HEIGHT); row++) {
+      mask[row >> 5] |= 1UL << (row & 0x1f);
+  }
+
+  return sl_memlcd_draw_rows(device, (const uint8_t *) data - (row_start * FAKE_MEMLCD_ROW_BYTES), mask);
+}
+
+sl_status_t sl_memlcd_draw_rows(const struct sl_memlcd_t *device, const void *data,
+                                const uint32_t *row_mask)
+{
+  (void) device;
+
+  if (async_busy) {
+      fake_memlcd_stats.busy++;
+      return SL_STATUS_BUSY;
+  }
+
+  frame_send(data, row_mask);
+
+  return SL_STATUS_OK;
+}
+
+sl_status_t sl_memlcd_draw_rows_async(const struct sl_memlcd_t *device, const void *data,
+                                      const uint32_t *row_mask, sl_memlcd_callback_t callback)
+{
+  uint32_t bytes = frame_bytes(row_mask);
+
+  (void) device;
+
+  if (async_busy) {
+      fake_memlcd_stats.busy++;
+      return SL_STATUS_BUSY;
+  }
+
+  if (bytes == 0) {
+      if (callback != NULL) {
+          callback();
+      }
+      return SL_STATUS_OK;
+  }
+
+  async_busy = true;
+  async_data = data;
+  async_callback = callback;
+  memcpy(async_mask, row_mask, sizeof(async_mask));
+
+  fake_usart1_tx(bytes, memlcd.spi_freq);
+  NVIC_ClearPendingIRQ(USART1_TX_IRQn);
+  NVIC_EnableIRQ(USART1_TX_IRQn);
+
+  return SL_STATUS_OK;
+}
+
+void sl_memlcd_tx_irq_handler(void)
+{
+  fake_usart1_tx_ack();
+
+  if (!async_busy) {
+      return;
+  }
+
+  NVIC_DisableIRQ(USART1_TX_IRQn);
+  async_busy = false;
+  fake_memlcd_stats.async_frames++;
+  frame_send(async_data, async_mask);
+
+  if (async_callback != NULL) {
+      async_callback();
+  }
+}
@@ -0,0 +1,51 @@
+/* @file      memlcd_fake.h
+ * @version   1.0
+ * @brief     Host stand-in for the Sharp memory LCD driver: keeps the image
+ *            the panel shows and counts what reaching it cost
+ *
+ * @author    Anuhya Kuraparthy, anuhya.kuraparthy@colorado.edu
+ * @date      Nov 03, 2023
+ *
+ * @institution University of Colorado Boulder (UCB)
+ * @course      ECEN 5823: IoT Embedded Firmware
+ * @instructor  David Sluiter
+ *
+ * @resources  -
+ */
+
+#ifndef TESTS_FAKES_MEMLCD_FAKE_H_
+#define TESTS_FAKES_MEMLCD_FAKE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define FAKE_MEMLCD_WIDTH       (128)
+#define FAKE_MEMLCD_HEIGHT      (128)
+#define FAKE_MEMLCD_ROW_BYTES   (FAKE_MEMLCD_WIDTH / 8)
+
+typedef struct {
+  uint32_t  frames;             // sl_memlcd_draw_rows(_async) calls that sent rows
+  uint32_t  async_frames;       // of those, sent from the TX interrupt
+  uint32_t  rows;               // rows sent
+  uint32_t  spi_bytes;          // bytes clocked out, commands and addresses included
+  uint32_t  pixels_changed;     // pixels that differ from what the panel showed
+  uint32_t  busy;               // calls refused while an async frame was in flight
+} fake_memlcd_stats_t;
+
+extern fake_memlcd_stats_t fake_memlcd_stats;
+
+// what the panel shows, one bit per pixel as the frame buffer holds it
+extern uint8_t fake_memlcd_panel[FAKE_MEMLCD_HEIGHT][FAKE_MEMLCD_ROW_BYTES];
+
+
+/**
+* @brief Function to blank the panel and clear the statistics, the driver
+*        stays initialised
+*
+*
+* @param void
+* @return void
+*/
+void fake_memlcd_reset(void);
+
+#endif /* TESTS_FAKES_MEMLCD_FAKE_H_ */
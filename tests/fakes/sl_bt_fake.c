@@ -0,0 +1,1082 @@
+/* @file      sl_bt_fake.c
+ * @version   1.0
+ * @brief     Host stand-in for the Bluetooth stack, see sl_bt_fake.h
+ *
+ * @author    Anuhya Kuraparthy, anuhya.kuraparthy@colorado.edu
+ * @date      Nov 03, 2023
+ *
+ * @institution University of Colorado Boulder (UCB)
+ * @course      ECEN 5823: IoT Embedded Firmware
+ * @instructor  David Sluiter
+ *
+ * @resources  -
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sl_bluetooth.h"
+#include "sl_bt_api.h"
+
+#include "app.h"
+#include "src/workq.h"
+
+#include "hw_fake.h"
+#include "sl_bt_fake.h"
+
+#define QUEUE_LEN             (256)
+#define MAX_PEERS             (8)
+#define SCAN_REPORT_US        (100000)      // between adverts seen from one Server
+#define CONNECT_US            (30000)       // sl_bt_connection_open() to opened
+#define DEFAULT_INTERVAL      (60)          // 75 ms in 1.25 ms units
+#define HASH_LEN              (16)
+
+enum {
+  QUEUED_EVENT,                 // msg as queued
+  QUEUED_SOFT_TIMER,            // the soft timer fired
+  QUEUED_EXTERNAL_SIGNAL,       // pending_signals
+  QUEUED_SCAN_REPORT,           // an advert from peers[arg]
+  QUEUED_PEER_INDICATION        // a temperature indication on connection arg
+};
+
+typedef struct {
+  bool          used;
+  uint8_t       kind;
+  uint8_t       arg;
+  uint64_t      at;
+  uint32_t      seq;
+  sl_bt_msg_t   msg;
+} queued_t;
+
+typedef struct {
+  bool      open;
+  bool      closing;
+  uint16_t  mtu;
+  uint16_t  interval;                   // 1.25 ms units
+  bool      indication_in_flight;       // local GATT server, awaiting confirmation
+  bool      procedure_busy;             // local GATT client
+  bool      peer_indication_pending;    // remote Server, awaiting confirmation
+  bool      peer_temperature_enabled;
+  bool      peer_indication_queued;
+  int       peer;                       // index into peers[], -1 for a client
+} connection_t;
+
+typedef struct {
+  bd_addr   address;
+  uint32_t  indication_ms;
+  int32_t   temperature_mc;
+  bool      report_queued;
+  int       connection;                 // 0 when not connected
+  uint8_t   hash[HASH_LEN];
+} peer_t;
+
+fake_bt_stats_t fake_bt_stats;
+
+static queued_t       queue[QUEUE_LEN];
+static uint32_t       queue_seq;
+static connection_t   connections[256];
+static peer_t         peers[MAX_PEERS];
+static int            num_peers;
+static uint32_t       pending_signals;
+static bool           signal_queued;
+static uint64_t       soft_timer_us;
+static bool           scanning;
+static bool           advertising;
+static uint16_t       local_max_mtu = 247;
+
+static const uint8_t  uuid_htm_service[]    = { 0x09, 0x18 };
+static const uint8_t  uuid_gatt_service[]   = { 0x01, 0x18 };
+static const uint8_t  uuid_temperature[]    = { 0x1c, 0x2a };
+static const uint8_t  uuid_database_hash[]  = { 0x2a, 0x2b };
+static const uint8_t  uuid_button_service[] = { 0x89, 0x62, 0x13, 0x2d, 0x2a, 0x65, 0xec, 0x87,
+                                                0x3e, 0x43, 0xc8, 0x38, 0x01, 0x00, 0x00, 0x00 };
+static const uint8_t  uuid_button[]         = { 0x89, 0x62, 0x13, 0x2d, 0x2a, 0x65, 0xec, 0x87,
+                                                0x3e, 0x43, 0xc8, 0x38, 0x02, 0x00, 0x00, 0x00 };
+
+
+// ---------------------------------------------------------------------------
+// Event queue
+// ---------------------------------------------------------------------------
+
+static queued_t *queue_add(uint64_t delay_us, uint8_t kind, uint8_t arg)
+{
+  for (int i = 0; i < QUEUE_LEN; i++) {
+      if (!queue[i].used) {
+          memset(&queue[i], 0, sizeof(queue[i]));
+          queue[i].used = true;
+          queue[i].kind = kind;
+          queue[i].arg  = arg;
+          queue[i].at   = fake_now_us() + delay_us;
+          queue[i].seq  = queue_seq++;
+          return &queue[i];
+      }
+  }
+
+  fprintf(stderr, "sl_bt_fake: event queue is full\n");
+  abort();
+}
+
+static sl_bt_msg_t *queue_event(uint64_t delay_us, uint32_t id)
+{
+  queued_t *entry = queue_add(delay_us, QUEUED_EVENT, 0);
+
+  entry->msg.header = id;
+
+  return &entry->msg;
+}
+
+// earliest entry, first queued first among equals
+static queued_t *queue_next(void)
+{
+  queued_t *next = NULL;
+
+  for (int i = 0; i < QUEUE_LEN; i++) {
+      if (queue[i].used &&
+          ((next == NULL) || (queue[i].at < next->at) ||
+           ((queue[i].at == next->at) && (queue[i].seq < next->seq)))) {
+          next = &queue[i];
+      }
+  }
+
+  return next;
+}
+
+static uint64_t interval_us(uint8_t connection)
+{
+  return (uint64_t) connections[connection].interval * 1250;
+}
+
+static uint8_t connection_alloc(int peer)
+{
+  for (int handle = 1; handle < 256; handle++) {
+      if (!connections[handle].open && !connections[handle].closing &&
+          (connections[handle].interval == 0)) {
+          memset(&connections[handle], 0, sizeof(connections[handle]));
+          connections[handle].mtu = 23;
+          connections[handle].interval = DEFAULT_INTERVAL;
+          connections[handle].peer = peer;
+          return (uint8_t) handle;
+      }
+  }
+
+  fprintf(stderr, "sl_bt_fake: out of connection handles\n");
+  abort();
+}
+
+static void uuid_set(uint8array *uuid, const uint8_t *data, uint8_t len)
+{
+  uuid->len = len;
+  memcpy(uuid->data, data, len);
+}
+
+static void queue_procedure_completed(uint8_t connection, uint64_t delay_us, uint16_t result)
+{
+  sl_bt_msg_t *msg = queue_event(delay_us, sl_bt_evt_gatt_procedure_completed_id);
+
+  msg->data.evt_gatt_procedure_completed.connection = connection;
+  msg->data.evt_gatt_procedure_completed.result = result;
+}
+
+static void queue_value(uint8_t connection, uint64_t delay_us, uint16_t characteristic,
+                        uint8_t att_opcode, const uint8_t *value, uint8_t len)
+{
+  sl_bt_msg_t *msg = queue_event(delay_us, sl_bt_evt_gatt_characteristic_value_id);
+
+  msg->data.evt_gatt_characteristic_value.connection = connection;
+  msg->data.evt_gatt_characteristic_value.characteristic = characteristic;
+  msg->data.evt_gatt_characteristic_value.att_opcode = att_opcode;
+  uuid_set(&msg->data.evt_gatt_characteristic_value.value, value, len);
+}
+
+// a GATT client procedure, one at a time per connection
+static sl_status_t procedure_start(uint8_t connection)
+{
+  if (!connections[connection].open) {
+      fake_bt_stats.protocol_errors++;
+      return SL_STATUS_INVALID_HANDLE;
+  }
+  if (connections[connection].procedure_busy) {
+      fake_bt_stats.protocol_errors++;
+      return SL_STATUS_INVALID_STATE;
+  }
+
+  connections[connection].procedure_busy = true;
+
+  return SL_STATUS_OK;
+}
+
+// Health Thermometer measurement, FLOAT in milli-degrees
+static void htm_value(uint8_t *value, int32_t temperature_mc)
+{
+  uint32_t flt = ((uint32_t) temperature_mc & 0x00FFFFFF) | ((uint32_t) (-3 & 0xFF) << 24);
+
+  value[0] = 0;
+  value[1] = (uint8_t) flt;
+  value[2] = (uint8_t) (flt >> 8);
+  value[3] = (uint8_t) (flt >> 16);
+  value[4] = (uint8_t) (flt >> 24);
+}
+
+
+// ---------------------------------------------------------------------------
+// Delivery
+// ---------------------------------------------------------------------------
+
+// run the main loop body until no deferred work is left
+static void app_run(void)
+{
+  do {
+      app_process_action();
+  } while (workq_pending());
+}
+
+static void deliver(sl_bt_msg_t *msg)
+{
+  fake_bt_stats.events++;
+  sl_bt_on_event(msg);
+  app_run();
+}
+
+// stack side effects of an event, before the application sees it
+static void event_taken(sl_bt_msg_t *msg)
+{
+  connection_t *conn;
+
+  switch (SL_BT_MSG_ID(msg->header)) {
+    case sl_bt_evt_connection_opened_id:
+      conn = &connections[msg->data.evt_connection_opened.connection];
+      conn->open = true;
+      // a peripheral stops advertising when a central connects
+      if (conn->peer < 0) {
+          advertising = false;
+      }
+      if (conn->peer >= 0) {
+          peers[conn->peer].connection = msg->data.evt_connection_opened.connection;
+      }
+      break;
+
+    case sl_bt_evt_connection_closed_id:
+      conn = &connections[msg->data.evt_connection_closed.connection];
+      if (conn->peer >= 0) {
+          peers[conn->peer].connection = 0;
+      }
+      memset(conn, 0, sizeof(*conn));
+      break;
+
+    case sl_bt_evt_gatt_mtu_exchanged_id:
+      connections[msg->data.evt_gatt_mtu_exchanged.connection].mtu = msg->data.evt_gatt_mtu_exchanged.mtu;
+      break;
+
+    case sl_bt_evt_gatt_server_characteristic_status_id:
+      if (msg->data.evt_gatt_server_characteristic_status.status_flags == sl_bt_gatt_server_confirmation) {
+          connections[msg->data.evt_gatt_server_characteristic_status.connection].indication_in_flight = false;
+      }
+      break;
+
+    case sl_bt_evt_gatt_procedure_completed_id:
+      connections[msg->data.evt_gatt_procedure_completed.connection].procedure_busy = false;
+      break;
+
+    default:
+      break;
+  }
+}
+
+static void deliver_queued(queued_t *entry)
+{
+  sl_bt_msg_t     msg;
+  connection_t   *conn;
+  peer_t         *peer;
+  uint8_t         value[5];
+
+  memcpy(&msg, &entry->msg, sizeof(msg));
+  entry->used = false;
+
+  switch (entry->kind) {
+    case QUEUED_EVENT:
+      event_taken(&msg);
+      deliver(&msg);
+      break;
+
+    case QUEUED_SOFT_TIMER:
+      if (soft_timer_us != 0) {
+          queue_add(soft_timer_us, QUEUED_SOFT_TIMER, entry->arg);
+      }
+      fake_bt_stats.soft_timers++;
+      msg.header = sl_bt_evt_system_soft_timer_id;
+      msg.data.evt_system_soft_timer.handle = entry->arg;
+      deliver(&msg);
+      break;
+
+    case QUEUED_EXTERNAL_SIGNAL:
+      signal_queued = false;
+      fake_bt_stats.external_signals++;
+      msg.header = sl_bt_evt_system_external_signal_id;
+      msg.data.evt_system_external_signal.extsignals = pending_signals;
+      pending_signals = 0;
+      deliver(&msg);
+      break;
+
+    case QUEUED_SCAN_REPORT:
+      peer = &peers[entry->arg];
+      peer->report_queued = false;
+      if (!scanning || (peer->connection != 0)) {
+          break;
+      }
+      peer->report_queued = true;
+      queue_add(SCAN_REPORT_US, QUEUED_SCAN_REPORT, entry->arg);
+
+      msg.header = sl_bt_evt_scanner_scan_report_id;
+      msg.data.evt_scanner_scan_report.packet_type = 0;
+      msg.data.evt_scanner_scan_report.address = peer->address;
+      msg.data.evt_scanner_scan_report.address_type = sl_bt_gap_public_address;
+      msg.data.evt_scanner_scan_report.bonding = SL_BT_INVALID_BONDING_HANDLE;
+      deliver(&msg);
+      break;
+
+    case QUEUED_PEER_INDICATION:
+      conn = &connections[entry->arg];
+      conn->peer_indication_queued = false;
+      if (!conn->open || !conn->peer_temperature_enabled) {
+          break;
+      }
+      peer = &peers[conn->peer];
+      conn->peer_indication_queued = true;
+      queue_add((uint64_t) peer->indication_ms * 1000, QUEUED_PEER_INDICATION, entry->arg);
+
+      // the Server holds the next one until this is confirmed
+      if (conn->peer_indication_pending) {
+          break;
+      }
+      conn->peer_indication_pending = true;
+      fake_bt_stats.peer_indications++;
+
+      msg.header = sl_bt_evt_gatt_characteristic_value_id;
+      msg.data.evt_gatt_characteristic_value.connection = entry->arg;
+      msg.data.evt_gatt_characteristic_value.characteristic = FAKE_PEER_TEMPERATURE_CHAR;
+      msg.data.evt_gatt_characteristic_value.att_opcode = sl_bt_gatt_handle_value_indication;
+      htm_value(value, peer->temperature_mc);
+      uuid_set(&msg.data.evt_gatt_characteristic_value.value, value, sizeof(value));
+      deliver(&msg);
+      break;
+
+    default:
+      break;
+  }
+}
+
+static void deliver_due(void)
+{
+  queued_t *next;
+
+  while (((next = queue_next()) != NULL) && (next->at <= fake_now_us())) {
+      deliver_queued(next);
+  }
+}
+
+void fake_bt_run_us(uint64_t duration_us)
+{
+  uint64_t  end = fake_now_us() + duration_us;
+  uint64_t  next;
+  queued_t *entry;
+
+  app_run();
+
+  for (;;) {
+      deliver_due();
+
+      entry = queue_next();
+      next = fake_hw_next_event_us();
+      if ((entry != NULL) && (entry->at < next)) {
+          next = entry->at;
+      }
+      if (next > end) {
+          break;
+      }
+
+      fake_hw_advance_to(next);
+      app_run();
+  }
+
+  fake_hw_advance_to(end);
+  deliver_due();
+  app_run();
+}
+
+void fake_bt_reset(void)
+{
+  memset(queue, 0, sizeof(queue));
+  memset(connections, 0, sizeof(connections));
+  memset(peers, 0, sizeof(peers));
+  memset(&fake_bt_stats, 0, sizeof(fake_bt_stats));
+  queue_seq = 0;
+  num_peers = 0;
+  pending_signals = 0;
+  signal_queued = false;
+  soft_timer_us = 0;
+  scanning = false;
+  advertising = false;
+  local_max_mtu = 247;
+}
+
+void fake_bt_boot(void)
+{
+  queue_event(0, sl_bt_evt_system_boot_id);
+}
+
+
+// ---------------------------------------------------------------------------
+// Scripted peers
+// ---------------------------------------------------------------------------
+
+uint8_t fake_bt_client_connect(uint16_t mtu, uint16_t interval)
+{
+  uint8_t      connection;
+  sl_bt_msg_t *msg;
+
+  // nothing to connect to
+  if (!advertising) {
+      fake_bt_stats.protocol_errors++;
+      return 0;
+  }
+
+  connection = connection_alloc(-1);
+  connections[connection].interval = interval;
+
+  msg = queue_event(0, sl_bt_evt_connection_opened_id);
+  msg->data.evt_connection_opened.address.addr[0] = connection;
+  msg->data.evt_connection_opened.address_type = sl_bt_gap_public_address;
+  msg->data.evt_connection_opened.master = 1;
+  msg->data.evt_connection_opened.connection = connection;
+  msg->data.evt_connection_opened.bonding = SL_BT_INVALID_BONDING_HANDLE;
+
+  msg = queue_event(interval_us(connection), sl_bt_evt_connection_parameters_id);
+  msg->data.evt_connection_parameters.connection = connection;
+  msg->data.evt_connection_parameters.interval = interval;
+  msg->data.evt_connection_parameters.timeout = 80;
+  msg->data.evt_connection_parameters.txsize = 251;
+
+  msg = queue_event(2 * interval_us(connection), sl_bt_evt_gatt_mtu_exchanged_id);
+  msg->data.evt_gatt_mtu_exchanged.connection = connection;
+  msg->data.evt_gatt_mtu_exchanged.mtu = (mtu < local_max_mtu) ? mtu : local_max_mtu;
+
+  return connection;
+}
+
+void fake_bt_client_config(uint8_t connection, uint16_t characteristic, uint8_t flags)
+{
+  sl_bt_msg_t *msg = queue_event(0, sl_bt_evt_gatt_server_characteristic_status_id);
+
+  msg->data.evt_gatt_server_characteristic_status.connection = connection;
+  msg->data.evt_gatt_server_characteristic_status.characteristic = characteristic;
+  msg->data.evt_gatt_server_characteristic_status.status_flags = sl_bt_gatt_server_client_config;
+  msg->data.evt_gatt_server_characteristic_status.client_config_flags = flags;
+}
+
+void fake_bt_bond(uint8_t connection)
+{
+  sl_bt_msg_t *msg = queue_event(0, sl_bt_evt_sm_bonded_id);
+
+  msg->data.evt_sm_bonded.connection = connection;
+  msg->data.evt_sm_bonded.bonding = connection;
+  msg->data.evt_sm_bonded.security_mode = sl_bt_connection_mode1_level3;
+}
+
+void fake_bt_disconnect(uint8_t connection)
+{
+  sl_bt_msg_t *msg = queue_event(0, sl_bt_evt_connection_closed_id);
+
+  msg->data.evt_connection_closed.connection = connection;
+  msg->data.evt_connection_closed.reason = SL_STATUS_BT_CTRL_REMOTE_USER_TERMINATED;
+  connections[connection].closing = true;
+}
+
+void fake_bt_add_server(const bd_addr *address, uint32_t indication_ms, int32_t temperature_mc)
+{
+  peer_t *peer = &peers[num_peers];
+
+  memset(peer, 0, sizeof(*peer));
+  peer->address = *address;
+  peer->indication_ms = indication_ms;
+  peer->temperature_mc = temperature_mc;
+  for (int i = 0; i < HASH_LEN; i++) {
+      peer->hash[i] = (uint8_t) ((num_peers * 16) + i);
+  }
+  num_peers++;
+}
+
+int fake_bt_servers_indicating(void)
+{
+  int count = 0;
+
+  for (int i = 0; i < num_peers; i++) {
+      if ((peers[i].connection != 0) &&
+          connections[peers[i].connection].peer_temperature_enabled) {
+          count++;
+      }
+  }
+
+  return count;
+}
+
+
+// ---------------------------------------------------------------------------
+// sl_bt API: system
+// ---------------------------------------------------------------------------
+
+sl_status_t sl_bt_system_get_identity_address(bd_addr *address, uint8_t *type)
+{
+  static const bd_addr local = {{ 0x01, 0x02, 0x03, 0x04, 0x05, 0x06 }};
+
+  *address = local;
+  *type = sl_bt_gap_public_address;
+
+  return SL_STATUS_OK;
+}
+
+sl_status_t sl_bt_system_set_soft_timer(uint32_t time, uint8_t handle, uint8_t single_shot)
+{
+  uint64_t period_us = ((uint64_t) time * 1000000u) / 32768;
+
+  // one soft timer is all the application uses, a new one replaces it
+  for (int i = 0; i < QUEUE_LEN; i++) {
+      if (queue[i].used && (queue[i].kind == QUEUED_SOFT_TIMER)) {
+          queue[i].used = false;
+      }
+  }
+
+  soft_timer_us = single_shot ? 0 : period_us;
+  if (time != 0) {
+      queue_add(period_us, QUEUED_SOFT_TIMER, handle);
+  }
+
+  return SL_STATUS_OK;
+}
+
+void sl_bt_external_signal(uint32_t signals)
+{
+  pending_signals |= signals;
+
+  if (!signal_queued) {
+      signal_queued = true;
+      queue_add(0, QUEUED_EXTERNAL_SIGNAL, 0);
+  }
+}
+
+
+// ---------------------------------------------------------------------------
+// sl_bt API: advertiser and scanner
+// ---------------------------------------------------------------------------
+
+sl_status_t sl_bt_advertiser_create_set(uint8_t *handle)
+{
+  *handle = 0;
+  return SL_STATUS_OK;
+}
+
+sl_status_t sl_bt_advertiser_set_timing(uint8_t handle, uint32_t interval_min, uint32_t interval_max,
+                                        uint16_t duration, uint8_t maxevents)
+{
+  (void) handle;
+  (void) duration;
+  (void) maxevents;
+
+  if (interval_min > interval_max) {
+      fake_bt_stats.protocol_errors++;
+      return SL_STATUS_INVALID_PARAMETER;
+  }
+
+  return SL_STATUS_OK;
+}
+
+sl_status_t sl_bt_advertiser_start(uint8_t handle, uint8_t discover, uint8_t connect)
+{
+  (void) handle;
+  (void) discover;
+  (void) connect;
+
+  fake_bt_stats.advertiser_starts++;
+  advertising = true;
+  return SL_STATUS_OK;
+}
+
+sl_status_t sl_bt_advertiser_stop(uint8_t handle)
+{
+  (void) handle;
+
+  fake_bt_stats.advertiser_stops++;
+  advertising = false;
+  return SL_STATUS_OK;
+}
+
+sl_status_t sl_bt_scanner_set_mode(uint8_t phys, uint8_t scan_mode)
+{
+  (void) phys;
+  (void) scan_mode;
+  return SL_STATUS_OK;
+}
+
+sl_status_t sl_bt_scanner_set_timing(uint8_t phys, uint16_t scan_interval, uint16_t scan_window)
+{
+  (void) phys;
+
+  if (scan_window > scan_interval) {
+      fake_bt_stats.protocol_errors++;
+      return SL_STATUS_INVALID_PARAMETER;
+  }
+
+  return SL_STATUS_OK;
+}
+
+sl_status_t sl_bt_scanner_start(uint8_t scanning_phy, uint8_t discover_mode)
+{
+  (void) scanning_phy;
+  (void) discover_mode;
+
+  if (scanning) {
+      fake_bt_stats.protocol_errors++;
+      return SL_STATUS_INVALID_STATE;
+  }
+
+  scanning = true;
+  fake_bt_stats.scanner_starts++;
+
+  for (int i = 0; i < num_peers; i++) {
+      if ((peers[i].connection == 0) && !peers[i].report_queued) {
+          peers[i].report_queued = true;
+          queue_add(SCAN_REPORT_US, QUEUED_SCAN_REPORT, (uint8_t) i);
+      }
+  }
+
+  return SL_STATUS_OK;
+}
+
+sl_status_t sl_bt_scanner_stop()
+{
+  if (!scanning) {
+      fake_bt_stats.protocol_errors++;
+      return SL_STATUS_INVALID_STATE;
+  }
+
+  scanning = false;
+  fake_bt_stats.scanner_stops++;
+
+  return SL_STATUS_OK;
+}
+
+
+// ---------------------------------------------------------------------------
+// sl_bt API: connections and security
+// ---------------------------------------------------------------------------
+
+sl_status_t sl_bt_connection_open(bd_addr address, uint8_t address_type,
+                                  uint8_t initiating_phy, uint8_t *connection)
+{
+  sl_bt_msg_t *msg;
+  uint8_t      handle;
+  int          peer = -1;
+
+  (void) initiating_phy;
+
+  for (int i = 0; i < num_peers; i++) {
+      if (memcmp(peers[i].address.addr, address.addr, sizeof(address.addr)) == 0) {
+          peer = i;
+      }
+  }
+
+  if ((peer < 0) || (peers[peer].connection != 0)) {
+      fake_bt_stats.protocol_errors++;
+      return SL_STATUS_INVALID_PARAMETER;
+  }
+
+  handle = connection_alloc(peer);
+  peers[peer].connection = handle;
+  fake_bt_stats.connection_opens++;
+
+  if (connection != NULL) {
+      *connection = handle;
+  }
+
+  msg = queue_event(CONNECT_US, sl_bt_evt_connection_opened_id);
+  msg->data.evt_connection_opened.address = address;
+  msg->data.evt_connection_opened.address_type = address_type;
+  msg->data.evt_connection_opened.master = 0;
+  msg->data.evt_connection_opened.connection = handle;
+  msg->data.evt_connection_opened.bonding = SL_BT_INVALID_BONDING_HANDLE;
+
+  msg = queue_event(CONNECT_US + interval_us(handle), sl_bt_evt_gatt_mtu_exchanged_id);
+  msg->data.evt_gatt_mtu_exchanged.connection = handle;
+  msg->data.evt_gatt_mtu_exchanged.mtu = local_max_mtu;
+
+  return SL_STATUS_OK;
+}
+
+sl_status_t sl_bt_connection_close(uint8_t connection)
+{
+  sl_bt_msg_t *msg;
+
+  if (!connections[connection].open || connections[connection].closing) {
+      fake_bt_stats.protocol_errors++;
+      return SL_STATUS_INVALID_HANDLE;
+  }
+
+  connections[connection].closing = true;
+  fake_bt_stats.connection_closes++;
+
+  msg = queue_event(interval_us(connection), sl_bt_evt_connection_closed_id);
+  msg->data.evt_connection_closed.connection = connection;
+  msg->data.evt_connection_closed.reason = SL_STATUS_BT_CTRL_CONNECTION_TERMINATED_BY_LOCAL_HOST;
+
+  return SL_STATUS_OK;
+}
+
+sl_status_t sl_bt_connection_set_default_parameters(uint16_t min_interval, uint16_t max_interval,
+                                                    uint16_t latency, uint16_t timeout,
+                                                    uint16_t min_ce_length, uint16_t max_ce_length)
+{
+  (void) latency;
+  (void) timeout;
+  (void) min_ce_length;
+  (void) max_ce_length;
+
+  if (min_interval > max_interval) {
+      fake_bt_stats.protocol_errors++;
+      return SL_STATUS_INVALID_PARAMETER;
+  }
+
+  return SL_STATUS_OK;
+}
+
+sl_status_t sl_bt_connection_set_parameters(uint8_t connection, uint16_t min_interval,
+                                            uint16_t max_interval, uint16_t latency,
+                                            uint16_t timeout, uint16_t min_ce_length,
+                                            uint16_t max_ce_length)
+{
+  sl_bt_msg_t *msg;
+
+  (void) min_ce_length;
+  (void) max_ce_length;
+
+  if (!connections[connection].open || (min_interval > max_interval)) {
+      fake_bt_stats.protocol_errors++;
+      return SL_STATUS_INVALID_PARAMETER;
+  }
+
+  // the central takes the longest interval asked for
+  msg = queue_event(2 * interval_us(connection), sl_bt_evt_connection_parameters_id);
+  msg->data.evt_connection_parameters.connection = connection;
+  msg->data.evt_connection_parameters.interval = max_interval;
+  msg->data.evt_connection_parameters.latency = latency;
+  msg->data.evt_connection_parameters.timeout = timeout;
+  msg->data.evt_connection_parameters.txsize = 251;
+  connections[connection].interval = max_interval;
+
+  return SL_STATUS_OK;
+}
+
+sl_status_t sl_bt_sm_configure(uint8_t flags, uint8_t io_capabilities)
+{
+  (void) flags;
+  (void) io_capabilities;
+  return SL_STATUS_OK;
+}
+
+sl_status_t sl_bt_sm_delete_bondings()
+{
+  return SL_STATUS_OK;
+}
+
+sl_status_t sl_bt_sm_delete_bonding(uint8_t bonding)
+{
+  (void) bonding;
+  return SL_STATUS_OK;
+}
+
+sl_status_t sl_bt_sm_bonding_confirm(uint8_t connection, uint8_t confirm)
+{
+  (void) confirm;
+
+  if (!connections[connection].open) {
+      fake_bt_stats.protocol_errors++;
+      return SL_STATUS_INVALID_HANDLE;
+  }
+
+  return SL_STATUS_OK;
+}
+
+sl_status_t sl_bt_sm_passkey_confirm(uint8_t connection, uint8_t confirm)
+{
+  (void) connection;
+  (void) confirm;
+  return SL_STATUS_OK;
+}
+
+sl_status_t sl_bt_sm_increase_security(uint8_t connection)
+{
+  if (!connections[connection].open) {
+      fake_bt_stats.protocol_errors++;
+      return SL_STATUS_INVALID_HANDLE;
+  }
+
+  return SL_STATUS_OK;
+}
+
+
+// ---------------------------------------------------------------------------
+// sl_bt API: GATT server
+// ---------------------------------------------------------------------------
+
+sl_status_t sl_bt_gatt_server_set_max_mtu(uint16_t max_mtu, uint16_t *max_mtu_out)
+{
+  local_max_mtu = (max_mtu > 250) ? 250 : max_mtu;
+  *max_mtu_out = local_max_mtu;
+
+  return SL_STATUS_OK;
+}
+
+sl_status_t sl_bt_gatt_server_write_attribute_value(uint16_t attribute, uint16_t offset,
+                                                    size_t value_len, const uint8_t* value)
+{
+  (void) attribute;
+  (void) offset;
+  (void) value_len;
+  (void) value;
+
+  fake_bt_stats.attribute_writes++;
+  return SL_STATUS_OK;
+}
+
+static sl_status_t server_send_check(uint8_t connection, size_t value_len)
+{
+  if (!connections[connection].open) {
+      fake_bt_stats.protocol_errors++;
+      return SL_STATUS_INVALID_HANDLE;
+  }
+
+  if (value_len > (size_t) (connections[connection].mtu - 3)) {
+      fake_bt_stats.protocol_errors++;
+      return SL_STATUS_INVALID_PARAMETER;
+  }
+
+  return SL_STATUS_OK;
+}
+
+sl_status_t sl_bt_gatt_server_send_indication(uint8_t connection, uint16_t characteristic,
+                                              size_t value_len, const uint8_t* value)
+{
+  sl_bt_msg_t *msg;
+  sl_status_t  sc = server_send_check(connection, value_len);
+
+  (void) value;
+
+  if (sc != SL_STATUS_OK) {
+      return sc;
+  }
+
+  // ATT allows one outstanding indication per connection
+  if (connections[connection].indication_in_flight) {
+      fake_bt_stats.protocol_errors++;
+      return SL_STATUS_IN_PROGRESS;
+  }
+
+  connections[connection].indication_in_flight = true;
+  fake_bt_stats.indications++;
+  fake_bt_stats.indication_bytes += value_len;
+
+  // the client confirms on the next connection event after it arrives
+  msg = queue_event(2 * interval_us(connection), sl_bt_evt_gatt_server_characteristic_status_id);
+  msg->data.evt_gatt_server_characteristic_status.connection = connection;
+  msg->data.evt_gatt_server_characteristic_status.characteristic = characteristic;
+  msg->data.evt_gatt_server_characteristic_status.status_flags = sl_bt_gatt_server_confirmation;
+
+  return SL_STATUS_OK;
+}
+
+sl_status_t sl_bt_gatt_server_send_notification(uint8_t connection, uint16_t characteristic,
+                                                size_t value_len, const uint8_t* value)
+{
+  sl_status_t sc = server_send_check(connection, value_len);
+
+  (void) characteristic;
+  (void) value;
+
+  if (sc != SL_STATUS_OK) {
+      return sc;
+  }
+
+  fake_bt_stats.notifications++;
+  fake_bt_stats.notification_bytes += value_len;
+
+  return SL_STATUS_OK;
+}
+
+
+// ---------------------------------------------------------------------------
+// sl_bt API: GATT client, answered by the remote Server
+// ---------------------------------------------------------------------------
+
+sl_status_t sl_bt_gatt_set_max_mtu(uint16_t max_mtu, uint16_t *max_mtu_out)
+{
+  return sl_bt_gatt_server_set_max_mtu(max_mtu, max_mtu_out);
+}
+
+sl_status_t sl_bt_gatt_discover_primary_services(uint8_t connection)
+{
+  sl_bt_msg_t *msg;
+  uint64_t     step = interval_us(connection);
+  sl_status_t  sc = procedure_start(connection);
+
+  if (sc != SL_STATUS_OK) {
+      return sc;
+  }
+  fake_bt_stats.services_discovered++;
+
+  msg = queue_event(step, sl_bt_evt_gatt_service_id);
+  msg->data.evt_gatt_service.connection = connection;
+  msg->data.evt_gatt_service.service = FAKE_PEER_GATT_SERVICE;
+  uuid_set(&msg->data.evt_gatt_service.uuid, uuid_gatt_service, sizeof(uuid_gatt_service));
+
+  msg = queue_event(step, sl_bt_evt_gatt_service_id);
+  msg->data.evt_gatt_service.connection = connection;
+  msg->data.evt_gatt_service.service = FAKE_PEER_HTM_SERVICE;
+  uuid_set(&msg->data.evt_gatt_service.uuid, uuid_htm_service, sizeof(uuid_htm_service));
+
+  msg = queue_event(2 * step, sl_bt_evt_gatt_service_id);
+  msg->data.evt_gatt_service.connection = connection;
+  msg->data.evt_gatt_service.service = FAKE_PEER_BUTTON_SERVICE;
+  uuid_set(&msg->data.evt_gatt_service.uuid, uuid_button_service, sizeof(uuid_button_service));
+
+  queue_procedure_completed(connection, 3 * step, SL_STATUS_OK);
+
+  return SL_STATUS_OK;
+}
+
+sl_status_t sl_bt_gatt_discover_characteristics(uint8_t connection, uint32_t service)
+{
+  sl_bt_msg_t *msg;
+  uint64_t     step = interval_us(connection);
+  sl_status_t  sc = procedure_start(connection);
+
+  if (sc != SL_STATUS_OK) {
+      return sc;
+  }
+  fake_bt_stats.characteristics_discovered++;
+
+  if (service == FAKE_PEER_HTM_SERVICE) {
+      msg = queue_event(step, sl_bt_evt_gatt_characteristic_id);
+      msg->data.evt_gatt_characteristic.connection = connection;
+      msg->data.evt_gatt_characteristic.characteristic = FAKE_PEER_TEMPERATURE_CHAR;
+      msg->data.evt_gatt_characteristic.properties = 0x20;
+      uuid_set(&msg->data.evt_gatt_characteristic.uuid, uuid_temperature, sizeof(uuid_temperature));
+  }
+  else if (service == FAKE_PEER_BUTTON_SERVICE) {
+      msg = queue_event(step, sl_bt_evt_gatt_characteristic_id);
+      msg->data.evt_gatt_characteristic.connection = connection;
+      msg->data.evt_gatt_characteristic.characteristic = FAKE_PEER_BUTTON_CHAR;
+      msg->data.evt_gatt_characteristic.properties = 0x22;
+      uuid_set(&msg->data.evt_gatt_characteristic.uuid, uuid_button, sizeof(uuid_button));
+  }
+  else if (service == FAKE_PEER_GATT_SERVICE) {
+      msg = queue_event(step, sl_bt_evt_gatt_characteristic_id);
+      msg->data.evt_gatt_characteristic.connection = connection;
+      msg->data.evt_gatt_characteristic.characteristic = FAKE_PEER_HASH_CHAR;
+      msg->data.evt_gatt_characteristic.properties = 0x02;
+      uuid_set(&msg->data.evt_gatt_characteristic.uuid, uuid_database_hash, sizeof(uuid_database_hash));
+  }
+
+  queue_procedure_completed(connection, 2 * step, SL_STATUS_OK);
+
+  return SL_STATUS_OK;
+}
+
+sl_status_t sl_bt_gatt_set_characteristic_notification(uint8_t connection, uint16_t characteristic,
+                                                       uint8_t flags)
+{
+  connection_t *conn = &connections[connection];
+  sl_status_t   sc = procedure_start(connection);
+
+  if (sc != SL_STATUS_OK) {
+      return sc;
+  }
+  fake_bt_stats.notification_enables++;
+
+  if (characteristic == FAKE_PEER_TEMPERATURE_CHAR) {
+      conn->peer_temperature_enabled = (flags & sl_bt_gatt_indication) != 0;
+      if (conn->peer_temperature_enabled && !conn->peer_indication_queued) {
+          conn->peer_indication_queued = true;
+          queue_add((uint64_t) peers[conn->peer].indication_ms * 1000, QUEUED_PEER_INDICATION, connection);
+      }
+  }
+
+  queue_procedure_completed(connection, 2 * interval_us(connection), SL_STATUS_OK);
+
+  return SL_STATUS_OK;
+}
+
+sl_status_t sl_bt_gatt_read_characteristic_value(uint8_t connection, uint16_t characteristic)
+{
+  uint64_t    step = interval_us(connection);
+  uint8_t     value[5];
+  sl_status_t sc = procedure_start(connection);
+
+  if (sc != SL_STATUS_OK) {
+      return sc;
+  }
+  fake_bt_stats.value_reads++;
+
+  if (characteristic == FAKE_PEER_HASH_CHAR) {
+      queue_value(connection, step, characteristic, sl_bt_gatt_read_response,
+                  peers[connections[connection].peer].hash, HASH_LEN);
+  }
+  else if (characteristic == FAKE_PEER_BUTTON_CHAR) {
+      value[0] = 0;
+      queue_value(connection, step, characteristic, sl_bt_gatt_read_response, value, 1);
+  }
+  else if (characteristic == FAKE_PEER_TEMPERATURE_CHAR) {
+      htm_value(value, peers[connections[connection].peer].temperature_mc);
+      queue_value(connection, step, characteristic, sl_bt_gatt_read_response, value, sizeof(value));
+  }
+
+  queue_procedure_completed(connection, 2 * step, SL_STATUS_OK);
+
+  return SL_STATUS_OK;
+}
+
+sl_status_t sl_bt_gatt_read_characteristic_value_by_uuid(uint8_t connection, uint32_t service,
+                                                         size_t uuid_len, const uint8_t* uuid)
+{
+  uint64_t    step = interval_us(connection);
+  sl_status_t sc = procedure_start(connection);
+
+  if (sc != SL_STATUS_OK) {
+      return sc;
+  }
+  fake_bt_stats.value_reads++;
+
+  if ((service == FAKE_PEER_GATT_SERVICE) &&
+      (uuid_len == sizeof(uuid_database_hash)) &&
+      (memcmp(uuid, uuid_database_hash, uuid_len) == 0)) {
+      queue_value(connection, step, FAKE_PEER_HASH_CHAR, sl_bt_gatt_read_by_type_response,
+                  peers[connections[connection].peer].hash, HASH_LEN);
+      queue_procedure_completed(connection, 2 * step, SL_STATUS_OK);
+  }
+  else {
+      queue_procedure_completed(connection, step, SL_STATUS_BT_ATT_ATT_NOT_FOUND);
+  }
+
+  return SL_STATUS_OK;
+}
+
+sl_status_t sl_bt_gatt_send_characteristic_confirmation(uint8_t connection)
+{
+  if (!connections[connection].peer_indication_pending) {
+      fake_bt_stats.protocol_errors++;
+      return SL_STATUS_INVALID_STATE;
+  }
+
+  connections[connection].peer_indication_pending = false;
+  fake_bt_stats.confirmations++;
+
+  return SL_STATUS_OK;
+}
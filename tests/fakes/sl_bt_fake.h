@@ -0,0 +1,164 @@
+/* @file      sl_bt_fake.h
+ * @version   1.0
+ * @brief     Host stand-in for the Bluetooth stack: the sl_bt calls the
+ *            application makes, an event queue on the virtual clock and
+ *            scripted peers for both device roles
+ *
+ * @author    Anuhya Kuraparthy, anuhya.kuraparthy@colorado.edu
+ * @date      Nov 03, 2023
+ *
+ * @institution University of Colorado Boulder (UCB)
+ * @course      ECEN 5823: IoT Embedded Firmware
+ * @instructor  David Sluiter
+ *
+ * @resources  -
+ */
+
+#ifndef TESTS_FAKES_SL_BT_FAKE_H_
+#define TESTS_FAKES_SL_BT_FAKE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "sl_bt_api.h"
+
+// Remote Server GATT handles, the client discovers these
+#define FAKE_PEER_HTM_SERVICE       (0x00010008)
+#define FAKE_PEER_BUTTON_SERVICE    (0x0001001E)
+#define FAKE_PEER_GATT_SERVICE      (0x00010001)
+#define FAKE_PEER_TEMPERATURE_CHAR  (21)
+#define FAKE_PEER_BUTTON_CHAR       (33)
+#define FAKE_PEER_HASH_CHAR         (6)
+
+typedef struct {
+  uint32_t  events;                 // events handed to sl_bt_on_event()
+  uint32_t  external_signals;       // external signal events among them
+  uint32_t  soft_timers;            // soft timer events among them
+  uint32_t  advertiser_starts;
+  uint32_t  advertiser_stops;
+  uint32_t  scanner_starts;
+  uint32_t  scanner_stops;
+  uint32_t  connection_opens;
+  uint32_t  connection_closes;
+  uint32_t  indications;            // sent by the local GATT server
+  uint32_t  indication_bytes;
+  uint32_t  notifications;
+  uint32_t  notification_bytes;
+  uint32_t  attribute_writes;
+  uint32_t  services_discovered;    // discover_primary_services calls
+  uint32_t  characteristics_discovered;
+  uint32_t  notification_enables;   // set_characteristic_notification calls
+  uint32_t  value_reads;            // read_characteristic_value(_by_uuid) calls
+  uint32_t  confirmations;          // indication confirmations sent by the client
+  uint32_t  peer_indications;       // indications the remote Servers sent
+  uint32_t  protocol_errors;        // calls a real stack would refuse
+} fake_bt_stats_t;
+
+extern fake_bt_stats_t fake_bt_stats;
+
+
+/**
+* @brief Function to clear the queue, the peers and the statistics. Call
+*        after fake_hw_reset().
+*
+*
+* @param void
+* @return void
+*/
+void fake_bt_reset(void);
+
+/**
+* @brief Function to queue sl_bt_evt_system_boot
+*
+*
+* @param void
+* @return void
+*/
+void fake_bt_boot(void);
+
+/**
+* @brief Function to run the application on the virtual clock: every due
+*        peripheral interrupt and stack event is delivered, and
+*        app_process_action() runs after each until the work queue is idle
+*
+*
+* @param duration_us  how long to run for
+* @return void
+*/
+void fake_bt_run_us(uint64_t duration_us);
+
+
+/*
+ * Remote clients, for the Server build
+ */
+
+/**
+* @brief Function to have a remote client connect, exchange its ATT_MTU and
+*        settle the connection parameters
+*
+*
+* @param mtu          ATT_MTU the client offers
+* @param interval     connection interval in 1.25 ms units
+* @return uint8_t     connection handle, 0 and a protocol error if the
+*                     application is not advertising
+*/
+uint8_t fake_bt_client_connect(uint16_t mtu, uint16_t interval);
+
+/**
+* @brief Function to have a remote client write a CCCD
+*
+*
+* @param connection      connection handle
+* @param characteristic  local characteristic handle
+* @param flags           sl_bt_gatt_server_client_configuration_t value
+* @return void
+*/
+void fake_bt_client_config(uint8_t connection, uint16_t characteristic, uint8_t flags);
+
+/**
+* @brief Function to complete bonding on a connection
+*
+*
+* @param connection  connection handle
+* @return void
+*/
+void fake_bt_bond(uint8_t connection);
+
+/**
+* @brief Function to close a connection from the remote side
+*
+*
+* @param connection  connection handle
+* @return void
+*/
+void fake_bt_disconnect(uint8_t connection);
+
+
+/*
+ * Remote Servers, for the Client build
+ */
+
+/**
+* @brief Function to add an advertising Server. It answers discovery with
+*        the Health Thermometer, button and Generic Attribute services and
+*        indicates a temperature every indication_ms once enabled.
+*
+*
+* @param address        its public address
+* @param indication_ms  temperature indication period
+* @param temperature_mc temperature it reports, milli-degrees C
+* @return void
+*/
+void fake_bt_add_server(const bd_addr *address, uint32_t indication_ms, int32_t temperature_mc);
+
+/**
+* @brief Function to count the remote Servers the client is connected to
+*        with temperature indications enabled
+*
+*
+* @param void
+* @return int  number of such Servers
+*/
+int fake_bt_servers_indicating(void);
+
+#endif /* TESTS_FAKES_SL_BT_FAKE_H_ */
@@ -0,0 +1,24 @@
+/* @file      app_assert.h
+ * @version   1.0
+ * @brief     Host stand-in for app_assert
+ *
+ * @author    Anuhya Kuraparthy, anuhya.kuraparthy@colorado.edu
+ * @date      Nov 03, 2023
+ *
+ * @institution University of Colorado Boulder (UCB)
+ * @course      ECEN 5823: IoT Embedded Firmware
+ * @instructor  David Sluiter
+ *
+ * @resources  -
+ */
+
+#ifndef TESTS_STUBS_APP_ASSERT_H_
+#define TESTS_STUBS_APP_ASSERT_H_
+
+#include <assert.h>
+
+#include "sl_component_catalog.h"
+
+#define app_assert(expr, ...)   assert(expr)
+
+#endif /* TESTS_STUBS_APP_ASSERT_H_ */
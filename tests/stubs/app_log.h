@@ -0,0 +1,27 @@
+/* @file      app_log.h
+ * @version   1.0
+ * @brief     Host stand-in for app_log, printed only when the test asks for it
+ *
+ * @author    Anuhya Kuraparthy, anuhya.kuraparthy@colorado.edu
+ * @date      Nov 03, 2023
+ *
+ * @institution University of Colorado Boulder (UCB)
+ * @course      ECEN 5823: IoT Embedded Firmware
+ * @instructor  David Sluiter
+ *
+ * @resources  -
+ */
+
+#ifndef TESTS_STUBS_APP_LOG_H_
+#define TESTS_STUBS_APP_LOG_H_
+
+#include <stdbool.h>
+
+// set to print the application's log lines on stdout
+extern bool fake_log_enable;
+
+int fake_app_log(const char *format, ...) __attribute__ ((format (printf, 1, 2)));
+
+#define app_log(...)    fake_app_log(__VA_ARGS__)
+
+#endif /* TESTS_STUBS_APP_LOG_H_ */
@@ -0,0 +1,50 @@
+/* @file      em_cmu.h
+ * @version   1.0
+ * @brief     Host stand-in for emlib CMU, only the LFA branch LETIMER0 runs from
+ *
+ * @author    Anuhya Kuraparthy, anuhya.kuraparthy@colorado.edu
+ * @date      Nov 03, 2023
+ *
+ * @institution University of Colorado Boulder (UCB)
+ * @course      ECEN 5823: IoT Embedded Firmware
+ * @instructor  David Sluiter
+ *
+ * @resources  -
+ */
+
+#ifndef TESTS_STUBS_EM_CMU_H_
+#define TESTS_STUBS_EM_CMU_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "em_device.h"
+#include "em_gpio.h"          // as the SDK header does
+
+typedef enum {
+  cmuOsc_LFXO,
+  cmuOsc_ULFRCO
+} CMU_Osc_TypeDef;
+
+typedef enum {
+  cmuClock_LFA,
+  cmuClock_LETIMER0
+} CMU_Clock_TypeDef;
+
+typedef enum {
+  cmuSelect_LFXO,
+  cmuSelect_ULFRCO
+} CMU_Select_TypeDef;
+
+typedef uint32_t CMU_ClkDiv_TypeDef;
+
+#define cmuClkDiv_1     (1)
+#define cmuClkDiv_4     (4)
+
+void     CMU_OscillatorEnable(CMU_Osc_TypeDef osc, bool enable, bool wait);
+void     CMU_ClockSelectSet(CMU_Clock_TypeDef clock, CMU_Select_TypeDef ref);
+void     CMU_ClockDivSet(CMU_Clock_TypeDef clock, CMU_ClkDiv_TypeDef div);
+void     CMU_ClockEnable(CMU_Clock_TypeDef clock, bool enable);
+uint32_t CMU_ClockFreqGet(CMU_Clock_TypeDef clock);
+
+#endif /* TESTS_STUBS_EM_CMU_H_ */
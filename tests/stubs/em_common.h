@@ -0,0 +1,25 @@
+/* @file      em_common.h
+ * @version   1.0
+ * @brief     Host stand-in for emlib em_common.h
+ *
+ * @author    Anuhya Kuraparthy, anuhya.kuraparthy@colorado.edu
+ * @date      Nov 03, 2023
+ *
+ * @institution University of Colorado Boulder (UCB)
+ * @course      ECEN 5823: IoT Embedded Firmware
+ * @instructor  David Sluiter
+ *
+ * @resources  -
+ */
+
+#ifndef TESTS_STUBS_EM_COMMON_H_
+#define TESTS_STUBS_EM_COMMON_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "em_device.h"
+
+#define SL_WEAK     __attribute__ ((weak))
+
+#endif /* TESTS_STUBS_EM_COMMON_H_ */
@@ -0,0 +1,33 @@
+/* @file      em_core.h
+ * @version   1.0
+ * @brief     Host stand-in for emlib CORE critical sections. Interrupts
+ *            raised by the fake peripherals while one is held are taken
+ *            when the outermost one exits.
+ *
+ * @author    Anuhya Kuraparthy, anuhya.kuraparthy@colorado.edu
+ * @date      Nov 03, 2023
+ *
+ * @institution University of Colorado Boulder (UCB)
+ * @course      ECEN 5823: IoT Embedded Firmware
+ * @instructor  David Sluiter
+ *
+ * @resources  -
+ */
+
+#ifndef TESTS_STUBS_EM_CORE_H_
+#define TESTS_STUBS_EM_CORE_H_
+
+#include <stdint.h>
+
+#include "em_device.h"
+
+typedef uint32_t CORE_irqState_t;
+
+CORE_irqState_t CORE_EnterCritical(void);
+void            CORE_ExitCritical(CORE_irqState_t irqState);
+
+#define CORE_DECLARE_IRQ_STATE        CORE_irqState_t irqState
+#define CORE_ENTER_CRITICAL()         irqState = CORE_EnterCritical()
+#define CORE_EXIT_CRITICAL()          CORE_ExitCritical(irqState)
+
+#endif /* TESTS_STUBS_EM_CORE_H_ */
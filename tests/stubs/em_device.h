@@ -0,0 +1,60 @@
+/* @file      em_device.h
+ * @version   1.0
+ * @brief     Host stand-in for the EFR32BG13P device header: the CMSIS
+ *            pieces the application uses, backed by tests/fakes/hw_fake.c
+ *
+ * @author    Anuhya Kuraparthy, anuhya.kuraparthy@colorado.edu
+ * @date      Nov 03, 2023
+ *
+ * @institution University of Colorado Boulder (UCB)
+ * @course      ECEN 5823: IoT Embedded Firmware
+ * @instructor  David Sluiter
+ *
+ * @resources  -
+ */
+
+#ifndef TESTS_STUBS_EM_DEVICE_H_
+#define TESTS_STUBS_EM_DEVICE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Series 1 part, as the SDK headers test for it
+#define _SILICON_LABS_32B_SERIES_1
+
+#define __INLINE    inline
+#define __DMB()     __sync_synchronize()
+
+typedef enum {
+  GPIO_EVEN_IRQn,
+  I2C0_IRQn,
+  GPIO_ODD_IRQn,
+  LETIMER0_IRQn,
+  USART1_TX_IRQn,
+  FAKE_NUM_IRQn
+} IRQn_Type;
+
+void NVIC_EnableIRQ(IRQn_Type irq);
+void NVIC_DisableIRQ(IRQn_Type irq);
+void NVIC_ClearPendingIRQ(IRQn_Type irq);
+
+// DWT->CYCCNT reads the host clock in ns, see fake_dwt()
+typedef struct {
+  volatile uint32_t CTRL;
+  volatile uint32_t CYCCNT;
+} DWT_Type;
+
+typedef struct {
+  volatile uint32_t DEMCR;
+} CoreDebug_Type;
+
+#define DWT_CTRL_CYCCNTENA_Msk          (1UL << 0)
+#define CoreDebug_DEMCR_TRCENA_Msk      (1UL << 24)
+
+DWT_Type *fake_dwt(void);
+extern CoreDebug_Type fake_core_debug;
+
+#define DWT         (fake_dwt())
+#define CoreDebug   (&fake_core_debug)
+
+#endif /* TESTS_STUBS_EM_DEVICE_H_ */
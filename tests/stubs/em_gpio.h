@@ -0,0 +1,56 @@
+/* @file      em_gpio.h
+ * @version   1.0
+ * @brief     Host stand-in for emlib GPIO, pin levels live in tests/fakes/hw_fake.c
+ *
+ * @author    Anuhya Kuraparthy, anuhya.kuraparthy@colorado.edu
+ * @date      Nov 03, 2023
+ *
+ * @institution University of Colorado Boulder (UCB)
+ * @course      ECEN 5823: IoT Embedded Firmware
+ * @instructor  David Sluiter
+ *
+ * @resources  -
+ */
+
+#ifndef TESTS_STUBS_EM_GPIO_H_
+#define TESTS_STUBS_EM_GPIO_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "em_device.h"
+#include "em_core.h"          // em_bus.h brings it in on target
+
+typedef enum {
+  gpioPortA,
+  gpioPortB,
+  gpioPortC,
+  gpioPortD,
+  gpioPortE,
+  gpioPortF,
+  FAKE_NUM_GPIO_PORTS
+} GPIO_Port_TypeDef;
+
+typedef enum {
+  gpioDriveStrengthWeakAlternateWeak,
+  gpioDriveStrengthStrongAlternateStrong
+} GPIO_DriveStrength_TypeDef;
+
+typedef enum {
+  gpioModeDisabled,
+  gpioModeInput,
+  gpioModeInputPullFilter,
+  gpioModePushPull
+} GPIO_Mode_TypeDef;
+
+void         GPIO_DriveStrengthSet(GPIO_Port_TypeDef port, GPIO_DriveStrength_TypeDef strength);
+void         GPIO_PinModeSet(GPIO_Port_TypeDef port, unsigned int pin, GPIO_Mode_TypeDef mode, unsigned int out);
+void         GPIO_ExtIntConfig(GPIO_Port_TypeDef port, unsigned int pin, unsigned int intNo,
+                               bool risingEdge, bool fallingEdge, bool enable);
+void         GPIO_PinOutSet(GPIO_Port_TypeDef port, unsigned int pin);
+void         GPIO_PinOutClear(GPIO_Port_TypeDef port, unsigned int pin);
+unsigned int GPIO_PinInGet(GPIO_Port_TypeDef port, unsigned int pin);
+uint32_t     GPIO_IntGetEnabled(void);
+void         GPIO_IntClear(uint32_t flags);
+
+#endif /* TESTS_STUBS_EM_GPIO_H_ */
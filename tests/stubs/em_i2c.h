@@ -0,0 +1,65 @@
+/* @file      em_i2c.h
+ * @version   1.0
+ * @brief     Host stand-in for emlib I2C, transfers are answered by the
+ *            Si7021 model in tests/fakes/hw_fake.c
+ *
+ * @author    Anuhya Kuraparthy, anuhya.kuraparthy@colorado.edu
+ * @date      Nov 03, 2023
+ *
+ * @institution University of Colorado Boulder (UCB)
+ * @course      ECEN 5823: IoT Embedded Firmware
+ * @instructor  David Sluiter
+ *
+ * @resources  -
+ */
+
+#ifndef TESTS_STUBS_EM_I2C_H_
+#define TESTS_STUBS_EM_I2C_H_
+
+#include <stdint.h>
+
+#include "em_device.h"
+
+typedef struct {
+  uint32_t  unused;
+} I2C_TypeDef;
+
+extern I2C_TypeDef fake_i2c0;
+#define I2C0    (&fake_i2c0)
+
+#define I2C_FREQ_STANDARD_MAX   93000
+
+#define I2C_FLAG_WRITE          0x0001
+#define I2C_FLAG_READ           0x0002
+#define I2C_FLAG_WRITE_READ     0x0004
+#define I2C_FLAG_WRITE_WRITE    0x0008
+
+typedef enum {
+  i2cClockHLRStandard,
+  i2cClockHLRAsymetric,
+  i2cClockHLRFast
+} I2C_ClockHLR_TypeDef;
+
+typedef enum {
+  i2cTransferInProgress = 1,
+  i2cTransferDone       = 0,
+  i2cTransferNack       = -1,
+  i2cTransferBusErr     = -2,
+  i2cTransferArbLost    = -3,
+  i2cTransferUsageFault = -4,
+  i2cTransferSwFault    = -5
+} I2C_TransferReturn_TypeDef;
+
+typedef struct {
+  uint16_t addr;
+  uint16_t flags;
+  struct {
+    uint8_t  *data;
+    uint16_t len;
+  } buf[2];
+} I2C_TransferSeq_TypeDef;
+
+I2C_TransferReturn_TypeDef I2C_TransferInit(I2C_TypeDef *i2c, I2C_TransferSeq_TypeDef *seq);
+I2C_TransferReturn_TypeDef I2C_Transfer(I2C_TypeDef *i2c);
+
+#endif /* TESTS_STUBS_EM_I2C_H_ */
@@ -0,0 +1,86 @@
+/* @file      em_letimer.h
+ * @version   1.0
+ * @brief     Host stand-in for emlib LETIMER, the counter is emulated by
+ *            tests/fakes/hw_fake.c
+ *
+ * @author    Anuhya Kuraparthy, anuhya.kuraparthy@colorado.edu
+ * @date      Nov 03, 2023
+ *
+ * @institution University of Colorado Boulder (UCB)
+ * @course      ECEN 5823: IoT Embedded Firmware
+ * @instructor  David Sluiter
+ *
+ * @resources  -
+ */
+
+#ifndef TESTS_STUBS_EM_LETIMER_H_
+#define TESTS_STUBS_EM_LETIMER_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "em_device.h"
+
+typedef struct {
+  volatile uint32_t CNT;
+  volatile uint32_t COMP0;
+  volatile uint32_t COMP1;
+  volatile uint32_t IF;
+  volatile uint32_t IEN;
+  volatile bool     running;
+} LETIMER_TypeDef;
+
+extern LETIMER_TypeDef fake_letimer0;
+#define LETIMER0    (&fake_letimer0)
+
+// Same bit positions as the EFR32BG13P
+#define LETIMER_IF_COMP0        (0x1UL << 0)
+#define LETIMER_IF_COMP1        (0x1UL << 1)
+#define LETIMER_IF_UF           (0x1UL << 2)
+#define LETIMER_IF_REP0         (0x1UL << 3)
+#define LETIMER_IF_REP1         (0x1UL << 4)
+#define LETIMER_IFS_COMP1       LETIMER_IF_COMP1
+#define LETIMER_IFC_COMP1       LETIMER_IF_COMP1
+#define LETIMER_IEN_COMP1       LETIMER_IF_COMP1
+#define LETIMER_IEN_UF          LETIMER_IF_UF
+
+typedef enum {
+  letimerUFOANone,
+  letimerUFOAToggle,
+  letimerUFOAPulse,
+  letimerUFOAPwm
+} LETIMER_UFOA_TypeDef;
+
+typedef enum {
+  letimerRepeatFree,
+  letimerRepeatOneshot,
+  letimerRepeatBuffered,
+  letimerRepeatDouble
+} LETIMER_RepeatMode_TypeDef;
+
+typedef struct {
+  bool                        enable;
+  bool                        debugRun;
+  bool                        comp0Top;
+  bool                        bufTop;
+  uint8_t                     out0Pol;
+  uint8_t                     out1Pol;
+  LETIMER_UFOA_TypeDef        ufoa0;
+  LETIMER_UFOA_TypeDef        ufoa1;
+  LETIMER_RepeatMode_TypeDef  repMode;
+  uint32_t                    topValue;
+} LETIMER_Init_TypeDef;
+
+void     LETIMER_Init(LETIMER_TypeDef *letimer, const LETIMER_Init_TypeDef *init);
+void     LETIMER_Enable(LETIMER_TypeDef *letimer, bool enable);
+void     LETIMER_CompareSet(LETIMER_TypeDef *letimer, unsigned int comp, uint32_t value);
+uint32_t LETIMER_CompareGet(LETIMER_TypeDef *letimer, unsigned int comp);
+uint32_t LETIMER_CounterGet(LETIMER_TypeDef *letimer);
+void     LETIMER_IntClear(LETIMER_TypeDef *letimer, uint32_t flags);
+void     LETIMER_IntDisable(LETIMER_TypeDef *letimer, uint32_t flags);
+void     LETIMER_IntEnable(LETIMER_TypeDef *letimer, uint32_t flags);
+uint32_t LETIMER_IntGet(LETIMER_TypeDef *letimer);
+uint32_t LETIMER_IntGetEnabled(LETIMER_TypeDef *letimer);
+void     LETIMER_IntSet(LETIMER_TypeDef *letimer, uint32_t flags);
+
+#endif /* TESTS_STUBS_EM_LETIMER_H_ */
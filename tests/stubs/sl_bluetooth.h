@@ -0,0 +1,26 @@
+/* @file      sl_bluetooth.h
+ * @version   1.0
+ * @brief     Host stand-in for the generated sl_bluetooth.h, the stack is tests/fakes/sl_bt_fake.c
+ *
+ * @author    Anuhya Kuraparthy, anuhya.kuraparthy@colorado.edu
+ * @date      Nov 03, 2023
+ *
+ * @institution University of Colorado Boulder (UCB)
+ * @course      ECEN 5823: IoT Embedded Firmware
+ * @instructor  David Sluiter
+ *
+ * @resources  -
+ */
+
+#ifndef BLUETOOTH_H
+#define BLUETOOTH_H
+
+#include <stdbool.h>
+
+#include "sl_power_manager.h"
+#include "sl_bluetooth_connection_config.h"
+#include "sl_bt_api.h"
+
+void sl_bt_on_event(sl_bt_msg_t* evt);
+
+#endif // BLUETOOTH_H
@@ -0,0 +1,38 @@
+/* @file      sl_i2cspm.h
+ * @version   1.0
+ * @brief     Host stand-in for the I2CSPM driver, only initialisation
+ *
+ * @author    Anuhya Kuraparthy, anuhya.kuraparthy@colorado.edu
+ * @date      Nov 03, 2023
+ *
+ * @institution University of Colorado Boulder (UCB)
+ * @course      ECEN 5823: IoT Embedded Firmware
+ * @instructor  David Sluiter
+ *
+ * @resources  -
+ */
+
+#ifndef TESTS_STUBS_SL_I2CSPM_H_
+#define TESTS_STUBS_SL_I2CSPM_H_
+
+#include <stdint.h>
+
+#include "em_gpio.h"
+#include "em_i2c.h"
+
+typedef struct {
+  I2C_TypeDef           *port;
+  GPIO_Port_TypeDef      sclPort;
+  uint8_t                sclPin;
+  GPIO_Port_TypeDef      sdaPort;
+  uint8_t                sdaPin;
+  uint8_t                portLocationScl;
+  uint8_t                portLocationSda;
+  uint32_t               i2cRefFreq;
+  uint32_t               i2cMaxFreq;
+  I2C_ClockHLR_TypeDef   i2cClhr;
+} I2CSPM_Init_TypeDef;
+
+void I2CSPM_Init(I2CSPM_Init_TypeDef *init);
+
+#endif /* TESTS_STUBS_SL_I2CSPM_H_ */
@@ -0,0 +1,20 @@
+/* @file      sl_memlcd_spi.h
+ * @version   1.0
+ * @brief     Host stand-in for the memory LCD SPI driver header, the frames are taken by tests/fakes/memlcd_fake.c
+ *
+ * @author    Anuhya Kuraparthy, anuhya.kuraparthy@colorado.edu
+ * @date      Nov 03, 2023
+ *
+ * @institution University of Colorado Boulder (UCB)
+ * @course      ECEN 5823: IoT Embedded Firmware
+ * @instructor  David Sluiter
+ *
+ * @resources  -
+ */
+
+#ifndef TESTS_STUBS_SL_MEMLCD_SPI_H_
+#define TESTS_STUBS_SL_MEMLCD_SPI_H_
+
+#include "sl_status.h"
+
+#endif /* TESTS_STUBS_SL_MEMLCD_SPI_H_ */
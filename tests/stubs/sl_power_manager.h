@@ -0,0 +1,41 @@
+/* @file      sl_power_manager.h
+ * @version   1.0
+ * @brief     Host stand-in for the power manager, requirements are only counted
+ *
+ * @author    Anuhya Kuraparthy, anuhya.kuraparthy@colorado.edu
+ * @date      Nov 03, 2023
+ *
+ * @institution University of Colorado Boulder (UCB)
+ * @course      ECEN 5823: IoT Embedded Firmware
+ * @instructor  David Sluiter
+ *
+ * @resources  -
+ */
+
+#ifndef TESTS_STUBS_SL_POWER_MANAGER_H_
+#define TESTS_STUBS_SL_POWER_MANAGER_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "em_device.h"
+#include "em_core.h"
+#include "sl_status.h"
+
+typedef enum {
+  SL_POWER_MANAGER_EM0,
+  SL_POWER_MANAGER_EM1,
+  SL_POWER_MANAGER_EM2,
+  SL_POWER_MANAGER_EM3
+} sl_power_manager_em_t;
+
+typedef enum {
+  SL_POWER_MANAGER_IGNORE = (1UL << 0UL),
+  SL_POWER_MANAGER_SLEEP  = (1UL << 1UL),
+  SL_POWER_MANAGER_WAKEUP = (1UL << 2UL)
+} sl_power_manager_on_isr_exit_t;
+
+void sl_power_manager_add_em_requirement(sl_power_manager_em_t em);
+void sl_power_manager_remove_em_requirement(sl_power_manager_em_t em);
+
+#endif /* TESTS_STUBS_SL_POWER_MANAGER_H_ */
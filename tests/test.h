@@ -0,0 +1,66 @@
+/* @file      test.h
+ * @version   1.0
+ * @brief     Minimal check macros for the host tests, each test program
+ *            returns test_result() from main()
+ *
+ * @author    Anuhya Kuraparthy, anuhya.kuraparthy@colorado.edu
+ * @date      Nov 03, 2023
+ *
+ * @institution University of Colorado Boulder (UCB)
+ * @course      ECEN 5823: IoT Embedded Firmware
+ * @instructor  David Sluiter
+ *
+ * @resources  -
+ */
+
+#ifndef TESTS_TEST_H_
+#define TESTS_TEST_H_
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <time.h>
+
+static unsigned int test_checks;
+static unsigned int test_failures;
+
+// a failed check is reported and the test carries on
+#define CHECK(cond)                                                           \
+  do {                                                                        \
+      test_checks++;                                                          \
+      if (!(cond)) {                                                          \
+          test_failures++;                                                    \
+          printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond);     \
+      }                                                                       \
+  } while (0)
+
+#define CHECK_EQ(a, b)                                                        \
+  do {                                                                        \
+      long long _a = (long long) (a);                                         \
+      long long _b = (long long) (b);                                         \
+      test_checks++;                                                          \
+      if (_a != _b) {                                                         \
+          test_failures++;                                                    \
+          printf("%s:%d: CHECK_EQ(%s, %s) failed: %lld != %lld\n",            \
+                 __FILE__, __LINE__, #a, #b, _a, _b);                         \
+      }                                                                       \
+  } while (0)
+
+// print a summary line, the exit status for main()
+static inline int test_result(const char *name)
+{
+  printf("%s: %u checks, %u failed\n", name, test_checks, test_failures);
+
+  return (test_failures == 0) ? 0 : 1;
+}
+
+// host monotonic clock for the benchmarks
+static inline uint64_t test_host_ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  return ((uint64_t) ts.tv_sec * 1000000000u) + (uint64_t) ts.tv_nsec;
+}
+
+#endif /* TESTS_TEST_H_ */
@@ -0,0 +1,183 @@
+/* @file      test_app.c
+ * @version   1.0
+ * @brief     The whole application on the host fakes, built once per device
+ *            role with -DDEVICE_IS_BLE_SERVER=1 or 0. Checks it talks to the
+ *            stack and peripherals the way the real ones require and reports
+ *            how much work a simulated minute costs.
+ *
+ * @author    Anuhya Kuraparthy, anuhya.kuraparthy@colorado.edu
+ * @date      Nov 03, 2023
+ *
+ * @institution University of Colorado Boulder (UCB)
+ * @course      ECEN 5823: IoT Embedded Firmware
+ * @instructor  David Sluiter
+ *
+ * @resources  -
+ */
+
+#include "sl_bt_api.h"
+#include "gatt_db.h"
+#include "app.h"
+
+#include "src/ble.h"
+#include "src/ble_device_type.h"
+#include "src/gpio.h"
+
+#include "hw_fake.h"
+#include "memlcd_fake.h"
+#include "sl_bt_fake.h"
+#include "test.h"
+
+#define SECOND_US       (1000000u)
+
+
+static void reset(void)
+{
+  fake_hw_reset();
+  fake_bt_reset();
+  fake_memlcd_reset();
+}
+
+// as main(): app_init() runs before the stack delivers its boot event
+static void boot(void)
+{
+  app_init();
+  fake_bt_boot();
+}
+
+static void report(const char *name, uint64_t simulated_us, uint64_t host_ns)
+{
+  printf("%s: %" PRIu32 " events, %" PRIu32 " LETIMER0 and %" PRIu32 " I2C0 interrupts, "
+         "%" PRIu32 " LCD frames, %" PRIu64 " ms in EM1 over %" PRIu64 " s, %.0f events/s on the host\n",
+         name, fake_bt_stats.events, fake_irq_count[LETIMER0_IRQn], fake_irq_count[I2C0_IRQn],
+         fake_memlcd_stats.frames, fake_power.em1_us / 1000, simulated_us / SECOND_US,
+         (double) fake_bt_stats.events * 1e9 / (double) (host_ns ? host_ns : 1));
+}
+
+
+#if DEVICE_IS_BLE_SERVER
+
+static void test_server(void)
+{
+  uint64_t start_ns;
+  uint32_t indications, measurements;
+  uint8_t  connection;
+  uint8_t  others[BLE_MAX_CONNECTIONS - 1];
+
+  reset();
+  boot();
+  start_ns = test_host_ns();
+  fake_bt_run_us(SECOND_US);
+
+  CHECK_EQ(fake_bt_stats.advertiser_starts, 1);
+  CHECK_EQ(fake_bt_stats.soft_timers, 1);
+
+  // nobody subscribed, nothing to measure
+  fake_bt_run_us(10 * SECOND_US);
+  CHECK_EQ(fake_si7021.measurements, 0);
+
+  // still advertising for the next central
+  connection = fake_bt_client_connect(247, 60);
+  fake_bt_run_us(SECOND_US);
+  CHECK_EQ(fake_bt_stats.advertiser_starts, 2);
+
+  fake_bt_client_config(connection, gattdb_temperature_measurement, sl_bt_gatt_server_indication);
+  fake_bt_run_us(60 * SECOND_US);
+
+  // one reading every LETIMER_PERIOD_MS
+  measurements = fake_si7021.measurements;
+  indications = fake_bt_stats.indications;
+  CHECK(measurements >= (60000 / LETIMER_PERIOD_MS) - 1);
+  CHECK(indications >= measurements - 1);
+  CHECK_EQ(fake_si7021.nacks, 0);
+
+  // button indications once bonded
+  fake_bt_client_config(connection, gattdb_button_state, sl_bt_gatt_server_indication);
+  fake_bt_bond(connection);
+  fake_bt_run_us(SECOND_US);
+  indications = fake_bt_stats.indications;
+  fake_gpio_button(button_port, button_pin, true);
+  fake_bt_run_us(SECOND_US / 10);
+  fake_gpio_button(button_port, button_pin, false);
+  fake_bt_run_us(SECOND_US / 2);
+  CHECK(fake_bt_stats.indications >= indications + 2);
+
+  // advertising stops once every connection is taken
+  for (uint32_t i = 0; i < BLE_MAX_CONNECTIONS - 1; i++) {
+      others[i] = fake_bt_client_connect(23, 60);
+      fake_bt_run_us(SECOND_US / 2);
+  }
+  CHECK_EQ(fake_bt_stats.advertiser_stops, 1);
+  CHECK_EQ(fake_bt_stats.advertiser_starts, BLE_MAX_CONNECTIONS);
+
+  // and starts again when one is free
+  fake_bt_disconnect(connection);
+  fake_bt_run_us(SECOND_US);
+  CHECK_EQ(fake_bt_stats.advertiser_starts, BLE_MAX_CONNECTIONS + 1);
+
+  // nobody subscribed any more, measurements stop
+  for (uint32_t i = 0; i < BLE_MAX_CONNECTIONS - 1; i++) {
+      fake_bt_disconnect(others[i]);
+  }
+  fake_bt_run_us(SECOND_US);
+  measurements = fake_si7021.measurements;
+  fake_bt_run_us(10 * SECOND_US);
+  CHECK(fake_si7021.measurements <= measurements + 1);
+
+  CHECK_EQ(fake_bt_stats.protocol_errors, 0);
+  CHECK_EQ(fake_power.underflows, 0);
+  CHECK_EQ(fake_memlcd_stats.busy, 0);
+  CHECK(fake_memlcd_stats.frames > 0);
+
+  report("server", fake_now_us(), test_host_ns() - start_ns);
+}
+
+#else
+
+static void test_client(void)
+{
+  static const bd_addr server = SERVER_BT_ADDRESS;
+  uint64_t start_ns;
+  uint32_t confirmations;
+
+  reset();
+  fake_bt_add_server(&server, 1000, 21500);
+  boot();
+  start_ns = test_host_ns();
+
+  fake_bt_run_us(5 * SECOND_US);
+  CHECK_EQ(fake_bt_stats.connection_opens, 1);
+  CHECK_EQ(fake_bt_servers_indicating(), 1);
+  CHECK(fake_bt_stats.scanner_starts >= 1);
+
+  // every indication confirmed before the Server sends the next
+  confirmations = fake_bt_stats.confirmations;
+  fake_bt_run_us(30 * SECOND_US);
+  CHECK(fake_bt_stats.confirmations >= confirmations + 29);
+  CHECK_EQ(fake_bt_stats.confirmations, fake_bt_stats.peer_indications);
+
+  // the client itself never measures
+  CHECK_EQ(fake_si7021.measurements, 0);
+
+  CHECK_EQ(fake_bt_stats.protocol_errors, 0);
+  CHECK_EQ(fake_power.underflows, 0);
+  CHECK_EQ(fake_memlcd_stats.busy, 0);
+
+  report("client", fake_now_us(), test_host_ns() - start_ns);
+}
+
+#endif
+
+
+int main(void)
+{
+#if DEVICE_IS_BLE_SERVER
+  test_server();
+
+  return test_result("test_app_server");
+#else
+  test_client();
+
+  return test_result("test_app_client");
+#endif
+}
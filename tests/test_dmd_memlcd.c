@@ -0,0 +1,221 @@
+/* @file      test_dmd_memlcd.c
+ * @version   1.0
+ * @brief     Host tests for the 32-bit DMD_writeData() in the SDK's
+ *            dmd_memlcd.c: randomized equivalence with the byte at a time
+ *            DMD_MEMLCD_REFERENCE_WRITE_DATA build, writeDataRow() and
+ *            readDataBits() against a pixel by pixel model, and the time
+ *            both builds take per call
+ *
+ * @author    Anuhya Kuraparthy, anuhya.kuraparthy@colorado.edu
+ * @date      Nov 03, 2023
+ *
+ * @institution University of Colorado Boulder (UCB)
+ * @course      ECEN 5823: IoT Embedded Firmware
+ * @instructor  David Sluiter
+ *
+ * @resources  -
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+// the file itself, for its static writeDataRow() and readDataBits()
+#include "dmd_memlcd.c"
+
+#include "dmd_memlcd_reference.h"
+#include "hw_fake.h"
+#include "memlcd_fake.h"
+#include "test.h"
+
+#define WIDTH         (SL_MEMLCD_DISPLAY_WIDTH)
+#define HEIGHT        (SL_MEMLCD_DISPLAY_HEIGHT)
+#define ROW_BYTES     (WIDTH / 8)
+#define FB_BYTES      (ROW_BYTES * HEIGHT)
+
+#define RUNS          (100000)
+#define BENCH_CALLS   (20000)
+
+static uint32_t seed = 2023;
+
+// keeps the timed calls from being optimised away
+static volatile uint32_t bench_sink;
+
+
+static uint32_t random32(void)
+{
+  // xorshift32
+  seed ^= seed << 13;
+  seed ^= seed >> 17;
+  seed ^= seed << 5;
+
+  return seed;
+}
+
+// 0..n-1
+static uint32_t random_below(uint32_t n)
+{
+  return random32() % n;
+}
+
+// exactly len random bytes on the heap, so ASan sees any read past them
+static uint8_t *random_bytes(size_t len)
+{
+  uint8_t *p = malloc(len ? len : 1);
+
+  for (size_t i = 0; i < len; i++) {
+      p[i] = (uint8_t) random32();
+  }
+
+  return p;
+}
+
+static unsigned int bit_of(const uint8_t data[], unsigned int bit)
+{
+  return (data[bit >> 3] >> (bit & 0x7)) & 0x1;
+}
+
+
+// readDataBits() for every alignment and length, reading no byte past the
+// last bit
+static void test_read_data_bits(void)
+{
+  uint32_t mismatches = 0;
+
+  for (uint32_t run = 0; run < RUNS; run++) {
+      unsigned int bit     = random_below(256);
+      unsigned int numBits = 1 + random_below(32);
+      uint8_t     *data    = random_bytes((bit + numBits + 7) / 8);
+      uint32_t     expected = 0;
+
+      for (unsigned int i = 0; i < numBits; i++) {
+          expected |= (uint32_t) bit_of(data, bit + i) << i;
+      }
+      mismatches += (readDataBits(data, bit, numBits) != expected);
+
+      free(data);
+  }
+
+  CHECK_EQ(mismatches, 0);
+}
+
+// writeDataRow() for random x, pixelBit and rowPixels on a random line,
+// writing no byte outside the line
+static void test_write_data_row(void)
+{
+  uint32_t mismatches = 0;
+
+  for (uint32_t run = 0; run < RUNS; run++) {
+      unsigned int x         = random_below(WIDTH);
+      unsigned int rowPixels = 1 + random_below(WIDTH - x);
+      unsigned int pixelBit  = random_below(1024);
+      uint8_t     *data      = random_bytes((pixelBit + rowPixels + 7) / 8);
+      uint8_t     *line      = random_bytes(ROW_BYTES);
+      uint8_t      expected[ROW_BYTES];
+
+      memcpy(expected, line, ROW_BYTES);
+      for (unsigned int i = 0; i < rowPixels; i++) {
+          unsigned int px = x + i;
+
+          expected[px >> 3] &= (uint8_t) ~(1u << (px & 0x7));
+          expected[px >> 3] |= (uint8_t) (bit_of(data, pixelBit + i) << (px & 0x7));
+      }
+
+      writeDataRow(line, x, data, pixelBit, rowPixels);
+      mismatches += (memcmp(line, expected, ROW_BYTES) != 0);
+
+      free(line);
+      free(data);
+  }
+
+  CHECK_EQ(mismatches, 0);
+}
+
+// DMD_writeData() against the reference build through random clipping
+// areas, so every row after the first starts at its own x and pixelBit
+static void test_equivalence(void)
+{
+  uint8_t  *fb, *ref_fb;
+  uint32_t  mismatches = 0, status_mismatches = 0;
+
+  CHECK_EQ(DMD_init(0), DMD_OK);
+  CHECK_EQ(ref_DMD_init(0), DMD_OK);
+  DMD_getFrameBuffer((void **) &fb);
+  ref_DMD_getFrameBuffer((void **) &ref_fb);
+
+  for (uint32_t run = 0; run < RUNS; run++) {
+      uint16_t  xStart = (uint16_t) random_below(WIDTH);
+      uint16_t  yStart = (uint16_t) random_below(HEIGHT);
+      uint16_t  width  = (uint16_t) (1 + random_below(WIDTH - xStart));
+      uint16_t  height = (uint16_t) (1 + random_below(HEIGHT - yStart));
+      uint16_t  x      = (uint16_t) random_below(width);
+      uint16_t  y      = (uint16_t) random_below(height);
+      uint32_t  left   = ((uint32_t) (height - y) * width) - x;
+      uint32_t  numPixels = 1 + random_below((left < 4 * WIDTH) ? left : 4 * WIDTH);
+      uint8_t  *data   = random_bytes((numPixels + 7) / 8);
+
+      for (uint32_t i = 0; i < FB_BYTES; i++) {
+          fb[i] = ref_fb[i] = (uint8_t) random32();
+      }
+
+      DMD_setClippingArea(xStart, yStart, width, height);
+      ref_DMD_setClippingArea(xStart, yStart, width, height);
+
+      status_mismatches += (DMD_writeData(x, y, data, numPixels) != ref_DMD_writeData(x, y, data, numPixels));
+      mismatches += (memcmp(fb, ref_fb, FB_BYTES) != 0);
+
+      free(data);
+  }
+
+  CHECK_EQ(status_mismatches, 0);
+  CHECK_EQ(mismatches, 0);
+
+  DMD_setClippingArea(0, 0, WIDTH, HEIGHT);
+  ref_DMD_setClippingArea(0, 0, WIDTH, HEIGHT);
+}
+
+
+// host time per DMD_writeData() call in both builds
+static void bench(const char *name, uint16_t x, uint16_t y, uint32_t numPixels)
+{
+  static uint8_t data[FB_BYTES];
+  uint64_t       start_ns, fast_ns, ref_ns;
+
+  start_ns = test_host_ns();
+  for (uint32_t i = 0; i < BENCH_CALLS; i++) {
+      bench_sink += DMD_writeData(x, y, data, numPixels);
+  }
+  fast_ns = test_host_ns() - start_ns;
+
+  start_ns = test_host_ns();
+  for (uint32_t i = 0; i < BENCH_CALLS; i++) {
+      bench_sink += ref_DMD_writeData(x, y, data, numPixels);
+  }
+  ref_ns = test_host_ns() - start_ns;
+
+  printf("%-24s %8.1f ns reference, %8.1f ns 32-bit, %.1fx\n", name,
+         (double) ref_ns / BENCH_CALLS, (double) fast_ns / BENCH_CALLS,
+         (double) ref_ns / (double) (fast_ns ? fast_ns : 1));
+}
+
+static void test_bench(void)
+{
+  // a glyph row at a character cell, the GLIB text path
+  bench("6 pixel glyph row", 39, 70, 6);
+  // a 20 character row, unaligned after the first 8 cells
+  bench("120 pixel text row", 3, 70, 120);
+  bench("full frame", 0, 0, WIDTH * HEIGHT);
+}
+
+
+int main(void)
+{
+  fake_hw_reset();
+  fake_memlcd_reset();
+
+  test_read_data_bits();
+  test_write_data_row();
+  test_equivalence();
+  test_bench();
+
+  return test_result("test_dmd_memlcd");
+}
@@ -0,0 +1,104 @@
+/* @file      test_fsm.c
+ * @version   1.0
+ * @brief     Host tests for the table driven state machine, src/fsm.c
+ *
+ * @author    Anuhya Kuraparthy, anuhya.kuraparthy@colorado.edu
+ * @date      Nov 03, 2023
+ *
+ * @institution University of Colorado Boulder (UCB)
+ * @course      ECEN 5823: IoT Embedded Firmware
+ * @instructor  David Sluiter
+ *
+ * @resources  -
+ */
+
+#include "src/fsm.h"
+
+#include "hw_fake.h"
+#include "test.h"
+
+enum { ST_IDLE, ST_RUN, ST_DONE, NUM_STATES };
+enum { EV_GO, EV_TICK, EV_STOP, NUM_EVENTS };
+
+typedef struct {
+  uint32_t  ticks;
+  uint32_t  actions;
+} ctx_t;
+
+static uint8_t do_step(void *ctx, sl_bt_msg_t *evt, uint8_t next_state)
+{
+  (void) evt;
+
+  ((ctx_t *) ctx)->actions++;
+
+  return next_state;
+}
+
+// stays in ST_RUN until the third tick
+static uint8_t do_tick(void *ctx, sl_bt_msg_t *evt, uint8_t next_state)
+{
+  ctx_t *c = ctx;
+
+  (void) evt;
+
+  c->actions++;
+
+  return (++c->ticks < 3) ? ST_RUN : next_state;
+}
+
+static const fsm_transition_t table[NUM_STATES * NUM_EVENTS] = {
+  FSM_TRANSITION(NUM_EVENTS, ST_IDLE, EV_GO,   do_step, ST_RUN)
+  FSM_TRANSITION(NUM_EVENTS, ST_RUN,  EV_TICK, do_tick, ST_DONE)
+  FSM_TRANSITION(NUM_EVENTS, ST_RUN,  EV_STOP, do_step, ST_IDLE)
+};
+
+static fsm_stats_t stats[NUM_STATES * NUM_EVENTS];
+
+static const fsm_t machine = {
+  .name       = "test",
+  .table      = table,
+  .stats      = stats,
+  .num_states = NUM_STATES,
+  .num_events = NUM_EVENTS,
+};
+
+
+int main(void)
+{
+  ctx_t   ctx = { 0 };
+  uint8_t state = ST_IDLE;
+
+  fake_hw_reset();
+  fsm_init();
+
+  // no entry: the event is ignored
+  state = fsm_dispatch(&machine, state, EV_TICK, &ctx, NULL);
+  CHECK_EQ(state, ST_IDLE);
+  CHECK_EQ(ctx.actions, 0);
+
+  state = fsm_dispatch(&machine, state, EV_GO, &ctx, NULL);
+  CHECK_EQ(state, ST_RUN);
+
+  // the action picks the state
+  state = fsm_dispatch(&machine, state, EV_TICK, &ctx, NULL);
+  CHECK_EQ(state, ST_RUN);
+  state = fsm_dispatch(&machine, state, EV_TICK, &ctx, NULL);
+  CHECK_EQ(state, ST_RUN);
+  state = fsm_dispatch(&machine, state, EV_TICK, &ctx, NULL);
+  CHECK_EQ(state, ST_DONE);
+
+  // out of range state or event leaves the state alone
+  CHECK_EQ(fsm_dispatch(&machine, NUM_STATES, EV_GO, &ctx, NULL), NUM_STATES);
+  CHECK_EQ(fsm_dispatch(&machine, ST_IDLE, NUM_EVENTS, &ctx, NULL), ST_IDLE);
+
+  CHECK_EQ(ctx.actions, 4);
+  CHECK_EQ(stats[(ST_IDLE * NUM_EVENTS) + EV_GO].count, 1);
+  CHECK_EQ(stats[(ST_RUN * NUM_EVENTS) + EV_TICK].count, 3);
+  CHECK_EQ(stats[(ST_RUN * NUM_EVENTS) + EV_STOP].count, 0);
+  CHECK(stats[(ST_RUN * NUM_EVENTS) + EV_TICK].max_cycles <=
+        stats[(ST_RUN * NUM_EVENTS) + EV_TICK].total_cycles);
+
+  fsm_log_stats(&machine);
+
+  return test_result("test_fsm");
+}
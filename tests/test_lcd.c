@@ -0,0 +1,186 @@
+/* @file      test_lcd.c
+ * @version   1.0
+ * @brief     Host tests for the LCD row redraws in src/lcd.c, through GLIB
+ *            and the DMD frame buffer onto the memory LCD fake. Counts the
+ *            pixels each typical update changes and the SPI bytes it costs.
+ *
+ * @author    Anuhya Kuraparthy, anuhya.kuraparthy@colorado.edu
+ * @date      Nov 03, 2023
+ *
+ * @institution University of Colorado Boulder (UCB)
+ * @course      ECEN 5823: IoT Embedded Firmware
+ * @instructor  David Sluiter
+ *
+ * @resources  -
+ */
+
+#include <string.h>
+
+#include "sl_bt_api.h"
+#include "sl_memlcd.h"
+
+#include "src/lcd.h"
+#include "src/workq.h"
+
+#include "hw_fake.h"
+#include "memlcd_fake.h"
+#include "test.h"
+
+// one text row of the 6x8 narrow font, 2 blank lines between rows
+#define TEXT_ROW_LINES      (8)
+#define TEXT_ROW_PITCH      (TEXT_ROW_LINES + 2)
+#define FRAME_BYTES(rows)   (4 + ((rows) * (FAKE_MEMLCD_ROW_BYTES + 2)) - 2)
+// one character cell
+#define CELL_PIXELS         (6 * 8)
+
+
+// the stack is not linked, displayInit() starts the EXTCOMIN timer here
+sl_status_t sl_bt_system_set_soft_timer(uint32_t time, uint8_t handle, uint8_t single_shot)
+{
+  return SL_STATUS_OK;
+}
+
+// as in irq.c
+void USART1_TX_IRQHandler(void)
+{
+  sl_memlcd_tx_irq_handler();
+}
+
+
+// run the redraws app_process_action() would, and the SPI transfer they start
+static void flush(void)
+{
+  while (workq_pending()) {
+      workq_run();
+      fake_hw_advance_to(fake_now_us() + 100000);
+  }
+}
+
+// cost of everything printed since the last call, printed and returned in stats
+static void measure(const char *name, fake_memlcd_stats_t *stats)
+{
+  flush();
+
+  *stats = fake_memlcd_stats;
+  printf("%-28s %5" PRIu32 " pixels changed, %3" PRIu32 " rows, %4" PRIu32 " SPI bytes in %" PRIu32 " frames\n",
+         name, stats->pixels_changed, stats->rows, stats->spi_bytes, stats->frames);
+
+  memset(&fake_memlcd_stats, 0, sizeof(fake_memlcd_stats));
+}
+
+// lit pixels in the text row of the panel, the frame buffer is 1 for white
+static uint32_t row_ink(int row)
+{
+  uint32_t ink = 0;
+
+  for (int line = row * TEXT_ROW_PITCH; line < (row * TEXT_ROW_PITCH) + TEXT_ROW_LINES; line++) {
+      for (int i = 0; i < FAKE_MEMLCD_ROW_BYTES; i++) {
+          ink += (uint32_t) __builtin_popcount((uint8_t) ~fake_memlcd_panel[line][i]);
+      }
+  }
+
+  return ink;
+}
+
+
+static void test_updates(void)
+{
+  fake_memlcd_stats_t stats;
+  uint32_t            ink;
+
+  fake_hw_reset();
+  fake_memlcd_reset();
+  NVIC_EnableIRQ(USART1_TX_IRQn);
+
+  displayInit();
+  measure("init", &stats);
+  CHECK_EQ(stats.rows, FAKE_MEMLCD_HEIGHT);
+
+  // the boot screen, one frame for all of it
+  displayPrintf(DISPLAY_ROW_NAME, "Server");
+  displayPrintf(DISPLAY_ROW_BTADDR, "00:0B:57:0F:A2:14");
+  displayPrintf(DISPLAY_ROW_CONNECTION, "Advertising");
+  displayPrintf(DISPLAY_ROW_ASSIGNMENT, "Course Project");
+  measure("boot screen", &stats);
+  CHECK_EQ(stats.frames, 1);
+  CHECK_EQ(stats.rows, 4 * TEXT_ROW_LINES);
+  CHECK_EQ(stats.spi_bytes, FRAME_BYTES(4 * TEXT_ROW_LINES));
+  CHECK(stats.pixels_changed > 0);
+
+  // a new temperature, then one digit of it changes
+  displayPrintf(DISPLAY_ROW_TEMPVALUE, "Temp=%d", 25);
+  measure("first temperature", &stats);
+  CHECK_EQ(stats.rows, TEXT_ROW_LINES);
+  ink = row_ink(DISPLAY_ROW_TEMPVALUE);
+  CHECK_EQ(stats.pixels_changed, ink);
+
+  displayPrintf(DISPLAY_ROW_TEMPVALUE, "Temp=%d", 26);
+  measure("one digit changes", &stats);
+  CHECK_EQ(stats.frames, 1);
+  CHECK(stats.rows <= TEXT_ROW_LINES);
+  CHECK(stats.pixels_changed > 0);
+  CHECK(stats.pixels_changed <= CELL_PIXELS);
+  CHECK_EQ(stats.spi_bytes, FRAME_BYTES(stats.rows));
+
+  // the same text again costs nothing
+  displayPrintf(DISPLAY_ROW_TEMPVALUE, "Temp=%d", 26);
+  measure("same temperature", &stats);
+  CHECK_EQ(stats.frames, 0);
+  CHECK_EQ(stats.spi_bytes, 0);
+
+  // printed and put back before the redraw ran
+  displayPrintf(DISPLAY_ROW_TEMPVALUE, "Temp=%d", 27);
+  displayPrintf(DISPLAY_ROW_TEMPVALUE, "Temp=%d", 26);
+  measure("changed and changed back", &stats);
+  CHECK_EQ(stats.frames, 0);
+
+  // one character longer moves the centred text half a cell
+  displayPrintf(DISPLAY_ROW_TEMPVALUE, "Temp=%d", 100);
+  measure("half a cell shift", &stats);
+  CHECK_EQ(stats.frames, 1);
+  CHECK_EQ(stats.rows, TEXT_ROW_LINES);
+
+  // two characters shorter is a whole cell: only the changed cells
+  displayPrintf(DISPLAY_ROW_TEMPVALUE, "Temp=%d", 1);
+  measure("whole cell shift", &stats);
+  CHECK_EQ(stats.frames, 1);
+  CHECK(stats.rows <= TEXT_ROW_LINES);
+
+  // a connection: four rows change together
+  displayPrintf(DISPLAY_ROW_CONNECTION, "Connected");
+  displayPrintf(DISPLAY_ROW_CLIENTADDR, "E4:5F:01:2A:33:9C");
+  displayPrintf(DISPLAY_ROW_PASSKEY, "Passkey %06d", 123456);
+  displayPrintf(DISPLAY_ROW_ACTION, "Confirm with PB0");
+  measure("connection", &stats);
+  CHECK_EQ(stats.frames, 1);
+  CHECK(stats.rows <= 4 * TEXT_ROW_LINES);
+
+  // rows printed while a frame is on the wire go out in the next one
+  displayPrintf(DISPLAY_ROW_PASSKEY, " ");
+  workq_run();
+  CHECK_EQ(fake_memlcd_stats.frames, 0);
+  for (int t = 0; t < 5; t++) {
+      displayPrintf(DISPLAY_ROW_TEMPVALUE, "Temp=%d", 20 + t);
+      workq_run();
+  }
+  displayPrintf(DISPLAY_ROW_ACTION, " ");
+  measure("prints during a transfer", &stats);
+  CHECK_EQ(stats.frames, 2);
+  CHECK_EQ(stats.busy, 0);
+  CHECK_EQ(row_ink(DISPLAY_ROW_PASSKEY), 0);
+  CHECK_EQ(row_ink(DISPLAY_ROW_ACTION), 0);
+
+  // erase a row
+  displayPrintf(DISPLAY_ROW_CLIENTADDR, "");
+  measure("erase a row", &stats);
+  CHECK_EQ(row_ink(DISPLAY_ROW_CLIENTADDR), 0);
+  CHECK(stats.rows <= TEXT_ROW_LINES);
+}
+
+
+int main(void)
+{
+  test_updates();
+
+  return test_result("test_lcd");
+}
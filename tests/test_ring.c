@@ -0,0 +1,155 @@
+/* @file      test_ring.c
+ * @version   1.0
+ * @brief     Host tests for the record ring buffer, src/ring.c
+ *
+ * @author    Anuhya Kuraparthy, anuhya.kuraparthy@colorado.edu
+ * @date      Nov 03, 2023
+ *
+ * @institution University of Colorado Boulder (UCB)
+ * @course      ECEN 5823: IoT Embedded Firmware
+ * @instructor  David Sluiter
+ *
+ * @resources  -
+ */
+
+#include <string.h>
+
+#include "src/ring.h"
+
+#include "test.h"
+
+
+static void test_init(void)
+{
+  uint8_t storage[64];
+  ring_t  ring;
+
+  CHECK(ring_init(&ring, storage, 0, 0));
+  CHECK(ring_init(&ring, storage, 48, 8));
+
+  // a max_len record has to fit, and its length has to fit the header
+  CHECK(ring_init(&ring, storage, sizeof(storage), sizeof(storage) - RING_RECORD_HEADER_LEN + 1));
+  CHECK(ring_init(&ring, storage, 1024, RING_MAX_PAYLOAD_LEN + 1));
+
+  CHECK(!ring_init(&ring, storage, sizeof(storage), sizeof(storage) - RING_RECORD_HEADER_LEN));
+  CHECK(ring_is_empty(&ring));
+}
+
+static void test_put_get(void)
+{
+  static uint8_t storage[64];
+  ring_t         ring = RING_INIT(storage, 8);
+  uint8_t        in[8] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+  uint8_t        out[8];
+  uint16_t       tag;
+  size_t         len;
+
+  CHECK(ring_get(&ring, &tag, out, &len, sizeof(out)));
+
+  CHECK(!ring_put(&ring, 0x1234, in, sizeof(in)));
+  CHECK(!ring_put(&ring, 0xBEEF, in, 3));
+  CHECK(!ring_put(&ring, 7, in, 0));
+  CHECK(!ring_is_empty(&ring));
+
+  // peek leaves the record in place
+  CHECK(!ring_peek(&ring, &tag, out, &len, sizeof(out)));
+  CHECK(!ring_get(&ring, &tag, out, &len, sizeof(out)));
+  CHECK_EQ(tag, 0x1234);
+  CHECK_EQ(len, sizeof(in));
+  CHECK(memcmp(in, out, sizeof(in)) == 0);
+
+  CHECK(!ring_get(&ring, &tag, out, &len, sizeof(out)));
+  CHECK_EQ(tag, 0xBEEF);
+  CHECK_EQ(len, 3);
+
+  CHECK(!ring_get(&ring, &tag, out, &len, sizeof(out)));
+  CHECK_EQ(tag, 7);
+  CHECK_EQ(len, 0);
+
+  CHECK(ring_is_empty(&ring));
+}
+
+static void test_full(void)
+{
+  static uint8_t storage[32];
+  ring_t         ring = RING_INIT(storage, 13);
+  uint8_t        in[14] = { 0 };
+
+  // two 16 byte records fill it exactly
+  CHECK(!ring_put(&ring, 1, in, 13));
+  CHECK(!ring_put(&ring, 2, in, 13));
+  CHECK(ring_put(&ring, 3, in, 0));
+
+  ring_drop(&ring);
+  CHECK(!ring_put(&ring, 3, in, 13));
+
+  ring_reset(&ring);
+  CHECK(ring_is_empty(&ring));
+  ring_drop(&ring);
+  CHECK(ring_is_empty(&ring));
+}
+
+// producer and consumer agree on the longest record: one the consumer
+// could not read is refused up front instead of blocking the ring
+static void test_max_len(void)
+{
+  static uint8_t storage[1024];
+  ring_t         ring;
+  uint8_t        in[RING_MAX_PAYLOAD_LEN] = { 0 };
+  uint8_t        out[244];
+  uint16_t       tag;
+  size_t         len;
+
+  CHECK(!ring_init(&ring, storage, sizeof(storage), sizeof(out)));
+
+  for (size_t n = sizeof(out) + 1; n <= RING_MAX_PAYLOAD_LEN; n++) {
+      CHECK(ring_put(&ring, 1, in, n));
+  }
+  CHECK(ring_is_empty(&ring));
+
+  CHECK(!ring_put(&ring, 2, in, sizeof(out)));
+  CHECK(!ring_put(&ring, 3, in, 1));
+  CHECK(!ring_get(&ring, &tag, out, &len, sizeof(out)));
+  CHECK_EQ(tag, 2);
+  CHECK_EQ(len, sizeof(out));
+  CHECK(!ring_get(&ring, &tag, out, &len, sizeof(out)));
+  CHECK_EQ(tag, 3);
+}
+
+// records of every length wrap the end of the storage at every offset
+static void test_wrap(void)
+{
+  static uint8_t storage[64];
+  ring_t         ring = RING_INIT(storage, 40);
+  uint8_t        in[40], out[40];
+  uint16_t       tag;
+  size_t         len;
+
+  for (uint32_t i = 0; i < 2000; i++) {
+      size_t n = (i * 7) % sizeof(in);
+
+      for (size_t j = 0; j < n; j++) {
+          in[j] = (uint8_t) (i + j);
+      }
+
+      CHECK(!ring_put(&ring, (uint16_t) i, in, n));
+      CHECK(!ring_get(&ring, &tag, out, &len, sizeof(out)));
+      CHECK_EQ(tag, (uint16_t) i);
+      CHECK_EQ(len, n);
+      CHECK(memcmp(in, out, n) == 0);
+  }
+
+  CHECK(ring_is_empty(&ring));
+}
+
+
+int main(void)
+{
+  test_init();
+  test_put_get();
+  test_full();
+  test_max_len();
+  test_wrap();
+
+  return test_result("test_ring");
+}
@@ -0,0 +1,141 @@
+/* @file      test_si7021.c
+ * @version   1.0
+ * @brief     Host tests for the Si7021 conversions and the queued I2C
+ *            transfers in src/i2c.c
+ *
+ * @author    Anuhya Kuraparthy, anuhya.kuraparthy@colorado.edu
+ * @date      Nov 03, 2023
+ *
+ * @institution University of Colorado Boulder (UCB)
+ * @course      ECEN 5823: IoT Embedded Firmware
+ * @instructor  David Sluiter
+ *
+ * @resources  -
+ */
+
+#include <math.h>
+
+#include "em_i2c.h"
+
+#include "src/i2c.h"
+
+#include "hw_fake.h"
+#include "test.h"
+
+extern uint8_t read_data[2];
+
+static uint32_t   transfer_events;
+
+
+// the scheduler is not linked, count what the I2C driver hands it
+void schedulerSetEventI2CTransfer(void)   { transfer_events++; }
+
+// as in irq.c
+void I2C0_IRQHandler(void)
+{
+  I2C_TransferReturn_TypeDef transferStatus = I2C_Transfer(I2C0);
+
+  if (transferStatus != i2cTransferInProgress) {
+      i2c_transfer_done(transferStatus);
+  }
+}
+
+
+static int32_t temp_of(uint16_t code)
+{
+  read_data[0] = (uint8_t) (code >> 8);
+  read_data[1] = (uint8_t) code;
+
+  return read_temp_from_si7021();
+}
+
+static void test_temperature(void)
+{
+  uint32_t mismatches = 0;
+
+  CHECK_EQ(temp_of(0), -46850);
+  CHECK_EQ(temp_of(26797), 25000);
+  CHECK_EQ(temp_of(65535), 128867);
+
+  // exact halves below 0 C round away from zero
+  CHECK_EQ(temp_of(4096), -35868);
+  CHECK_EQ(temp_of(12288), -13903);
+
+  // every code against lround() of the datasheet formula. It is scaled to
+  // milli-degrees first: 175.72 and 46.85 have no exact double, and with
+  // them lround(1000 * (175.72 * 28672 / 65536 - 46.85)) sees 30027.4999..
+  // for the exact half 30027.5. Scaled, every step is exact.
+  for (uint32_t code = 0; code <= 0xFFFF; code++) {
+      long expected = lround(175720.0 * code / 65536 - 46850);
+
+      if (temp_of((uint16_t) code) != expected) {
+          if (mismatches++ == 0) {
+              printf("code %u: %d, lround() gives %ld\n",
+                     (unsigned int) code, (int) temp_of((uint16_t) code), expected);
+          }
+      }
+  }
+  CHECK_EQ(mismatches, 0);
+}
+
+
+// one measurement through the queue, as the temperature state machine runs it
+static void measure(void)
+{
+  uint32_t events = transfer_events;
+
+  i2c_write();
+  fake_hw_advance_to(fake_now_us() + 1000);
+  CHECK_EQ(transfer_events, events + 1);
+
+  fake_hw_advance_to(fake_now_us() + SI7021_CONVERSION_US);
+  i2c_read();
+  fake_hw_advance_to(fake_now_us() + 2000);
+  CHECK_EQ(transfer_events, events + 2);
+}
+
+static void test_measurement(void)
+{
+  fake_hw_reset();
+  initI2C();
+
+  fake_si7021.temp_code = 26797;
+  fake_si7021.rh_code = 29360;
+  measure();
+
+  CHECK_EQ(read_temp_from_si7021(), 25000);
+#if SI7021_MEASURE_HUMIDITY
+  CHECK_EQ(read_humidity_from_si7021(), 50000);
+#endif
+  CHECK_EQ(fake_si7021.user_reg & 0x81, SI7021_RESOLUTION);
+  CHECK_EQ(fake_si7021.nacks, 0);
+
+  // EM1 only while the queue is busy
+  CHECK_EQ(fake_power.em1_requirements, 0);
+  CHECK_EQ(fake_power.underflows, 0);
+  CHECK(!fake_irq_enabled(I2C0_IRQn));
+
+  // a second measurement does not write the user register again
+  fake_si7021.user_reg = 0;
+  measure();
+  CHECK_EQ(fake_si7021.user_reg, 0);
+
+#if SI7021_MEASURE_HUMIDITY
+  // clamped at the ends of the range
+  fake_si7021.rh_code = 0;
+  measure();
+  CHECK_EQ(read_humidity_from_si7021(), 0);
+  fake_si7021.rh_code = 0xFFFF;
+  measure();
+  CHECK_EQ(read_humidity_from_si7021(), 100000);
+#endif
+}
+
+
+int main(void)
+{
+  test_temperature();
+  test_measurement();
+
+  return test_result("test_si7021");
+}
@@ -0,0 +1,369 @@
+/* @file      test_timers.c
+ * @version   1.0
+ * @brief     Host tests for the LETIMER0 tick conversions and the software
+ *            timers in src/timers.c
+ *
+ * @author    Anuhya Kuraparthy, anuhya.kuraparthy@colorado.edu
+ * @date      Nov 03, 2023
+ *
+ * @institution University of Colorado Boulder (UCB)
+ * @course      ECEN 5823: IoT Embedded Firmware
+ * @instructor  David Sluiter
+ *
+ * @resources  -
+ */
+
+#include "em_core.h"
+#include "em_letimer.h"
+#include "app.h"
+
+#include "src/oscillators.h"
+#include "src/timers.h"
+
+#include "hw_fake.h"
+#include "test.h"
+
+// one LETIMER0 tick at 8192 Hz
+#define TICK_US       (123)
+
+static uint32_t   underflows;
+static uint32_t   comp1_events;
+
+
+// the scheduler is not linked, count what the timers hand it
+void schedulerSetEventUF(void)      { underflows++; }
+void schedulerSetEventCOMP1(void)   { comp1_events++; }
+
+// as in irq.c
+void LETIMER0_IRQHandler(void)
+{
+  uint32_t flags;
+
+  CORE_DECLARE_IRQ_STATE;
+  CORE_ENTER_CRITICAL();
+
+  flags = LETIMER_IntGetEnabled(LETIMER0);
+  LETIMER_IntClear(LETIMER0, flags);
+  timerService(flags);
+
+  CORE_EXIT_CRITICAL();
+
+  if (flags & LETIMER_IF_UF) {
+      schedulerSetEventUF();
+  }
+}
+
+
+static void test_conversions(void)
+{
+  timerSetClock(8192);
+  CHECK_EQ(timerUsToTicks(0), 0);
+  CHECK_EQ(timerUsToTicks(1), 1);
+  CHECK_EQ(timerUsToTicks(80000), 656);                 // 655.36 rounds up
+  CHECK_EQ(timerUsToTicks(3000000), 24576);
+  CHECK_EQ(timerTicksToUs(1), 122);                     // 122.07
+  CHECK_EQ(timerTicksToUs(24576), 3000000);
+  CHECK_EQ(timerTicksToUs(0xFFFFFFFF), 524287999878ull);
+
+  timerSetClock(32768);
+  CHECK_EQ(timerUsToTicks(80000), 2622);                // 2621.44
+  CHECK_EQ(timerTicksToUs(3), 92);                      // 91.55
+  CHECK_EQ(timerTicksToUs(32768), 1000000);
+
+  timerSetClock(1000);
+  CHECK_EQ(timerUsToTicks(1500), 2);
+  CHECK_EQ(timerUsToTicks(0xFFFFFFFF), 4294968);
+  CHECK_EQ(timerTicksToUs(5), 5000);
+}
+
+
+// Exhaustive below 2 s, strided above it, up to the 32-bit limits
+#define SWEEP_DENSE_END   (2000000)
+#define SWEEP_STRIDE      (65521)         // prime, so the low bits all get hit
+
+static const uint32_t sweep_clocks[] = { 32768, 1000, 8192, 16384, 12345, 999999 };
+
+// keeps the timed calls from being optimised away
+static volatile uint64_t sweep_sink;
+
+static uint32_t sweep_next(uint32_t x)
+{
+  if (x < SWEEP_DENSE_END) {
+      return x + 1;
+  }
+  if (x > UINT32_MAX - SWEEP_STRIDE) {
+      return (x == UINT32_MAX) ? 0 : UINT32_MAX;     // 0 ends the sweep
+  }
+
+  return x + SWEEP_STRIDE;
+}
+
+// timerUsToTicks() against ceil(us * f / 1e6), timerTicksToUs() against
+// round(ticks * 1e6 / f), halves up. Prints the largest error each way
+// from the exact value and the host time per call.
+static void test_conversion_sweep(void)
+{
+  for (size_t i = 0; i < sizeof(sweep_clocks) / sizeof(sweep_clocks[0]); i++) {
+      uint64_t f = sweep_clocks[i];
+      uint32_t bad_ticks = 0, bad_us = 0, calls = 0;
+      double   err_ticks = 0, err_us = 0, err;
+      uint64_t start_ns, ticks_ns, us_ns;
+      uint32_t x = 0;
+
+      timerSetClock((uint32_t) f);
+
+      do {
+          uint64_t ticks = ((uint64_t) x * f + 999999) / 1000000;
+          uint64_t us    = ((uint64_t) x * 2000000 + f) / (2 * f);
+          uint32_t got_ticks = timerUsToTicks(x);
+          uint64_t got_us    = timerTicksToUs(x);
+
+          bad_ticks += (got_ticks != ticks);
+          bad_us    += (got_us != us);
+
+          // got - exact, in ticks and in us
+          err = ((double) got_ticks * 1000000 - (double) x * f) / 1000000;
+          if (err > err_ticks || -err > err_ticks) {
+              err_ticks = (err < 0) ? -err : err;
+          }
+          err = ((double) got_us * f - (double) x * 1000000) / f;
+          if (err > err_us || -err > err_us) {
+              err_us = (err < 0) ? -err : err;
+          }
+
+          x = sweep_next(x);
+          calls++;
+      } while (x != 0);
+
+      CHECK_EQ(bad_ticks, 0);
+      CHECK_EQ(bad_us, 0);
+      CHECK(err_ticks < 1.0);
+      CHECK(err_us <= 0.5);
+
+      start_ns = test_host_ns();
+      x = 0;
+      do {
+          sweep_sink += timerUsToTicks(x);
+          x = sweep_next(x);
+      } while (x != 0);
+      ticks_ns = test_host_ns() - start_ns;
+
+      start_ns = test_host_ns();
+      x = 0;
+      do {
+          sweep_sink += timerTicksToUs(x);
+          x = sweep_next(x);
+      } while (x != 0);
+      us_ns = test_host_ns() - start_ns;
+
+      printf("%6u Hz: %u values, max error %.6f ticks / %.6f us, "
+             "%.1f / %.1f ns per call\n",
+             (unsigned int) f, (unsigned int) calls, err_ticks, err_us,
+             (double) ticks_ns / calls, (double) us_ns / calls);
+  }
+}
+
+
+static uint64_t   fired_us[8];
+static uint32_t   fired;
+
+static void on_timer(void)
+{
+  if (fired < 8) {
+      fired_us[fired] = fake_now_us();
+  }
+  fired++;
+}
+
+static sw_timer_t one_shot = SW_TIMER_INIT(on_timer);
+static sw_timer_t periodic = SW_TIMER_INIT(on_timer);
+static sw_timer_t stopped  = SW_TIMER_INIT(on_timer);
+
+static void test_software_timers(void)
+{
+  uint64_t offset;
+
+  fake_hw_reset();
+  oscillator_init();
+  initLETIMER0();
+  NVIC_EnableIRQ(LETIMER0_IRQn);
+
+  CHECK_EQ(fake_letimer_clock(), 8192);
+
+  // longer than the 3 s LETIMER0 period
+  CHECK(!timerStart(&one_shot, 5000000, 0));
+  CHECK(!timerStart(&stopped, 1000, 0));
+  timerStop(&stopped);
+  CHECK(!timerIsRunning(&stopped));
+
+  fake_hw_advance_to(4999000);
+  CHECK_EQ(fired, 0);
+  fake_hw_advance_to(5000000 + TICK_US);
+  CHECK_EQ(fired, 1);
+  CHECK(fired_us[0] >= 5000000);
+  CHECK(!timerIsRunning(&one_shot));
+
+  // never early, at most a tick late
+  fired = 0;
+  CHECK(!timerStart(&periodic, 80000, 1000000));
+  fake_hw_advance_to(fake_now_us() + 3100000);
+  CHECK_EQ(fired, 4);
+  for (uint32_t i = 1; i < 4; i++) {
+      uint64_t gap = fired_us[i] - fired_us[i - 1];
+      CHECK((gap + TICK_US >= 1000000) && (gap <= 1000000 + TICK_US));
+  }
+  timerStop(&periodic);
+
+  // CNT starts at 0, so the first tick is an underflow and the timestamps
+  // run one period ahead; after that they follow the clock to within a tick
+  offset = timerNowUs() - fake_now_us();
+  for (uint32_t i = 0; i < 50; i++) {
+      int64_t drift;
+
+      fake_hw_advance_to(fake_now_us() + 70001);
+      drift = (int64_t) (timerNowUs() - fake_now_us() - offset);
+      CHECK((drift > -TICK_US) && (drift < TICK_US));
+  }
+
+  CHECK_EQ(underflows, (uint32_t) (fake_now_us() / 3000000) + 1);
+}
+
+static void test_full(void)
+{
+  static sw_timer_t timers[TIMER_MAX_TIMERS + 1];
+
+  for (uint32_t i = 0; i <= TIMER_MAX_TIMERS; i++) {
+      timers[i] = (sw_timer_t) SW_TIMER_INIT(on_timer);
+  }
+
+  for (uint32_t i = 0; i < TIMER_MAX_TIMERS; i++) {
+      CHECK(!timerStart(&timers[i], 1000000 + i, 0));
+  }
+  CHECK(timerStart(&timers[TIMER_MAX_TIMERS], 1000, 0));
+
+  // restarting a running timer does not take another slot
+  CHECK(!timerStart(&timers[0], 2000, 0));
+
+  for (uint32_t i = 0; i < TIMER_MAX_TIMERS; i++) {
+      timerStop(&timers[i]);
+  }
+}
+
+
+// Reads of the LETIMER0 registers inside timerNowUs() move the clock on,
+// as the counter keeps running between two reads on the target
+static uint32_t   race_reads;
+static uint32_t   race_underflow_read;   // read that runs into the underflow, 0 for none
+static uint32_t   race_max_ticks;        // otherwise each read moves 0..race_max_ticks ticks
+static uint64_t   race_first_read_us;
+static uint32_t   race_seed = 12345;
+
+static uint32_t race_random(void)
+{
+  // xorshift32
+  race_seed ^= race_seed << 13;
+  race_seed ^= race_seed >> 17;
+  race_seed ^= race_seed << 5;
+
+  return race_seed;
+}
+
+static void race_hook(void)
+{
+  if (++race_reads == 1) {
+      race_first_read_us = fake_now_us();
+  }
+
+  if (race_underflow_read != 0) {
+      if (race_reads == race_underflow_read) {
+          fake_hw_advance_to(fake_hw_next_event_us());
+      }
+  }
+  else {
+      fake_hw_advance_to(fake_now_us() + (race_random() % (race_max_ticks + 1)) * TICK_US);
+  }
+}
+
+// timerNowUs() with the hook in place, checked against the virtual clock
+static uint64_t race_now_us(uint64_t offset)
+{
+  uint64_t now;
+
+  race_reads = 0;
+  fake_letimer_read_hook = race_hook;
+  now = timerNowUs();
+  fake_letimer_read_hook = NULL;
+
+  CHECK((now + TICK_US > race_first_read_us + offset) &&
+        (now < fake_now_us() + offset + TICK_US));
+
+  return now;
+}
+
+static void test_now_race(void)
+{
+  uint64_t offset, now, last;
+  uint32_t uf_count;
+  uint32_t backwards = 0;
+
+  fake_hw_reset();
+  oscillator_init();
+  initLETIMER0();
+  NVIC_EnableIRQ(LETIMER0_IRQn);
+
+  fake_hw_advance_to(1000000);
+  offset = timerNowUs() - fake_now_us();
+
+  // CNT read as 0, the underflow lands before the UF flag is read: the
+  // count must be read again, or the result is a period ahead
+  fake_hw_advance_to(fake_hw_next_event_us() - 4 * TICK_US);
+  while (LETIMER_CounterGet(LETIMER0) != 0) {
+      fake_hw_advance_to(fake_now_us() + TICK_US / 2);
+  }
+  CHECK(!(LETIMER_IntGet(LETIMER0) & LETIMER_IF_UF));
+  last = timerNowUs();
+  uf_count = underflows;
+
+  race_underflow_read = 2;
+  now = race_now_us(offset);
+  CHECK(now >= last);
+  CHECK(now <= last + 2 * TICK_US);
+
+  // the underflow was taken on leaving the critical section
+  CHECK_EQ(underflows, uf_count + 1);
+  last = now;
+  now = timerNowUs();
+  CHECK(now >= last);
+
+  // a few ticks either side of thousands of underflows, the counter moving
+  // on between reads
+  race_underflow_read = 0;
+  race_max_ticks = 2;
+  for (uint32_t i = 0; i < 20000; i++) {
+      // the next flag is UF or the COMP1 match a tick before it
+      uint64_t to_us = fake_hw_next_event_us() - (race_random() % 4) * TICK_US - 1;
+
+      if (to_us > fake_now_us()) {
+          fake_hw_advance_to(to_us);
+      }
+
+      for (uint32_t j = 0; j < 4; j++) {
+          last = now;
+          now = race_now_us(offset);
+          backwards += (now < last);
+      }
+  }
+  CHECK_EQ(backwards, 0);
+}
+
+
+int main(void)
+{
+  test_conversions();
+  test_conversion_sweep();
+  test_software_timers();
+  test_full();
+  test_now_race();
+
+  return test_result("test_timers");
+}
@@ -0,0 +1,95 @@
+/* @file      test_workq.c
+ * @version   1.0
+ * @brief     Host tests for the deferred work queue, src/workq.c
+ *
+ * @author    Anuhya Kuraparthy, anuhya.kuraparthy@colorado.edu
+ * @date      Nov 03, 2023
+ *
+ * @institution University of Colorado Boulder (UCB)
+ * @course      ECEN 5823: IoT Embedded Firmware
+ * @instructor  David Sluiter
+ *
+ * @resources  -
+ */
+
+#include <string.h>
+
+#include "src/workq.h"
+
+#include "hw_fake.h"
+#include "test.h"
+
+static char       order[16];
+static uint32_t   ran;
+static uint32_t   reposts;
+
+static void job_high(void)    { order[ran++] = 'H'; CHECK(!fake_in_critical()); }
+static void job_normal(void)  { order[ran++] = 'N'; }
+static void job_low(void)     { order[ran++] = 'L'; }
+
+static workq_item_t item_high    = WORKQ_ITEM_INIT(job_high, WORKQ_PRIORITY_HIGH);
+static workq_item_t item_normal  = WORKQ_ITEM_INIT(job_normal, WORKQ_PRIORITY_NORMAL);
+static workq_item_t item_normal2 = WORKQ_ITEM_INIT(job_normal, WORKQ_PRIORITY_NORMAL);
+static workq_item_t item_low     = WORKQ_ITEM_INIT(job_low, WORKQ_PRIORITY_LOW);
+
+static void job_repost(void);
+static workq_item_t item_repost  = WORKQ_ITEM_INIT(job_repost, WORKQ_PRIORITY_LOW);
+
+static void job_repost(void)
+{
+  order[ran++] = 'R';
+
+  // queues behind the higher priority item it posts
+  if (++reposts < 3) {
+      workq_post(&item_high);
+      workq_post(&item_repost);
+  }
+}
+
+
+static void test_priority(void)
+{
+  ran = 0;
+
+  CHECK(!workq_pending());
+
+  workq_post(&item_low);
+  workq_post(&item_normal);
+  workq_post(&item_high);
+  workq_post(&item_normal2);
+
+  // a pending item is only queued once
+  workq_post(&item_normal);
+
+  CHECK(workq_pending());
+  workq_run();
+  CHECK(!workq_pending());
+
+  order[ran] = '\0';
+  CHECK_EQ(ran, 4);
+  CHECK(strcmp(order, "HNNL") == 0);
+}
+
+static void test_repost(void)
+{
+  ran = 0;
+  reposts = 0;
+
+  workq_post(&item_repost);
+  workq_run();
+
+  order[ran] = '\0';
+  CHECK(strcmp(order, "RHRHR") == 0);
+  CHECK(!workq_pending());
+}
+
+
+int main(void)
+{
+  fake_hw_reset();
+
+  test_priority();
+  test_repost();
+
+  return test_result("test_workq");
+}